@@ -569,6 +569,10 @@ SOURCE=.\Source\Common\DiscreteCircle.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\Source\Common\FrameProfiler.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\Source\Common\GameEngine.cpp
 # End Source File
 # Begin Source File
@@ -643,6 +647,10 @@ SOURCE=.\Source\Common\UserPreferences.cpp
 
 SOURCE=.\Source\Common\version.cpp
 # End Source File
+# Begin Source File
+
+SOURCE=.\Source\Common\WorkerPool.cpp
+# End Source File
 # End Group
 # Begin Group "GameLogic"
 
@@ -2413,6 +2421,10 @@ SOURCE=.\Source\GameNetwork\NAT.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\Source\GameNetwork\NetCaptureBenchmark.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\Source\GameNetwork\NetCommandList.cpp
 # End Source File
 # Begin Source File
@@ -2429,6 +2441,10 @@ SOURCE=.\Source\GameNetwork\NetCommandWrapperList.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\Source\GameNetwork\NetLoopbackHarness.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\Source\GameNetwork\NetMessageStream.cpp
 # End Source File
 # Begin Source File
@@ -2663,6 +2679,10 @@ SOURCE=.\Include\Common\FileSystem.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\Include\Common\FrameProfiler.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Include\Common\FunctionLexicon.h
 # End Source File
 # Begin Source File
@@ -3015,6 +3035,10 @@ SOURCE=.\Include\Common\WellKnownKeys.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\Include\Common\WorkerPool.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Include\Common\Xfer.h
 # End Source File
 # Begin Source File
@@ -4545,6 +4569,10 @@ SOURCE=.\Include\GameNetwork\GameSpy\PingThread.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\Include\GameNetwork\GameSpy\ThreadQueue.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Include\GameNetwork\GameSpy\ThreadUtils.h
 # End Source File
 # End Group
@@ -4687,6 +4715,10 @@ SOURCE=.\Include\GameNetwork\NAT.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\Include\GameNetwork\NetCaptureBenchmark.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Include\GameNetwork\NetCommandList.h
 # End Source File
 # Begin Source File
@@ -4703,6 +4735,10 @@ SOURCE=.\Include\GameNetwork\NetCommandWrapperList.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\Include\GameNetwork\NetLoopbackHarness.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Include\GameNetwork\NetPacket.h
 # End Source File
 # Begin Source File
@@ -0,0 +1,120 @@
+/*
+**	Command & Conquer Generals(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+// FrameProfiler.h ////////////////////////////////////////////////////////////////////////////////
+// Scoped-zone timeline profiler.  Unlike PerfGather, this is compiled into every build and costs
+// a single flag test per zone unless a capture is running.  Captured zones can be written out
+// in the Chrome trace-event format and viewed in chrome://tracing or Perfetto.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#ifndef __FRAMEPROFILER_H__
+#define __FRAMEPROFILER_H__
+
+#include "Lib/BaseType.h"
+#include "Common/NameKeyGenerator.h"
+
+//-------------------------------------------------------------------------------------------------
+/** One completed zone. */
+//-------------------------------------------------------------------------------------------------
+struct FrameProfileEvent
+{
+	const char*		m_name;				///< Zone name, must be a string literal or otherwise outlive the capture.
+	Int64					m_startNS;		///< Start time in nanoseconds, on the getTimeNS() clock.
+	Int64					m_durationNS;	///< Duration in nanoseconds.
+	UnsignedInt		m_frame;			///< Logic frame the zone started in.
+};
+
+//-------------------------------------------------------------------------------------------------
+/** The profiler.  All methods are static; zones are recorded into a ring buffer per thread, so
+		recording never takes a lock.  Only the oldest events are lost if a buffer wraps. */
+//-------------------------------------------------------------------------------------------------
+class FrameProfiler
+{
+public:
+
+	enum
+	{
+		EVENTS_PER_THREAD = 64*1024,	///< Ring buffer size for each thread.
+		MAX_THREADS = 16							///< Threads beyond this aren't recorded.
+	};
+
+	/// Record zones from logic frame firstFrame through lastFrame, then write them to filename.
+	static void captureFrames(UnsignedInt firstFrame, UnsignedInt lastFrame, const char *filename);
+	/// Called once per logic frame by GameLogic, starts and stops scheduled captures.
+	static void onFrame(UnsignedInt frame);
+
+	static void startCapture(void);
+	static void stopCapture(void);
+	static Bool isCapturing(void) { return s_capturing; }
+
+	/// Write everything captured between firstFrame and lastFrame (inclusive) as Chrome trace JSON.
+	static Bool exportChromeTrace(const char *filename, UnsignedInt firstFrame, UnsignedInt lastFrame);
+
+	static Int64 getTimeNS(void);
+	static void recordZone(const char *name, Int64 startNS, Int64 endNS);
+
+	/// Zone name for a module or other NameKeyType, stable for the life of the game.
+	static const char *getKeyName(NameKeyType key);
+
+private:
+
+	static volatile Bool	s_capturing;
+	static UnsignedInt		s_currentFrame;
+	static UnsignedInt		s_captureFirstFrame;
+	static UnsignedInt		s_captureLastFrame;
+	static char						s_captureFilename[256];
+};
+
+//-------------------------------------------------------------------------------------------------
+/** Times the enclosing scope while a capture is running. */
+//-------------------------------------------------------------------------------------------------
+class FrameProfileZone
+{
+public:
+	FrameProfileZone(const char *name) : m_name(name), m_startNS(0)
+	{
+		if (FrameProfiler::isCapturing())
+			m_startNS = FrameProfiler::getTimeNS();
+	}
+
+	~FrameProfileZone()
+	{
+		if (m_startNS != 0)
+			FrameProfiler::recordZone(m_name, m_startNS, FrameProfiler::getTimeNS());
+	}
+
+private:
+	const char*	m_name;
+	Int64				m_startNS;
+};
+
+#define PROFILE_ZONE_CONCAT2(a, b) a##b
+#define PROFILE_ZONE_CONCAT(a, b) PROFILE_ZONE_CONCAT2(a, b)
+
+/// Time the rest of the enclosing scope as a zone called name.  name must be a string literal.
+#define PROFILE_ZONE(name)		FrameProfileZone PROFILE_ZONE_CONCAT(profileZone_, __LINE__)(name)
+
+#endif /* __FRAMEPROFILER_H__ */
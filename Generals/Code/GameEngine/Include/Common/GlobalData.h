@@ -427,6 +427,7 @@ public:
 	UnsignedInt m_networkRunAheadMetricsTime;		///< The number of miliseconds between run ahead metrics things
 	UnsignedInt m_networkCushionHistoryLength;	///< The number of cushion values to keep.
 	UnsignedInt m_networkRunAheadSlack;					///< The amount of slack in the run ahead value.  This is the percentage of the calculated run ahead that is added.
+	UnsignedInt m_networkRunAheadStallTarget;		///< The percentage of latency samples run ahead is allowed to fall short of.  0 uses the plain average.
 	UnsignedInt m_networkKeepAliveDelay;				///< The number of seconds between when the connections to each player send a keep-alive packet.
 	UnsignedInt m_networkDisconnectTime;				///< The number of milliseconds between when the game gets stuck on a frame for a network stall and when the disconnect dialog comes up.
 	UnsignedInt m_networkPlayerTimeoutTime;			///< The number of milliseconds between when a player's last keep alive command was recieved and when they are considered disconnected from the game.
@@ -434,6 +435,8 @@ public:
 	
 	Real				m_keyboardCameraRotateSpeed;    ///< How fast the camera rotates when rotated via keyboard controls.
   Int					m_playStats;									///< Int whether we want to log play stats or not, if <= 0 then we don't log
+	Bool				m_updateModuleStats;					///< time every update module call by module class, dumped to UpdateModuleStats.txt at game end
+	Int					m_workerThreads;							///< threads WorkerPool may use, including the logic thread. 0 means pick from the core count, 1 means none
 
 #if defined(_DEBUG) || defined(_INTERNAL)
 	Bool m_wireframe;
@@ -462,6 +465,7 @@ public:
 	Bool m_debugCashValueMap;					///< Should we actively debug the threat map
 	UnsignedInt m_maxDebugValue;			///< This value (and any values greater) will appear full GREEN.
 	Int m_debugCashValueMapTileDuration;	///< How long should these tiles stay around, in frames?
+	Bool m_checkPartitionQueries;				///< Run every partition range query again through a fresh PartitionQueryContext and check it agrees
 	RGBColor m_debugVisibilityTargettableColor;	///< What color should the targettable cells be?
 	RGBColor m_debugVisibilityDeshroudColor;			///< What color should the deshrouding cells be?
 	RGBColor m_debugVisibilityGapColor;					///< What color should the gap generator cells be?
@@ -482,6 +486,15 @@ public:
 	Int m_latencyPeriod;					///< Period of sinusoidal modulation of latency
 	Int m_latencyNoise;						///< Max amplitude of jitter to throw in
 	Int m_packetLoss;							///< Percent of packets to drop
+	Int m_packetReorder;					///< Percent of packets to hold back so they arrive out of order
+	Int m_bandwidthCap;						///< Incoming bytes per second to allow before dropping packets, 0 for no cap
+	Bool m_noEarlyResends;				///< Don't resend on ack gaps or send redundant copies, lost commands wait for the retry time
+	Bool m_noSendClasses;					///< Pack commands in list order, with no send rates and no limit on packets per send
+	AsciiString m_netCaptureFile;	///< Record the game's network traffic to this file
+	AsciiString m_netReplayFile;	///< Run this capture file through a ConnectionManager headless, time it, and quit
+	Int m_netHarnessPlayers;			///< Run a game between this many peers over an in-process loopback, then quit
+	Int m_netHarnessFrames;				///< How many frames the loopback game runs for
+	Int m_netHarnessFileSize;			///< Bytes of file for the loopback game's first peer to send everyone alongside the orders
 #endif
 
 	Bool				m_isBreakableMovie;							///< if we enter a breakable movie, set this flag
@@ -364,6 +364,7 @@ public:
 		MSG_META_DEBUG_TOGGLE_FEATHER_WATER, 			///< toggle lorenzen's feather water
 
 		MSG_META_DEBUG_DUMP_ASSETS,						///< dumps currently used map assets to a file. 
+		MSG_META_DEBUG_DUMP_UPDATE_MODULE_STATS,	///< dumps update module costs (-updateModuleStats) to a file and starts over
 
 		MSG_NO_DRAW,																///< show/hide all objects to test Drawing code
 		MSG_META_DEMO_TOGGLE_METRICS,								///< Toggle the metrics on/off
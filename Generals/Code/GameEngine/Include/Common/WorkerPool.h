@@ -0,0 +1,62 @@
+/*
+**	Command & Conquer Generals(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+// WorkerPool.h ///////////////////////////////////////////////////////////////////////////////////
+// A small pool of worker threads for splitting loops over independent items.  The work must not
+// touch anything the other items write, and must not depend on which thread runs it, so that the
+// results are the same no matter how the items get divided up.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#ifndef __WORKERPOOL_H__
+#define __WORKERPOOL_H__
+
+#include "Lib/BaseType.h"
+
+//-------------------------------------------------------------------------------------------------
+/** All methods are static.  The threads are started on the first parallelFor, using
+		TheGlobalData->m_workerThreads, and stopped by shutdown(). */
+//-------------------------------------------------------------------------------------------------
+class WorkerPool
+{
+public:
+
+	enum { MAX_WORKERS = 15 };
+
+	/// Work on items [begin, end).
+	typedef void (*RangeProc)(Int begin, Int end, void *userData);
+
+	/** Call proc over [0, count) in chunks of at most grain items, spread over the workers and the
+			calling thread, and return once every chunk is done.  Runs everything on the calling thread
+			if there are no workers or if called from inside another parallelFor. */
+	static void parallelFor(Int count, Int grain, RangeProc proc, void *userData);
+
+	/// Number of threads parallelFor can use, including the caller.
+	static Int getThreadCount(void);
+
+	static void shutdown(void);
+};
+
+#endif /* __WORKERPOOL_H__ */
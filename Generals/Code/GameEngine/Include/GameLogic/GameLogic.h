@@ -133,6 +133,9 @@ public:
 
 	Bool isInGameLogicUpdate( void ) const { return m_isInUpdate; }
 	UnsignedInt getFrame( void );										///< Returns the current simulation frame number
+#if defined(_DEBUG) || defined(_INTERNAL)
+	void friend_setFrame( UnsignedInt frame ) { m_frame = frame; }	///< Only for NetLoopbackHarness and NetCaptureBenchmark, which step the network with no game running.
+#endif
 	UnsignedInt getCRC( Int mode = CRC_CACHED, AsciiString deepCRCFileName = AsciiString::TheEmptyString );		///< Returns the CRC
 
 	void setObjectIDCounter( ObjectID nextObjID ) { m_nextObjID = nextObjID; }
@@ -239,6 +242,9 @@ public:
 	// this should be called only by UpdateModule, thanks.
 	void friend_awakenUpdateModule(Object* obj, UpdateModulePtr update, UnsignedInt whenToWakeUp);
 
+	void dumpUpdateModuleStats( const char *filename );			///< write per-module-class update costs (see m_updateModuleStats) to a file
+	void resetUpdateModuleStats( void );										///< forget all update costs gathered so far
+
 protected:
 
 	// snapshot methods
@@ -262,6 +268,8 @@ private:
 	void remakeSleepyUpdate();
 	void validateSleepyUpdate() const;
 
+	void recordUpdateModuleStats(UpdateModulePtr u, Int64 elapsedNS, UnsignedInt sleepFrames);
+
 private:
 
 	/**
@@ -320,6 +328,20 @@ private:
 
 	UpdateModulePtr					 m_curUpdateModule;
 
+	/// Update cost of every module of one class, gathered while TheGlobalData->m_updateModuleStats is set.
+	struct UpdateModuleStats
+	{
+		UnsignedInt	m_calls;
+		Int64				m_totalNS;
+		Int64				m_peakNS;
+		UnsignedInt	m_sleepCalls;					///< calls that returned a finite sleep
+		Int64				m_totalSleepFrames;		///< sum of those sleeps
+		UnsignedInt	m_sleepForeverCalls;	///< calls that returned UPDATE_SLEEP_FOREVER
+	};
+	typedef std::unordered_map< NameKeyType, UpdateModuleStats, rts::hash<NameKeyType>, rts::equal_to<NameKeyType> > UpdateModuleStatsMap;
+	UpdateModuleStatsMap m_updateModuleStats;
+	UnsignedInt m_updateModuleStatsFirstFrame;
+
 	ObjectPointerList m_objectsToDestroy;										///< List of things that need to be destroyed at end of frame
 
 	ObjectID m_nextObjID;																		///< For allocating object id's
@@ -328,6 +328,8 @@ public:
 
 	void addLooker( Int playerIndex );
 	void removeLooker( Int playerIndex );
+	void addLookers( UnsignedInt playerIndexMask );			///< addLooker for every player whose bit (1 << playerIndex) is set
+	void removeLookers( UnsignedInt playerIndexMask );	///< removeLooker for every player whose bit (1 << playerIndex) is set
 	void addShrouder( Int playerIndex );
 	void removeShrouder( Int playerIndex );
 	CellShroudStatus getShroudStatusForPlayer( Int playerIndex ) const;
@@ -363,6 +365,33 @@ public:
 	void friend_removeFromCellList(CellAndObjectIntersection *coi);
 };
 
+//=====================================
+/**
+	The shape that decides which cells a PartitionData touches, and those cells, in the
+	order its fill visits them (without duplicates). Working these out only reads the
+	shape and the cell grid, so PartitionManager::update can do it for every dirty module
+	up front on several threads, then hook the cells up in the usual order.
+*/
+//=====================================
+struct PartitionCellsTouched
+{
+	GeometryType								m_geom;
+	Bool												m_isSmall;
+	Coord3D											m_pos;
+	Real												m_angle;
+	Real												m_majorRadius;
+	Real												m_minorRadius;
+	std::vector<PartitionCell*>	m_cells;
+
+	/// true iff the shape fields are identical, so the same cells would come out
+	Bool isSameShape(const PartitionCellsTouched &that) const
+	{
+		return m_geom == that.m_geom && m_isSmall == that.m_isSmall
+			&& m_pos.x == that.m_pos.x && m_pos.y == that.m_pos.y && m_pos.z == that.m_pos.z
+			&& m_angle == that.m_angle && m_majorRadius == that.m_majorRadius && m_minorRadius == that.m_minorRadius;
+	}
+};
+
 //=====================================
 /** 
 	A PartitionData is the part of an Object that understands
@@ -392,7 +421,7 @@ private:
 	Int													m_coiArrayCount;					///< number of COIs allocated (may be more than are in use)
 	Int													m_coiInUseCount;					///< number of COIs that are actually in use
 	CellAndObjectIntersection		*m_coiArray;							///< The array of COIs 
-	Int													m_doneFlag;
+	Int													m_queryIndex;							///< dense index used by PartitionQueryContext to mark visits
 	DirtyStatus									m_dirtyStatus;
 	ObjectShroudStatus					m_shroudedness[MAX_PLAYER_COUNT];						
 	ObjectShroudStatus					m_shroudednessPrevious[MAX_PLAYER_COUNT];	///<previous frames value of m_shroudedness						
@@ -430,15 +459,25 @@ private:
 	/**
 		this discards all current 'touch' information (via removeAllTouchedCells) and recalculates
 		the cells touched by this module, based on the object's geometry. this will be called frequently and so
-		needs to be as efficient as possible.
+		needs to be as efficient as possible. if precomputed is non-null and its shape still matches
+		the object's, its cells are used rather than being worked out again.
+	*/
+	void updateCellsTouched(const PartitionCellsTouched *precomputed);
+
+	/// fill in the shape fields of cellsTouched from our Object (or GhostObject)
+	void getShape(PartitionCellsTouched &cellsTouched) const;
+
+	/**
+		fill in cellsTouched.m_cells from its shape fields. this reads nothing but the shape and
+		the cell grid, so it's safe to call from a worker thread.
 	*/
-	void updateCellsTouched();
+	static void gatherCellsTouched(PartitionCellsTouched &cellsTouched);
 
 	/**
 		If you imagine the array of Partition Cells as pixels, then this method
 		'sets' the pixel [cell] at cell coordinate (x, y).
 	*/
-	void addSubPixToCoverage(PartitionCell *cell);
+	static void addSubPixToCoverage(std::vector<PartitionCell*> &cells, PartitionCell *cell);
 
 	/**
 		fill in the pixels covered by the given 'small' shape with the given
@@ -447,20 +486,22 @@ private:
 		a more efficient special-purpose filler, rather than a general
 		rasterizer.
 	*/
-	void doSmallFill(
+	static void doSmallFill(
+		std::vector<PartitionCell*> &cells,
 		Real centerX,
 		Real centerY,
 		Real radius
 	);
 
 	/// helper function for doCircleFill.
-	void hLineCircle(Int x1, Int x2, Int y);
+	static void hLineCircle(std::vector<PartitionCell*> &cells, Int x1, Int x2, Int y);
 
 	/**
 		fill in the pixels covered by the given circular shape with the given
 		center and radius. Note that this is used for both spheres and cylinders.
 	*/
-	void doCircleFill(
+	static void doCircleFill(
+		std::vector<PartitionCell*> &cells,
 		Real centerX,
 		Real centerY,
 		Real radius
@@ -470,7 +511,8 @@ private:
 		fill in the pixels covered by the given rectangular shape with the given
 		center, dimensions, and rotation.
 	*/
-	void doRectFill(
+	static void doRectFill(
+		std::vector<PartitionCell*> &cells,
 		Real centerX,
 		Real centerY,
 		Real halfsizeX,
@@ -542,14 +584,16 @@ public:
 	ObjectShroudStatus friend_getShroudednessPrevious(Int playerIndex) {return m_shroudednessPrevious[playerIndex];}
 	
 	void friend_removeAllTouchedCells() { removeAllTouchedCells(); }	///< this is only for use by PartitionManager
-	void friend_updateCellsTouched()	{ updateCellsTouched(); } ///< this is only for use by PartitionManager
+	void friend_updateCellsTouched(const PartitionCellsTouched *precomputed = NULL)	{ updateCellsTouched(precomputed); } ///< this is only for use by PartitionManager
+	void friend_gatherCellsTouched(PartitionCellsTouched &cellsTouched) const { getShape(cellsTouched); gatherCellsTouched(cellsTouched); } ///< this is only for use by PartitionManager
 	Int friend_getCoiInUseCount() { return m_coiInUseCount; } ///< this is only for use by PartitionManager
 	Bool friend_collidesWith(const PartitionData *that, CollideLocAndNormal *cinfo) const { return collidesWith(that, cinfo); }	///< this is only for use by PartitionContactList
 
-	// these are only for use by getClosestObjects.
-	// (note, if we ever use other bits in this, smarten this up...)
-	Int friend_getDoneFlag() { return m_doneFlag; }
-	void friend_setDoneFlag(Int i) { m_doneFlag = i; }
+	// these are only for use by PartitionManager and PartitionQueryContext.
+	Int friend_getQueryIndex() const { return m_queryIndex; }
+	void friend_setQueryIndex(Int i) { m_queryIndex = i; }
+
+	PartitionData *friend_getNextDirty() const { return m_nextDirty; }	///< this is only for use by PartitionManager
 
 	inline Bool isInListDirtyModules(PartitionData* const* pListHead) const
 	{
@@ -589,10 +633,66 @@ public:
 	of this, and respond appropriately. (ie, the filter may be used for filtering
 	against an object, or against a position.)
 */
+//=====================================
+/**
+	The cheap, common filter conditions in flat form. Before a range query looks at any
+	objects, each filter is offered the chance to fold itself into one of these via
+	PartitionFilter::addToMask; those that can are then tested for every candidate with a
+	handful of inline bit tests instead of a virtual call each, and only the remaining
+	filters are called the usual way.
+*/
+struct PartitionFilterMask
+{
+	enum MapStatus
+	{
+		MAP_STATUS_ANY,
+		MAP_STATUS_ON_MAP,
+		MAP_STATUS_OFF_MAP
+	};
+
+	UnsignedInt			m_statusMustBeSet;			///< all of these ObjectStatusBits must be set...
+	UnsignedInt			m_statusMustBeClear;		///< ...and none of these
+	Bool						m_testKindOf;
+	KindOfMaskType	m_kindOfMustBeSet;
+	KindOfMaskType	m_kindOfMustBeClear;
+	Bool						m_rejectDead;						///< reject effectively dead objects
+	MapStatus				m_mapStatus;
+	const Object*		m_relationshipObj;			///< if non-null, accept only objects whose relationship with this...
+	Int							m_relationshipFlags;		///< ...has its bit (1 << Relationship) set here
+
+	PartitionFilterMask() { clear(); }
+
+	void clear()
+	{
+		m_statusMustBeSet = 0;
+		m_statusMustBeClear = 0;
+		m_testKindOf = false;
+		m_kindOfMustBeSet.clear();
+		m_kindOfMustBeClear.clear();
+		m_rejectDead = false;
+		m_mapStatus = MAP_STATUS_ANY;
+		m_relationshipObj = NULL;
+		m_relationshipFlags = 0;
+	}
+
+	/// helpers for PartitionFilter::addToMask; these return false if the condition can't be merged
+	Bool addMapStatus(MapStatus status);
+	Bool addRelationship(const Object *obj, Int flags);
+};
+
+//=====================================
 class PartitionFilter
 {
 public:
 	virtual Bool allow(Object *objOther) = 0;
+
+	/**
+		If this filter is exactly equivalent to some set of PartitionFilterMask conditions, add them
+		to mask and return true, in which case allow() won't be called during the query. Otherwise
+		leave mask alone and return false.
+	*/
+	virtual Bool addToMask(PartitionFilterMask &mask) const { return false; }
+
 #if defined(_DEBUG) || defined(_INTERNAL)
 	virtual const char* debugGetName() = 0;
 #endif
@@ -665,6 +765,7 @@ public:
 	};
 	PartitionFilterRelationship(const Object *obj, Int flags) : m_obj(obj), m_flags(flags) { }
 	virtual Bool allow(Object *objOther);
+	virtual Bool addToMask(PartitionFilterMask &mask) const { return mask.addRelationship(m_obj, m_flags); }
 #if defined(_DEBUG) || defined(_INTERNAL)
 	virtual const char* debugGetName() { return "PartitionFilterRelationship"; }
 #endif
@@ -772,6 +873,12 @@ private:
 public:
 	PartitionFilterAcceptByObjectStatus(UnsignedInt mustBeSet, UnsignedInt mustBeClear) : m_mustBeSet(mustBeSet), m_mustBeClear(mustBeClear) { }
 	virtual Bool allow(Object *objOther);
+	virtual Bool addToMask(PartitionFilterMask &mask) const 
+	{ 
+		mask.m_statusMustBeSet |= m_mustBeSet; 
+		mask.m_statusMustBeClear |= m_mustBeClear; 
+		return true; 
+	}
 #if defined(_DEBUG) || defined(_INTERNAL)
 	virtual const char* debugGetName() { return "PartitionFilterAcceptByObjectStatus"; }
 #endif
@@ -825,6 +932,13 @@ private:
 public:
 	PartitionFilterAcceptByKindOf(const KindOfMaskType& mustBeSet, const KindOfMaskType& mustBeClear) : m_mustBeSet(mustBeSet), m_mustBeClear(mustBeClear) { }
 	virtual Bool allow(Object *objOther);
+	virtual Bool addToMask(PartitionFilterMask &mask) const 
+	{ 
+		mask.m_testKindOf = true;
+		mask.m_kindOfMustBeSet.set(m_mustBeSet); 
+		mask.m_kindOfMustBeClear.set(m_mustBeClear); 
+		return true; 
+	}
 #if defined(_DEBUG) || defined(_INTERNAL)
 	virtual const char* debugGetName() { return "PartitionFilterAcceptByKindOf"; }
 #endif
@@ -875,6 +989,7 @@ class PartitionFilterAlive : public PartitionFilter
 {
 public:
 	PartitionFilterAlive(void) { }
+	virtual Bool addToMask(PartitionFilterMask &mask) const { mask.m_rejectDead = true; return true; }
 protected:
 	virtual Bool allow(Object *objOther);
 #if defined(_DEBUG) || defined(_INTERNAL)
@@ -893,6 +1008,7 @@ private:
 	const Object *m_obj;
 public:
 	PartitionFilterSameMapStatus(const Object *obj) : m_obj(obj) { }
+	virtual Bool addToMask(PartitionFilterMask &mask) const;
 protected:
 	virtual Bool allow(Object *objOther);
 #if defined(_DEBUG) || defined(_INTERNAL)
@@ -908,6 +1024,7 @@ class PartitionFilterOnMap : public PartitionFilter
 {
 public:
 	PartitionFilterOnMap() { }
+	virtual Bool addToMask(PartitionFilterMask &mask) const { return mask.addMapStatus(PartitionFilterMask::MAP_STATUS_ON_MAP); }
 protected:
 	virtual Bool allow(Object *objOther);
 #if defined(_DEBUG) || defined(_INTERNAL)
@@ -1184,8 +1301,8 @@ protected:
 #endif
 };
 
-void hLineAddLooker(Int x1, Int x2, Int y, void *playerIndex);
-void hLineRemoveLooker(Int x1, Int x2, Int y, void *playerIndex);
+void hLineAddLooker(Int x1, Int x2, Int y, void *playerIndexMask);
+void hLineRemoveLooker(Int x1, Int x2, Int y, void *playerIndexMask);
 void hLineAddShrouder(Int x1, Int x2, Int y, void *playerIndex);
 void hLineRemoveShrouder(Int x1, Int x2, Int y, void *playerIndex);
 
@@ -1194,6 +1311,94 @@ void hLineRemoveThreat(Int x1, Int x2, Int y, void *threatValueParms);
 void hLineAddValue(Int x1, Int x2, Int y, void *threatValueParms);
 void hLineRemoveValue(Int x1, Int x2, Int y, void *threatValueParms);
 
+//=====================================
+/**
+	Per-query scratch state for the PartitionManager range queries.  An object can touch several
+	cells, so a query has to remember which PartitionDatas it has already looked at; that used to
+	be a single flag stored in the PartitionData, which made the queries non-reentrant.  Instead
+	each context keeps its own visitation epoch per PartitionData (indexed by its query index),
+	so any number of contexts can query at once -- nested inside a filter, or from several
+	threads while the partition is frozen (see PartitionManager::setQueriesFrozen).
+
+	A context must only be used by one query at a time.
+*/
+class PartitionQueryContext
+{
+public:
+
+	struct Result
+	{
+		Object*		m_obj;
+		Real			m_distSqr;
+	};
+	typedef std::vector<Result> ResultVec;
+
+	PartitionQueryContext() : m_epoch(0), m_relationshipObj(NULL) { }
+
+	/// start a new query; numQueryIndices is PartitionManager::getQueryIndexCount()
+	void beginQuery(Int numQueryIndices)
+	{
+		beginVisits(numQueryIndices);
+		m_results.clear();
+		m_relationshipObj = NULL;
+	}
+
+	/// forget which modules have been visited, without disturbing anything else
+	void beginVisits(Int numQueryIndices)
+	{
+		if (m_visitEpochs.size() < (size_t)numQueryIndices)
+			m_visitEpochs.resize(numQueryIndices, 0);
+		if (++m_epoch == 0)
+		{
+			// wrapped; clear everything so stale marks can't match
+			std::fill(m_visitEpochs.begin(), m_visitEpochs.end(), 0);
+			m_epoch = 1;
+		}
+	}
+
+	/// returns true the first time a module is seen in the current query
+	Bool markVisited(const PartitionData *mod)
+	{
+		UnsignedInt &epoch = m_visitEpochs[mod->friend_getQueryIndex()];
+		if (epoch == m_epoch)
+			return false;
+		epoch = m_epoch;
+		return true;
+	}
+
+	void addResult(Object *obj, Real distSqr)
+	{
+		Result r;
+		r.m_obj = obj;
+		r.m_distSqr = distSqr;
+		m_results.push_back(r);
+	}
+
+	const ResultVec& getResults() const { return m_results; }
+
+	/// obj->getRelationship(other), remembered per team for the rest of the query
+	Relationship getRelationship(const Object *obj, const Object *other);
+
+	/// split filters into m_filterMask and m_remainingFilters for the coming query
+	void compileFilters(PartitionFilter **filters);
+	/// filtersAllow, for the filters given to compileFilters
+	inline Bool maskAllows(const Object *objOther);
+	PartitionFilter **getRemainingFilters() { return &m_remainingFilters[0]; }
+
+private:
+
+	enum { RELATIONSHIP_CACHE_SIZE = 8 };
+
+	std::vector<UnsignedInt>	m_visitEpochs;		///< epoch at which each PartitionData was last visited
+	UnsignedInt								m_epoch;					///< current query
+	ResultVec									m_results;				///< output of PartitionManager::queryObjectsInRange
+	const Object*							m_relationshipObj;	///< the object m_relationshipTeams is relative to
+	const Team*								m_relationshipTeams[RELATIONSHIP_CACHE_SIZE];
+	Relationship							m_relationships[RELATIONSHIP_CACHE_SIZE];
+	PartitionFilterMask				m_filterMask;				///< the filters that could be folded into bit tests
+	std::vector<PartitionFilter*>	m_remainingFilters;	///< and the ones that couldn't
+};
+
 //=====================================
 /** 
 	PartitionManager is the singleton class that manages the entire partition/collision
@@ -1229,11 +1434,109 @@ private:
 	RadiusVec				m_radiusVec;
 #endif
 
+	Int							m_queryIndexCount;				///< high-water mark of PartitionData query indices
+	std::vector<Int>	m_freeQueryIndices;			///< query indices released by deleted PartitionDatas
+	std::vector<PartitionQueryContext*> m_queryContexts;	///< contexts for the context-less query API, one per nesting level
+	Int							m_queryContextDepth;			///< how many of m_queryContexts are in use
+	Bool						m_queriesFrozen;					///< true while queries may run concurrently; the partition must not change
+
+#ifdef FASTER_GCO
+	/**
+		Every module a closest-object search centered on one cell would look at, in the order
+		it would look at them, with duplicates removed. Candidates for radius r are
+		m_candidates[m_radiusStart[r]] up to m_candidates[m_radiusStart[r+1]].
+	*/
+	struct ScanCache
+	{
+		std::vector<PartitionData*>	m_candidates;
+		std::vector<Int>						m_radiusStart;
+	};
+	typedef std::unordered_map< Int, ScanCache, rts::hash<Int>, rts::equal_to<Int> > ScanCacheMap;
+
+	ScanCacheMap		m_scanCaches;							///< by center cell index, valid while m_scanCacheSerial is current
+	UnsignedInt			m_scanCacheSerial;
+
+	const ScanCache *getScanCache(PartitionQueryContext &ctx, Int cellX, Int cellY, Int maxRadius);
+#endif
+
+	UnsignedInt			m_cellMembershipSerial;		///< bumped whenever any cell gains or loses an object
+	Int							m_scanBatchDepth;					///< scan caches are only used between beginScanBatch and endScanBatch
+
+	// cells whose object lists were walked by closest-object searches, and how many would have been walked without scan caches
+	UnsignedInt			m_scanCellsWalked;
+	UnsignedInt			m_scanCellsRequested;
+	UnsignedInt			m_lastFrameScanCellsWalked;
+	UnsignedInt			m_lastFrameScanCellsRequested;
+	Int64						m_totalScanCellsWalked;
+	Int64						m_totalScanCellsRequested;
+
+	/**
+		The cash or threat map summed over a set of players, along with the answers the AI
+		queries want from it. Built on first use, then kept up to date cell by cell as threat
+		and value affects are done and undone.
+	*/
+	struct ValueMapCache
+	{
+		PlayerMaskType						m_playerMask;
+		ValueOrThreat							m_valType;
+		std::vector<UnsignedInt>	m_values;				///< per cell, summed over the players in the mask
+		Int												m_bestCell;			///< first cell with the greatest value, or -1
+		UnsignedInt								m_minValue;
+		UnsignedInt								m_maxValue;
+		Bool											m_extremaStale;	///< a cell holding the best, min or max went the wrong way, so rescan m_values
+	};
+	typedef std::unordered_map< UnsignedInt, ValueMapCache, rts::hash<UnsignedInt>, rts::equal_to<UnsignedInt> > ValueMapCacheMap;
+
+	ValueMapCacheMap	m_valueMapCaches;					///< by player mask and ValueOrThreat
+	std::vector<ValueMapCache*>	m_valueMapUpdates;	///< the caches the affect being drawn has to keep up to date
+	UnsignedInt				m_valueMapQueries;				///< value map queries since reset
+	UnsignedInt				m_valueMapBuilds;					///< and how many of them had to build a cache
+	UnsignedInt				m_valueMapRescans;				///< and how many had to rescan a cache for its extrema
+
+	const ValueMapCache *getValueMapCache(PlayerMaskType playerMask, ValueOrThreat valType);
+	static void findValueMapExtrema(ValueMapCache &cache);
+	void gatherValueMapUpdates(Int playerIndex, ValueOrThreat valType);
+	void updateValueMaps(Int cellIndex, UnsignedInt amount, Bool add);
+
+	/**
+		Terrain line-of-sight answers for recently asked pairs of endpoints, matched on the
+		exact coordinates. Direct mapped; everything is dropped at the top of each frame and
+		whenever the terrain changes height.
+	*/
+	enum { LOS_CACHE_SIZE = 1024 };
+	struct LineOfSightCacheEntry
+	{
+		Coord3D				m_from;
+		Coord3D				m_to;
+		UnsignedInt		m_serial;						///< valid while this matches m_losCacheSerial
+		Bool					m_clear;
+	};
+
+	LineOfSightCacheEntry	m_losCache[LOS_CACHE_SIZE];
+	UnsignedInt						m_losCacheSerial;
+	UnsignedInt						m_losQueries;					///< terrain line-of-sight queries since reset
+	UnsignedInt						m_losCacheHits;				///< and how many of them were answered from m_losCache
+
+	static Int getLineOfSightCacheSlot(const Coord3D& from, const Coord3D& to);
+	Bool findCachedLineOfSight(const Coord3D& from, const Coord3D& to, Bool& clear);
+	void cacheLineOfSight(const Coord3D& from, const Coord3D& to, Bool clear);
+
+	// cells touched by the dirty modules, worked out on the worker threads at the top of update()
+	std::vector<PartitionData*>					m_cellsTouchedModules;
+	std::vector<PartitionCellsTouched>	m_cellsTouched;						///< parallel to m_cellsTouchedModules, kept around so the vectors can be reused
+	std::vector<Int>										m_cellsTouchedSlots;			///< by query index, the slot in m_cellsTouched, or -1
+
+	void precomputeCellsTouched();
+	const PartitionCellsTouched *getPrecomputedCellsTouched(PartitionData *mod);
+	static void gatherCellsTouchedProc(Int begin, Int end, void *userData);
+
 protected:
 
 	/**
 		This is an internal function that is used to implement the public 
-		getClosestObject and iterateObjects calls. 
+		getClosestObject and iterateObjects calls. It borrows a query context,
+		so it may be nested (e.g. called from inside a PartitionFilter), but
+		must only be called from the logic thread.
 	*/
 	Object *getClosestObjects(
 		const Object *obj, 
@@ -1246,6 +1549,39 @@ protected:
 		Coord3D *closestVecArg
 	);
 
+	/**
+		The actual search. Touches nothing but ctx and the outputs, so it is safe to run
+		concurrently with other searches using other contexts.
+	*/
+	Object *doClosestObjectsQuery(
+		PartitionQueryContext &ctx,
+		const Object *obj, 
+		const Coord3D *pos, 
+		Real maxDist, 
+		DistanceCalculationType dc, 
+		PartitionFilter **filters, 
+		SimpleObjectIterator *iterArg,	// if nonnull, append ALL satisfactory objects to the iterator
+		Bool collectAll,								// if true, append ALL satisfactory objects to ctx's results
+		Real *closestDistArg,
+		Coord3D *closestVecArg
+	);
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	/**
+		For -checkPartitionQueries: do a getClosestObjects search again, the way another thread
+		would, and crash if it doesn't find the same thing.
+	*/
+	void checkClosestObjectsQuery(
+		const Object *obj, 
+		const Coord3D *pos, 
+		Real maxDist, 
+		DistanceCalculationType dc, 
+		PartitionFilter **filters, 
+		SimpleObjectIterator *iterArg,
+		Object *closestObj
+	);
+#endif
+
 	void shutdown( void );
 
 	/// used to validate the positions for findPositionAround family of methods
@@ -1268,8 +1604,8 @@ protected:
 
 	// These are all friend functions now. They will continue to function as before, but can be passed into 
 	// the DiscreteCircle::drawCircle function.
-	friend void hLineAddLooker(Int x1, Int x2, Int y, void *playerIndex);
-	friend void hLineRemoveLooker(Int x1, Int x2, Int y, void *playerIndex);
+	friend void hLineAddLooker(Int x1, Int x2, Int y, void *playerIndexMask);
+	friend void hLineRemoveLooker(Int x1, Int x2, Int y, void *playerIndexMask);
 	friend void hLineAddShrouder(Int x1, Int x2, Int y, void *playerIndex);
 	friend void hLineRemoveShrouder(Int x1, Int x2, Int y, void *playerIndex);
 
@@ -1306,6 +1642,37 @@ public:
 
 	void processEntirePendingUndoShroudRevealQueue(); ///< process every pending one regardless of timestamp
 
+	// used by PartitionData to get and return the index PartitionQueryContext uses to mark visits
+	Int friend_allocateQueryIndex();
+	void friend_releaseQueryIndex(Int index);
+	Int getQueryIndexCount() const { return m_queryIndexCount; }
+
+	/**
+		While frozen, the partition must not be changed (no registering, unregistering or
+		updating), and the context-taking queries below may be run from several threads at once,
+		each with its own PartitionQueryContext.
+	*/
+	void setQueriesFrozen(Bool frozen) { m_queriesFrozen = frozen; }
+	Bool areQueriesFrozen() const { return m_queriesFrozen; }
+
+	/**
+		Between these calls, closest-object searches share their cell walks: the first search
+		centered on a given cell records what it found, and later ones centered on the same cell
+		reuse the list until an object changes cells. Results are the same as without batching.
+		Calls may nest.
+	*/
+	void beginScanBatch() { ++m_scanBatchDepth; }
+	void endScanBatch() { --m_scanBatchDepth; DEBUG_ASSERTCRASH(m_scanBatchDepth >= 0, ("unbalanced endScanBatch")); }
+
+	void friend_noteCellMembershipChanged() { ++m_cellMembershipSerial; }
+
+	/// cells walked by closest-object searches last frame, and how many they'd have walked without batching
+	void getScanStats(UnsignedInt &cellsWalked, UnsignedInt &cellsRequested) const 
+	{ 
+		cellsWalked = m_lastFrameScanCellsWalked; 
+		cellsRequested = m_lastFrameScanCellsRequested; 
+	}
+
 	/// return the number of PartitionCells in the x-dimension.
 	Int getCellCountX() { DEBUG_ASSERTCRASH(m_cellCountX != 0, ("partition not inited")); return m_cellCountX; }
 
@@ -1356,6 +1723,32 @@ public:
 		Coord3D *closestDistVec = NULL
 	);
 
+	/**
+		Reentrant versions of getClosestObject and iterateObjectsInRange. Exactly one of obj and
+		pos must be non-null. queryObjectsInRange leaves its results, unsorted, in ctx.getResults()
+		and returns how many there are. Neither allocates anything other than ctx's own buffers,
+		so they may be used concurrently while the partition is frozen, provided the filters are
+		themselves thread safe.
+	*/
+	Object *queryClosestObject(
+		PartitionQueryContext &ctx,
+		const Object *obj, 
+		const Coord3D *pos, 
+		Real maxDist, 
+		DistanceCalculationType dc, 
+		PartitionFilter **filters = NULL, 
+		Real *closestDist = NULL,
+		Coord3D *closestDistVec = NULL
+	);
+	Int queryObjectsInRange(
+		PartitionQueryContext &ctx,
+		const Object *obj, 
+		const Coord3D *pos, 
+		Real maxDist, 
+		DistanceCalculationType dc, 
+		PartitionFilter **filters = NULL
+	);
+
 	Real getRelativeAngle2D( const Object *obj, const Object *otherObj );
 	Real getRelativeAngle2D( const Object *obj, const Coord3D *pos );
 
@@ -1439,6 +1832,9 @@ public:
 	*/
 	Bool isClearLineOfSightTerrain(const Object* obj, const Coord3D& objPos, const Object* other, const Coord3D& otherPos);
 
+	/// the terrain changed height somewhere, so cached line-of-sight answers can't be trusted
+	void friend_noteTerrainChanged() { ++m_losCacheSerial; }
+
 	inline Bool isInListDirtyModules(PartitionData* o) const
 	{
 		return o->isInListDirtyModules(&m_dirtyModules);
@@ -1567,5 +1963,17 @@ public:
 //-----------------------------------------------------------------------------
 extern PartitionManager *ThePartitionManager;  ///< object manager singleton
 
+//-----------------------------------------------------------------------------
+/**
+	Keeps a scan batch open for the life of the enclosing scope, so closest-object
+	searches made inside it can share cell walks (see PartitionManager::beginScanBatch).
+*/
+class PartitionScanBatch
+{
+public:
+	PartitionScanBatch() { ThePartitionManager->beginScanBatch(); }
+	~PartitionScanBatch() { ThePartitionManager->endScanBatch(); }
+};
+
 #endif // __PARTITIONMANAGER_H_
 
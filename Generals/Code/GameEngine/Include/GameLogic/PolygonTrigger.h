@@ -46,6 +46,8 @@ struct DataChunkInfo;
 class PolygonTrigger;
 class Xfer;
 
+typedef std::vector<PolygonTrigger *> PolygonTriggerPtrVector;
+
 // ------------------------------------------------------------------------------------------------
 /** Water handles are used to represent instances of areas of water, no matter which type
 	* of implementation the water is (grid, trigger area, etc) */
@@ -84,13 +86,25 @@ protected:
 	Bool							m_exportWithScripts;
 	Bool							m_isWaterArea; ///< Used to specify water areas in the map.
 	Bool							m_isRiver;		///< Used to specify that a water area is a river.
+	mutable ObjectIDVector m_occupants;	///< Objects currently inside, maintained by Object as it moves.
 
 	static PolygonTrigger* ThePolygonTriggerListPtr;
 	static Int s_currentID; ///< Current id for new triggers.
 
+	// Coarse grid over the trigger bounds, so moving objects only test the triggers near them.
+	enum { SPATIAL_INDEX_CELL_SIZE = 160, SPATIAL_INDEX_MAX_CELLS = 64*64 };
+	static std::vector<PolygonTriggerPtrVector> s_indexCells;	///< Triggers overlapping each cell, in list order.
+	static IRegion2D	s_indexBounds;		///< Union of all trigger bounds.
+	static Int				s_indexCellSize;
+	static Int				s_indexCellsX;
+	static Int				s_indexCellsY;
+	static Bool				s_indexValid;
+
 protected:
 	void reallocate(void);
 	void updateBounds(void) const;
+	static void buildSpatialIndex(void);
+	static void invalidateSpatialIndex(void) {s_indexValid = false;}
 
 	// snapshot methods
 	virtual void crc( Xfer *xfer );
@@ -108,11 +122,14 @@ public:
 	/// Writes Triggers Info
 	static void WritePolygonTriggersDataChunk(DataChunkOutput &chunkWriter);
 	static void deleteTriggers(void);
+	/// Returns the triggers whose bounds may contain point, in list order.  NULL if there are none.
+	static const PolygonTriggerPtrVector *getPolygonTriggersNear(const ICoord3D &point);
+	static Bool isPolygonTriggerInList(const PolygonTrigger *pTrigger);
 
 public:
 	static void addPolygonTrigger(PolygonTrigger *pTrigger);
 	static void removePolygonTrigger(PolygonTrigger *pTrigger);
-	void setNextPoly(PolygonTrigger *nextPoly) {m_nextPolygonTrigger = nextPoly;} ///< Link the next map object.
+	void setNextPoly(PolygonTrigger *nextPoly) {m_nextPolygonTrigger = nextPoly; invalidateSpatialIndex();} ///< Link the next map object.
 	void addPoint(const ICoord3D &point);
 	void setPoint(const ICoord3D &point, Int ndx);
 	void insertPoint(const ICoord3D &point, Int ndx);
@@ -140,6 +157,10 @@ public:
 	void setRiverStart(Int val) {m_riverStart = val;} 
 	const WaterHandle* getWaterHandle(void) const;
 	Bool isValid(void) const;
+
+	void addOccupant(ObjectID id) const;
+	void removeOccupant(ObjectID id) const;
+	const ObjectIDVector &getOccupants(void) const {return m_occupants;}	///< Objects inside, in no particular order.
 };
 
 #endif
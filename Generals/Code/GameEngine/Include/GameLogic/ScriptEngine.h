@@ -103,6 +103,13 @@ typedef std::list<PairAsciiStringUINT> ListAsciiStringUINT;
 typedef ListAsciiStringUINT::iterator ListAsciiStringUINTIt;
 
 typedef std::map< const ThingTemplate *, Int, std::less<const ThingTemplate *> > AttackPriorityMap;
+// Name lookups for the named object cache, counters, flags and scripts.  The vectors/arrays
+// they index stay authoritative (and ordered) for xfer and crc.
+typedef std::unordered_map<NameKeyType, Int, rts::hash<NameKeyType>, rts::equal_to<NameKeyType> > NameKeyIndexMap;
+typedef std::unordered_map<const Object *, Int> ObjectIndexMap;
+typedef std::unordered_map<NameKeyType, Script *, rts::hash<NameKeyType>, rts::equal_to<NameKeyType> > ScriptNameMap;
+typedef std::unordered_map<NameKeyType, ScriptGroup *, rts::hash<NameKeyType>, rts::equal_to<NameKeyType> > ScriptGroupNameMap;
+
 typedef std::pair<AsciiString, ObjectID> AsciiStringObjectIDPair;
 typedef std::list<AsciiStringObjectIDPair> ListAsciiStringObjectID;
 typedef std::list<AsciiStringObjectIDPair>::iterator ListAsciiStringObjectIDIt;
@@ -222,6 +229,24 @@ class ScriptEngine : public SubsystemInterface,
 public:
 	enum {MAX_COUNTERS=256, MAX_FLAGS=256, MAX_ATTACK_PRIORITIES=256};
 	enum TFade {FADE_NONE, FADE_SUBTRACT, FADE_ADD, FADE_SATURATE, FADE_MULTIPLY};
+
+	/// Game state changes that script conditions can depend on.  Conditions that subscribe
+	/// to events (see getConditionEventMask) are only re-evaluated after one of them fires.
+	enum ScriptEventType 
+	{
+		SCRIPT_EVENT_OBJECT_COUNT = 0,	///< An object was created, destroyed, died or finished construction.
+		SCRIPT_EVENT_TEAM_MEMBERSHIP,		///< An object changed teams, or a team changed players.
+		SCRIPT_EVENT_AREA_OCCUPANCY,		///< An object entered or exited a trigger area.
+		SCRIPT_EVENT_CREDITS,						///< A player's money changed.
+		SCRIPT_EVENT_OBJECT_TYPES,			///< An object type list was modified.
+		SCRIPT_EVENT_UI_INTERACTION,		///< A ui interaction was signalled or cleared.
+		SCRIPT_EVENT_COUNTER,						///< A counter changed.  Tracked per counter.
+		SCRIPT_EVENT_TIMER,							///< A timer started, stopped or expired.  Tracked per counter.
+		SCRIPT_EVENT_FLAG,							///< A flag changed.  Tracked per flag.
+
+		SCRIPT_EVENT_COUNT
+	};
+
 	ScriptEngine();
 	virtual ~ScriptEngine();
 
@@ -234,6 +259,8 @@ public:
 	void notifyOfTeamDestruction(Team *teamDestroyed);
 	void notifyOfObjectCreationOrDestruction(void);
 	UnsignedInt getFrameObjectCountChanged(void) {return m_frameObjectCountChanged;}
+	void notifyOfScriptEvent(ScriptEventType event) {m_scriptEventSerials[event] = ++m_scriptEventSerial;}
+	void getConditionEvaluationStats(UnsignedInt *evaluated, UnsignedInt *skipped) const;
 	void setSequentialTimer(Object *obj, Int frameCount);
 	void setSequentialTimer(Team *team, Int frameCount);
 	
@@ -370,6 +397,9 @@ protected:
 	void executeScript( Script *pScript );
 	Script *findScript(const AsciiString& name);
 	ScriptGroup *findGroup(const AsciiString& name);
+	void buildScriptNameIndex(void);
+	void addNamedObjectEntry(const AsciiString& name, Object *obj);
+	void rebuildNameIndexes(void);
 	void setSway( ScriptAction *pAction );
 	void setCounter( ScriptAction *pAction );
 	void addCounter( ScriptAction *pAction );
@@ -388,6 +418,12 @@ protected:
 	Bool evaluateFlag( Condition *pCondition );
 	Bool evaluateTimer( Condition *pCondition );
 	Bool evaluateCondition( Condition *pCondition );
+	Bool evaluateConditionUncached( Condition *pCondition );
+	Int getConditionEventMask( Condition *pCondition );
+	Bool isConditionCacheValid( Condition *pCondition, Int eventMask );
+	void invalidateConditionCache( void );
+	void touchCounter( Int counterNdx ) {m_counterSerials[counterNdx] = m_timerSerials[counterNdx] = ++m_scriptEventSerial;}
+	void touchFlag( Int flagNdx ) {m_flagSerials[flagNdx] = ++m_scriptEventSerial;}
 	void executeActions( ScriptAction *pActionHead );
 
 	void setPriorityThing( ScriptAction *pAction );
@@ -434,6 +470,13 @@ protected:
 	Team							*m_conditionTeam;				///< Team that is being used to evaluate conditions, used for THIS_TEAM
 	Object						*m_conditionObject;				///< Unit that is being used to evaluate conditions, used for THIS_OBJECT
 	VecNamedRequests	m_namedObjects;
+	NameKeyIndexMap		m_namedObjectIndex;		///< Name -> index in m_namedObjects.
+	ObjectIndexMap		m_namedObjectPtrIndex;	///< Live object -> index in m_namedObjects.
+	NameKeyIndexMap		m_counterIndex;				///< Name -> index in m_counters.
+	NameKeyIndexMap		m_flagIndex;					///< Name -> index in m_flags.
+	ScriptNameMap			m_scriptIndex;				///< Built on first use after a new map.
+	ScriptGroupNameMap m_scriptGroupIndex;
+	Bool							m_scriptIndexBuilt;
 	Bool							m_firstUpdate;			
 	Player						*m_currentPlayer;
 	Player						*m_skirmishHumanPlayer;
@@ -450,6 +493,22 @@ protected:
 
 	UnsignedInt				m_frameObjectCountChanged;
 
+	// Condition dependency tracking.  Serials only ever increase, so a cached condition result
+	// is valid as long as nothing it depends on has a serial newer than the one it was cached at.
+	UnsignedInt				m_scriptEventSerial;			///< Last serial handed out.
+	UnsignedInt				m_conditionCacheResetSerial;	///< Results cached before this serial are stale.
+	UnsignedInt				m_scriptEventSerials[SCRIPT_EVENT_COUNT];
+	UnsignedInt				m_counterSerials[MAX_COUNTERS];
+	UnsignedInt				m_timerSerials[MAX_COUNTERS];
+	UnsignedInt				m_flagSerials[MAX_FLAGS];
+	UnsignedInt				m_conditionEvaluations;			///< Conditions evaluated since the last reset.
+	UnsignedInt				m_conditionEvaluationsSkipped;	///< ... of which answered from the cache.
+#ifdef DEBUG_LOGGING
+	UnsignedInt				m_conditionEvaluationsByType[Condition::NUM_ITEMS];	///< The same two per condition type, to show which ones are still polled.
+	UnsignedInt				m_conditionEvaluationsSkippedByType[Condition::NUM_ITEMS];
+	AsciiString				m_conditionStatsMapName;		///< The map the counts are for.
+#endif
+
 	ObjectTypeCount		m_objectCounts[MAX_PLAYER_COUNT];
 
 	/// These are three separate lists rather than one to increase speed efficiency
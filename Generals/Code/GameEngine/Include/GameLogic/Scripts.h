@@ -980,6 +980,11 @@ protected:
 	Int				m_hasWarnings; ///< Runtime flag used by the editor only.
 	Int				m_customData; 
 
+	// Runtime only, used by ScriptEngine to skip conditions whose dependencies haven't changed.
+	Int					m_eventMask;		///< Script events this condition depends on, 0 = always poll, -1 = not computed yet.
+	UnsignedInt	m_evalSerial;		///< Script event serial when m_cachedValue was computed, 0 = never.
+	Bool				m_cachedValue;	///< Result of the last evaluation.
+
 public:
 	void setConditionType(enum ConditionType type);
 
@@ -1003,6 +1008,12 @@ public:
 	Int getCustomData(void) const {return m_customData;}
 	void setCustomData(Int val) { m_customData = val;}
 
+	Int getEventMask(void) const {return m_eventMask;}
+	void setEventMask(Int mask) {m_eventMask = mask;}
+	UnsignedInt getEvalSerial(void) const {return m_evalSerial;}
+	Bool getCachedValue(void) const {return m_cachedValue;}
+	void setCachedValue(Bool value, UnsignedInt serial) {m_cachedValue = value; m_evalSerial = serial;}
+
 	static void WriteConditionDataChunk(DataChunkOutput &chunkWriter, Condition *pCond);
 	static Bool ParseConditionDataChunk(DataChunkInput &file, DataChunkInfo *info, void *userData);
 
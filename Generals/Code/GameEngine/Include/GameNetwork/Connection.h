@@ -44,6 +44,31 @@
 #include "GameNetwork/NetPacket.h"
 
 #define CONNECTION_LATENCY_HISTORY_LENGTH 200
+#define CONNECTION_WRAPPER_WINDOW 64		///< Most wrapper commands that can be waiting for an ack at once.
+#define CONNECTION_REDUNDANT_SENDS 2		///< Most extra copies of a frame's commands to send on a lossy connection.
+#define CONNECTION_MAX_PACKETS_PER_SEND (MAX_MESSAGES / MAX_SLOTS)	///< Our share of the transport's send slots.
+
+/**
+ * Commands are packed a class at a time, in this order, so the ones the game is waiting on go first.
+ */
+enum ConnectionSendClass {
+	CONNECTION_SEND_FRAME = 0,		///< Frame info, game commands, and anything else that holds up a frame.
+	CONNECTION_SEND_ACK,
+	CONNECTION_SEND_CONTROL,			///< Keep-alives, disconnect screen traffic, load progress.
+	CONNECTION_SEND_CHAT,
+	CONNECTION_SEND_FILE,					///< Map transfers.
+
+	CONNECTION_SEND_CLASS_COUNT
+};
+
+/**
+ * Token bucket limiting how many bytes a send class can put on the wire.
+ */
+struct ConnectionSendBucket {
+	Int m_rate;										///< Bytes per second, 0 for no limit.
+	Int m_burst;									///< Most tokens that can build up.
+	Int m_tokens;									///< Bytes that can go out now.  Can go negative by up to one command.
+};
 
 class Connection : public MemoryPoolObject
 {
@@ -67,6 +92,10 @@ public:
 	void setFrameGrouping(time_t frameGrouping);
 
 	void sendNetCommandMsg(NetCommandMsg *msg, UnsignedByte relay);
+	void sendNetCommandMsg(NetCommandMsg *msg, UnsignedByte relay, NetCommandList *wrappedCommands);
+
+	/// Split msg into wrapper commands if it won't fit in one packet.  Returns NULL if it fits.
+	static NetCommandList * splitNetCommandMsg(NetCommandMsg *msg);
 
 	// These two processAck calls do the same thing, just take different types of ACK commands.
 	NetCommandRef * processAck(NetAckBothCommandMsg *msg);
@@ -81,10 +110,18 @@ public:
 
 #if defined(_DEBUG) || defined(_INTERNAL)
 	void debugPrintCommands();
+	void getAckLatencyTotals(Int sendClass, Int &acks, Real &latency);	///< Acks and summed send to ack milliseconds for a send class, since init.
 #endif
 
 protected:
 	void doRetryMetrics();
+	void addRedundantCommands(NetPacket *packet, time_t curtime);
+	Bool isLossy();
+	void queuePacket(NetPacket *packet, TransportMessage *slot, time_t curtime);
+	void refillSendBuckets(time_t curtime);
+	void resetSendClassMetrics();
+	static ConnectionSendClass getSendClass(NetCommandRef *ref);
+	static ConnectionSendClass getSendClass(NetCommandMsg *msg);
 
 	Bool m_isQuitting;
 	UnsignedInt m_quitTime;
@@ -100,7 +137,24 @@ protected:
 	time_t m_frameGrouping;				///< The minimum time between packet sends.
 	time_t m_lastTimeSent;				///< The time of the last packet send.
 	Int m_numRetries;							///< The number of retries for the last second.
+	Int m_lastNumRetries;					///< m_numRetries for the previous retry metrics period.
+	Int m_numGapResends;					///< Resends sent early for ack gaps.  Not counted in m_numRetries.
+	Int m_numRedundantSends;			///< Extra copies of frame commands sent this retry metrics period.
 	time_t m_retryMetricsTime;		///< The start time of the current retry metrics thing.
+
+	ConnectionSendBucket m_sendBuckets[CONNECTION_SEND_CLASS_COUNT];
+	time_t m_lastBucketRefill;
+
+	// Per send class counts for the current retry metrics period.
+	Int m_commandsSent[CONNECTION_SEND_CLASS_COUNT];
+	Int m_bytesSent[CONNECTION_SEND_CLASS_COUNT];
+	Int m_sendsDeferred[CONNECTION_SEND_CLASS_COUNT];		///< Times the class was held back by its bucket or the packet limit.
+	Int m_acksReceived[CONNECTION_SEND_CLASS_COUNT];
+	Real m_ackLatencyTotal[CONNECTION_SEND_CLASS_COUNT];	///< Sum of send to ack times, in milliseconds.
+
+	// The same two for the whole game, never reset.
+	Int m_totalAcksReceived[CONNECTION_SEND_CLASS_COUNT];
+	Real m_totalAckLatency[CONNECTION_SEND_CLASS_COUNT];
 };
 
 #endif
@@ -114,6 +114,7 @@ public:
 	Real getOutgoingPacketsPerSecond( void );
 	Real getUnknownBytesPerSecond( void );
 	Real getUnknownPacketsPerSecond( void );
+	Real getSocketCallsPerSecond( void );
 	UnsignedInt getPacketArrivalCushion( void );
 
 	UnsignedInt getMinimumCushion();
@@ -142,6 +143,7 @@ public:
 
 #if defined(_DEBUG) || defined(_INTERNAL)
 	void debugPrintConnectionCommands();
+	void getAckLatencyTotals(Int sendClass, Int &acks, Real &latency);
 #endif
 
 	// For disconnect blame assignment
@@ -175,6 +177,7 @@ private:
 	//	void doPerFrameMetrics(UnsignedInt frame);
 	void getMinimumFps(Int &minFps, Int &minFpsPlayer);			///< Returns the smallest FPS in the m_fpsAverages list.
 	Real getMaximumLatency(); ///< This actually sums the two biggest latencies in the m_latencyAverages list.
+	Real getRunAheadLatency();	///< The local latency to base run ahead on, allowing for jitter.
 
 	void requestFrameDataResend(Int playerID, UnsignedInt frame); ///< request of this player that he send the specified frame's data.
 
@@ -211,6 +214,10 @@ private:
 	UnsignedInt m_smallestPacketArrivalCushion;
 	Bool m_didSelfSlug;
 
+	time_t m_lastRunAheadMetricsTime;							///< When we last sent (or, as the packet router, acted on) run ahead metrics.
+	Int m_keepAliveIndex;													///< The next slot doKeepAlive will send to.
+	time_t m_keepAliveStartTime;
+
 	// -----------------------------------------------------------------------------
 	FileCommandMap s_fileCommandMap;
 	FileMaskMap s_fileRecipientMaskMap;
@@ -48,7 +48,11 @@ public:
 	Int getAverageFPS();
 	Int getMinimumCushion();
 
+	Real getLatencyPercentile(Int percent);		///< The latency that percent of the history is at or below.
+
 protected:
+	static Real getPercentile(const Real *list, Int length, Int percent);
+
 	// These are used for keeping track of parameters to the run ahead equation.
 	// frames per second history variables.
 	Real *m_fpsList;								///< A record of how many game logic frames per second there were for the last 60 seconds.
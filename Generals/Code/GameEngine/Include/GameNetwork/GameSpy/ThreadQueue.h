@@ -0,0 +1,193 @@
+/*
+**	Command & Conquer Generals(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+// FILE: ThreadQueue.h //////////////////////////////////////////////////////
+// Generals GameSpy thread message queues
+
+#pragma once
+
+#ifndef __GAMESPY_THREADQUEUE_H__
+#define __GAMESPY_THREADQUEUE_H__
+
+#include <atomic>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+//-------------------------------------------------------------------------
+/** A bounded ring for exactly one producer thread and one consumer thread.
+		Neither side ever takes a lock.  SIZE must be a power of two. */
+//-------------------------------------------------------------------------
+template <class T, Int SIZE>
+class SPSCRingQueue
+{
+public:
+	SPSCRingQueue() : m_head(0), m_tail(0) {}
+
+	/// Producer only.  Returns false if the ring is full.
+	Bool push( const T& item )
+	{
+		UnsignedInt tail = m_tail.load(std::memory_order_relaxed);
+		if (tail - m_head.load(std::memory_order_acquire) >= (UnsignedInt)SIZE)
+			return false;
+
+		m_items[tail % SIZE] = item;
+		m_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	/// Consumer only.  Returns false if the ring is empty.
+	Bool pop( T& item )
+	{
+		UnsignedInt head = m_head.load(std::memory_order_relaxed);
+		if (head == m_tail.load(std::memory_order_acquire))
+			return false;
+
+		item = m_items[head % SIZE];
+		m_items[head % SIZE] = T();	// don't hang on to the strings until the slot comes around again
+		m_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	T													m_items[SIZE];
+	std::atomic<UnsignedInt>	m_head;		///< next slot to read, only written by the consumer
+	std::atomic<UnsignedInt>	m_tail;		///< next slot to write, only written by the producer
+};
+
+//-------------------------------------------------------------------------
+/** The queue between the UI and a GameSpy thread.  Any thread may add to it,
+		but only one thread may take from it.  The first few threads to add get a
+		lock-free ring each; any thread after that, or one whose ring is full,
+		goes through a locked queue instead.  Items from any one thread come out
+		in the order they went in. */
+//-------------------------------------------------------------------------
+template <class T>
+class GameSpyThreadQueue
+{
+public:
+	enum { MAX_LANES = 3, LANE_SIZE = 64 };
+
+	GameSpyThreadQueue() : m_sharedCount(0), m_nextLane(0)
+	{
+		for (Int i=0; i<MAX_LANES; ++i)
+			m_lanes[i].m_overflowCount = 0;
+	}
+
+	void push( const T& item )
+	{
+		Lane *lane = getLane();
+
+		// once a lane has spilled over, it has to keep spilling until the consumer catches up,
+		// or newer items would jump ahead of the ones waiting in the overflow.
+		if (lane && lane->m_overflowCount.load(std::memory_order_acquire) == 0 && lane->m_ring.push(item))
+			return;
+
+		std::lock_guard<std::mutex> lock(m_overflowMutex);
+		if (lane)
+		{
+			lane->m_overflow.push(item);
+			++lane->m_overflowCount;
+		}
+		else
+		{
+			m_shared.push(item);
+			++m_sharedCount;
+		}
+	}
+
+	/// Consumer only.  The lanes take turns so one busy thread can't starve the others.
+	Bool pop( T& item )
+	{
+		for (Int i=0; i<MAX_LANES; ++i)
+		{
+			Int index = (m_nextLane + i) % MAX_LANES;
+			if (popLane(m_lanes[index], item))
+			{
+				m_nextLane = (index + 1) % MAX_LANES;
+				return true;
+			}
+		}
+
+		if (m_sharedCount.load(std::memory_order_acquire) == 0)
+			return false;
+
+		std::lock_guard<std::mutex> lock(m_overflowMutex);
+		if (m_shared.empty())
+			return false;
+		item = m_shared.front();
+		m_shared.pop();
+		--m_sharedCount;
+		return true;
+	}
+
+private:
+	struct Lane
+	{
+		std::atomic<std::thread::id>	m_owner;
+		SPSCRingQueue<T, LANE_SIZE>		m_ring;
+		std::queue<T>									m_overflow;				///< guarded by m_overflowMutex
+		std::atomic<Int>							m_overflowCount;
+	};
+
+	/// The calling thread's lane, claiming a free one if it doesn't have one yet.  NULL if they're all taken.
+	Lane *getLane( void )
+	{
+		std::thread::id me = std::this_thread::get_id();
+		for (Int i=0; i<MAX_LANES; ++i)
+		{
+			std::thread::id owner = m_lanes[i].m_owner.load(std::memory_order_acquire);
+			if (owner == me)
+				return &m_lanes[i];
+			if (owner == std::thread::id() && m_lanes[i].m_owner.compare_exchange_strong(owner, me))
+				return &m_lanes[i];
+		}
+		return NULL;
+	}
+
+	Bool popLane( Lane& lane, T& item )
+	{
+		if (lane.m_ring.pop(item))
+			return true;
+
+		if (lane.m_overflowCount.load(std::memory_order_acquire) == 0)
+			return false;
+
+		std::lock_guard<std::mutex> lock(m_overflowMutex);
+		if (lane.m_overflow.empty())
+			return false;
+		item = lane.m_overflow.front();
+		lane.m_overflow.pop();
+		--lane.m_overflowCount;
+		return true;
+	}
+
+	Lane							m_lanes[MAX_LANES];
+	std::mutex				m_overflowMutex;
+	std::queue<T>			m_shared;						///< threads that didn't get a lane, guarded by m_overflowMutex
+	std::atomic<Int>	m_sharedCount;
+	Int								m_nextLane;					///< consumer only
+};
+
+#endif // __GAMESPY_THREADQUEUE_H__
@@ -0,0 +1,107 @@
+/*
+**	Command & Conquer Generals(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+/** NetCaptureBenchmark.h */
+
+#pragma once
+
+#ifndef __NETCAPTUREBENCHMARK_H
+#define __NETCAPTUREBENCHMARK_H
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+
+#include "Lib/BaseType.h"
+#include "GameNetwork/NetworkDefs.h"
+
+class ConnectionManager;
+class NetCommandMsg;
+class NetCommandWrapperList;
+class Transport;
+struct NetCaptureRecord;
+struct NetCaptureUsers;
+
+/**
+ * Runs a -netCapture file through a ConnectionManager set up like the one that made it, as fast as
+ * it will go, and logs how long ConnectionManager::update took.  The ConnectionManager's Transport
+ * reads the datagrams the game received from the capture instead of a socket, and throws away what
+ * it sends.  There's no game logic, so the local player's commands are taken from the datagrams
+ * the game sent, and go back in the way Network gave them to the ConnectionManager in the first
+ * place.  Run with -netReplay.
+ */
+class NetCaptureBenchmark
+{
+public:
+	NetCaptureBenchmark();
+	~NetCaptureBenchmark();
+
+	Bool run(const char *filename);		///< Returns FALSE if filename isn't a capture we can read.
+
+	void send(TransportMessage *msg, Int len);		///< A datagram of len bytes going out of the transport, to nobody.
+	void receive(Transport *transport);						///< Hand the transport the datagrams the game received next.
+
+protected:
+	enum
+	{
+		REPLAY_ADDR = 0x7F000001,		///< Player n is at 127.0.0.(n+1).
+		REPLAY_PORT = 8088
+	};
+
+	Bool load(const char *filename);
+	const NetCaptureRecord *getRecord();
+	Bool unpackRecord(const NetCaptureRecord *record, TransportMessage *msg);
+	void start(const NetCaptureUsers *users);
+	void processSent(const NetCaptureRecord *record);
+	void sendLocalCommand(NetCommandMsg *msg);
+	void update();
+	void logResults(Int64 totalNS);
+
+	UnsignedByte *m_data;		///< The whole capture, read in up front so the disk isn't part of the timing.
+	Int m_dataLength;
+	Int m_offset;						///< Where the next record starts.
+
+	ConnectionManager *m_conMgr;
+	Int m_localSlot;
+	UnsignedInt m_frame;		///< The next frame to run.
+	NetCommandWrapperList *m_sentWrappers;		///< Puts the local player's large commands back together.
+	UnsignedByte m_sentIDs[65536 / 8];				///< The local command IDs already given to m_conMgr, one bit each.
+
+	Int m_datagramsSent;
+	Int m_datagramsReceived;
+	Int m_datagramsBad;
+	Int m_bytes;
+	Int m_localCommands;
+	Int m_framesRun;
+	Int m_packetsBuilt;
+	Int m_bytesBuilt;
+	Int m_updates;
+
+	Int64 m_updateNS;				///< In ConnectionManager::update.
+	Int64 m_longestUpdateNS;
+	Int64 m_localNS;				///< Giving the ConnectionManager the local player's commands.
+	Int64 m_frameNS;				///< Checking frames are ready and taking their commands.
+};
+
+#endif // defined(_DEBUG) || defined(_INTERNAL)
+
+#endif // __NETCAPTUREBENCHMARK_H
@@ -29,19 +29,21 @@
 #define __NETCOMMANDLIST_H
 
 #include "Common/GameMemory.h"
+#include "Common/STLTypedefs.h"
 #include "GameNetwork/NetCommandRef.h"
 
 /**
  * The NetCommandList is a ordered linked list of NetCommandRef objects.
- * The list is ordered based on the command id, player id, and command type.
+ * The list is ordered based on the command type, player id, and command id.
  * It is ordered in this way to aid in constructing the packets efficiently.
- * The list keeps track of the last message inserted in order to accommodate
- * adding commands in order more efficiently since that is whats going to be
- * done most of the time.  If the new message doesn't go after the last message
- * inserted, then the list will be traversed linearly until the proper spot is
- * found.  We can get away with this inefficient method since these occurances
- * will be rare.  Also, the list is not expected to ever have more than 30 or so
- * commands on it at a time.  Five commands would probably be a normal amount.
+ * All the commands of one type from one player form a contiguous section of
+ * the list, and the list keeps track of the last node of each section, so a
+ * command that goes at the end of its section (the usual case) is added without
+ * walking the list, and the first command of a new section is placed after
+ * the last node of the section before it.  Commands that require a command id are also indexed by
+ * player id and command id, so acks and duplicate checks don't have to walk the
+ * list either.  Under packet loss the resend lists can get fairly long, and
+ * every ack used to be a linear search.
  */
 
 class NetCommandList : public MemoryPoolObject
@@ -63,12 +65,23 @@ public:
 																								///< a command id.
 	void removeMessage(NetCommandRef *msg);			///< Remove the given message from the list.
 	void appendList(NetCommandList *list);			///< Append the given list to the end of this list.
-	Int length();									///< Returns the number of nodes in this list.  This is inefficient and is meant to be a debug tool.
+	Int length();									///< Returns the number of nodes in this list.
 
 protected:
+	typedef std::unordered_map< UnsignedInt, NetCommandRef *, rts::hash<UnsignedInt>, rts::equal_to<UnsignedInt> > NetCommandRefMap;
+	typedef std::map< UnsignedInt, NetCommandRef * > NetCommandSectionMap;	///< Ordered the same way as the list.
+
+	static UnsignedInt getCommandKey(UnsignedShort commandID, UnsignedByte playerID);	///< Key into m_commandIndex.
+	static UnsignedInt getSectionKey(NetCommandMsg *msg);		///< Key into m_sectionTails.
+	NetCommandRef * findInsertPosition(NetCommandMsg *msg);		///< Node the message should go after, NULL for the head.
+	void insertAfter(NetCommandRef *msg, NetCommandRef *prev);	///< Link msg in after prev and add it to the indices.
+
 	NetCommandRef *m_first;							///< Head of the list.
 	NetCommandRef *m_last;							///< Tail of the list.
 	NetCommandRef *m_lastMessageInserted;			///< The last message that was inserted to this list.
+	Int m_length;									///< Number of nodes in the list.
+	NetCommandRefMap m_commandIndex;				///< Commands that require a command id, by player id and command id.
+	NetCommandSectionMap m_sectionTails;			///< Last node of each command type and player id section.
 };
 
 #endif
@@ -85,6 +85,8 @@ public:
 	GameMessage *constructGameMessage();
 	void addArgument(const GameMessageArgumentDataType type, GameMessageArgumentType arg);
 	void setGameMessageType(GameMessage::Type type);
+	GameMessage::Type getGameMessageType();
+	GameMessageArgument *getArgumentList();
 
 	// For debugging purposes
 	virtual AsciiString getContentsAsAsciiString(void);
@@ -430,11 +432,15 @@ public:
 	UnsignedByte * getFileData();
 	void setFileData(UnsignedByte *data, UnsignedInt dataLength);
 
+	Bool isCompressed() { return m_isCompressed; }
+	void setCompressed(Bool compressed) { m_isCompressed = compressed; }
+
 protected:
 	AsciiString m_portableFilename;
 
 	UnsignedByte *m_data;
 	UnsignedInt m_dataLength;
+	Bool m_isCompressed;		///< The data went through the CompressionManager and has to be decompressed on arrival.
 };
 
 //-----------------------------------------------------------------------------
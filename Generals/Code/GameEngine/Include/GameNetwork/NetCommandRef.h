@@ -65,12 +65,24 @@ public:
 	time_t getTimeLastSent() const;
 	void setTimeLastSent(time_t timeLastSent);
 
+	UnsignedByte getRedundantSends() const;
+	void setRedundantSends(UnsignedByte redundantSends);
+
+	Bool isGapResend() const;
+	void setGapResend(Bool gapResend);
+
+	Int getSendClass() const;
+	void setSendClass(Int sendClass);
+
 protected:
 	NetCommandMsg *m_msg;
 	NetCommandRef *m_next;
 	NetCommandRef *m_prev;
 	UnsignedByte m_relay; ///< Need this in the command reference since the relay value will be different depending on where this particular reference is being sent.
 	time_t m_timeLastSent;
+	UnsignedByte m_redundantSends; ///< Extra copies that went out in later packets while waiting for the ack.
+	Bool m_gapResend; ///< The next send is early because a later command was acked first, not a retry.
+	Int m_sendClass; ///< For a wrapper, the send class of the command it carries.  -1 to go by the command type.
 
 #ifdef DEBUG_NETCOMMANDREF
 	UnsignedInt m_id;
@@ -133,6 +145,54 @@ inline void NetCommandRef::setTimeLastSent(time_t timeLastSent)
 	m_timeLastSent = timeLastSent;
 }
 
+/**
+ * Return the number of extra copies of this command that have been sent from this reference.
+ */
+inline UnsignedByte NetCommandRef::getRedundantSends() const
+{
+	return m_redundantSends;
+}
+
+/**
+ * Set the number of extra copies of this command that have been sent from this reference.
+ */
+inline void NetCommandRef::setRedundantSends(UnsignedByte redundantSends) 
+{
+	m_redundantSends = redundantSends;
+}
+
+/**
+ * Return true if this command is due to be resent early because of a gap in the acks.
+ */
+inline Bool NetCommandRef::isGapResend() const
+{
+	return m_gapResend;
+}
+
+/**
+ * Mark this command as due to be resent early because of a gap in the acks.
+ */
+inline void NetCommandRef::setGapResend(Bool gapResend) 
+{
+	m_gapResend = gapResend;
+}
+
+/**
+ * Return the send class recorded for this reference, or -1 if there isn't one.
+ */
+inline Int NetCommandRef::getSendClass() const
+{
+	return m_sendClass;
+}
+
+/**
+ * Record the send class for this reference, for wrappers that should go out with the command they carry.
+ */
+inline void NetCommandRef::setSendClass(Int sendClass) 
+{
+	m_sendClass = sendClass;
+}
+
 /**
  * Set the send relay for this reference of the command.
  */
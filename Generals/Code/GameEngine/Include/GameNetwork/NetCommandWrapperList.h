@@ -36,7 +36,7 @@ class NetCommandWrapperListNode : public MemoryPoolObject
 {
 	MEMORY_POOL_GLUE_WITH_USERLOOKUP_CREATE(NetCommandWrapperListNode, "NetCommandWrapperListNode")		
 public:
-	NetCommandWrapperListNode(NetWrapperCommandMsg *msg);
+	NetCommandWrapperListNode(NetWrapperCommandMsg *msg, UnsignedByte relay);
 	//virtual ~NetCommandWrapperListNode();
 
 	Bool isComplete();
@@ -44,6 +44,7 @@ public:
 	UnsignedInt getRawDataLength();
 	void copyChunkData(NetWrapperCommandMsg *msg);
 	UnsignedByte * getRawData();
+	UnsignedByte getRelay();
 
 	Int getPercentComplete(void);
 
@@ -56,6 +57,7 @@ protected:
 	Bool *m_chunksPresent;
 	UnsignedInt m_numChunks;
 	UnsignedInt m_numChunksPresent;
+	UnsignedByte m_relay;	///< relay of the wrapper commands, which the wrapped command is delivered with.
 
 };
 
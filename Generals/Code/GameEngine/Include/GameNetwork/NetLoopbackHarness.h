@@ -0,0 +1,139 @@
+/*
+**	Command & Conquer Generals(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+/** NetLoopbackHarness.h */
+
+#pragma once
+
+#ifndef __NETLOOPBACKHARNESS_H
+#define __NETLOOPBACKHARNESS_H
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+
+#include "Lib/BaseType.h"
+#include "Common/AsciiString.h"
+#include "GameNetwork/NetworkDefs.h"
+
+class ConnectionManager;
+class GameInfo;
+class NetCommandList;
+class Transport;
+
+/**
+ * Plays a lockstep game between several ConnectionManagers in this process, with no game logic and
+ * no sockets.  Each peer's Transport hands its datagrams to the harness, which delivers them to the
+ * other peers with the -latAvg, -latAmp, -latPeriod, -latNoise, -packetloss, -packetReorder and
+ * -bandwidthCap impairments applied.  Every peer gives orders on a fixed script, and the harness
+ * checks that all of them get the same commands for every frame.  Run with -netHarness.
+ *
+ * With -netHarnessFile, the first peer also sends everybody a file of that many bytes a second
+ * into the game, the way a map transfer goes out, and the harness reports how long it took and
+ * the ack latency of each send class.  Add -noSendClasses to see it without the send scheduler.
+ *
+ * All the peers run the same logic frame, since TheGameLogic only has one frame counter.  A frame
+ * runs once every peer has its commands, so the harness stalls whenever the slowest peer would.
+ */
+class NetLoopbackHarness
+{
+public:
+	NetLoopbackHarness();
+	~NetLoopbackHarness();
+
+	Bool run(Int numPlayers, Int numFrames);		///< Returns FALSE if the peers ever disagreed about a frame, or stopped making progress.
+
+	void send(Int player, TransportMessage *msg, Int len);		///< A datagram of len bytes going out of this player's transport.
+	void receive(Int player, Transport *transport);						///< Deliver whatever has arrived for this player.
+
+protected:
+	enum
+	{
+		LOOPBACK_ADDR = 0x7F000001,		///< Player n is at 127.0.0.(n+1).
+		LOOPBACK_PORT = 8088,
+		STALL_TIMEOUT = 10000,				///< Give up if a frame takes this many milliseconds.
+		MAX_SCRIPTED_OBJECTS = 16,
+		FILE_SEND_FRAME = 30					///< When the -netHarnessFile file goes out.
+	};
+
+	struct Peer
+	{
+		ConnectionManager *conMgr;
+		UnsignedInt addr;
+		UnsignedShort port;
+		Int runAhead;
+		Int frameRate;
+		Int lastExecutionFrame;
+		Int lastFrameCompleted;
+		UnsignedInt bandwidthSecond;		///< When the current second of the bandwidth cap started.
+		UnsignedInt bandwidthBytes;			///< Bytes delivered to this peer in that second.
+	};
+
+	struct Datagram
+	{
+		Int from;
+		Int len;
+		TransportMessage message;
+	};
+
+	typedef std::multimap<UnsignedInt, Datagram> DatagramQueue;	///< By delivery time, and in send order for the same time.
+
+	void startPeer(Int player, GameInfo *game);
+	void beginFrame(Int player);
+	void sendScriptedCommands(Int player);
+	Int getExecutionFrame(Int player);
+	Bool runFrame(UnsignedInt frame);
+	Bool isSameFrame(NetCommandList *list1, NetCommandList *list2);
+	void processRunAhead(Int player, NetCommandList *list);
+	Int getFrameRate();
+	void startFileTransfer();
+	void updateFileTransfer();
+	void logResults(UnsignedInt totalTime, Bool ok);
+
+	Peer m_peers[MAX_SLOTS];
+	Int m_numPlayers;
+	DatagramQueue m_inFlight[MAX_SLOTS];		///< Datagrams on their way to each player.
+
+	Int m_framesRun;
+	Int m_framesMismatched;
+	Int m_commandsSent;
+	Int m_commandsExecuted;
+
+	Int m_stallCount;
+	UnsignedInt m_stallTime;			///< Milliseconds, summed over all stalls.
+	UnsignedInt m_longestStall;
+
+	Int m_datagramsSent;
+	Int m_datagramsLost;					///< Dropped by -packetloss.
+	Int m_datagramsCapped;				///< Dropped by -bandwidthCap.
+	Int m_datagramsBad;
+	Int m_bytesSent;
+
+	AsciiString m_fileName;
+	UnsignedInt m_fileSendTime;					///< 0 until the file goes out.
+	UnsignedInt m_fileDoneTime;					///< 0 until every peer has the file.
+	Bool m_fileReceived[MAX_SLOTS];
+};
+
+#endif // defined(_DEBUG) || defined(_INTERNAL)
+
+#endif // __NETLOOPBACKHARNESS_H
@@ -57,8 +57,8 @@ public:
 	NetPacket(TransportMessage *msg);
 	//virtual ~NetPacket();
 
-	void init();
-	void reset();
+	void init(UnsignedByte *buffer = NULL);
+	void reset(UnsignedByte *buffer = NULL);
 	void setAddress(Int addr, Int port);
 	Bool addCommand(NetCommandRef *msg);
 	Int getNumCommands();
@@ -184,6 +184,11 @@ protected:
 	Bool addFrameResendRequestCommand(NetCommandRef *msg);
 	Bool isRoomForFrameResendRequestMessage(NetCommandRef *msg);
 
+	void setLastCommand(NetCommandRef *ref);
+	void addFrameToPacket(UnsignedInt frame);
+	Int getFrameFieldSize(UnsignedInt frame);
+	Bool addRepeatToPacket();
+
 	Bool isAckRepeat(NetCommandRef *msg);
 	Bool isAckBothRepeat(NetCommandRef *msg);
 	Bool isAckStage1Repeat(NetCommandRef *msg);
@@ -224,17 +229,20 @@ protected:
 	void dumpPacketToLog();
 
 protected:
-	UnsignedByte		m_packet[MAX_PACKET_SIZE];
+	UnsignedByte		m_packetBuffer[MAX_PACKET_SIZE];
+	UnsignedByte*		m_packet;									///< m_packetBuffer, or the buffer passed to init
 	Int							m_packetLen;
 	UnsignedInt			m_addr;
 	Int							m_numCommands;
-	NetCommandRef*	m_lastCommand;
+	NetCommandMsg*	m_lastCommand;						///< attached while we hold it
+	UnsignedByte		m_lastCommandRelay;
 	UnsignedInt			m_lastFrame;
 	UnsignedShort		m_port;
 	UnsignedShort		m_lastCommandID;
 	UnsignedByte		m_lastPlayerID;
 	UnsignedByte		m_lastCommandType;
 	UnsignedByte		m_lastRelay;
+	Int							m_lastRepeatOffset;				///< where the last 'Z' or 'Y' was written, -1 if none
 };
 
 #endif // __NETPACKET_H
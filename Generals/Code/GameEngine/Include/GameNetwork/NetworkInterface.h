@@ -73,6 +73,9 @@ public:
 	virtual UnsignedInt getRunAhead(void) = 0;												///< Get the current RunAhead value
 	virtual UnsignedInt getFrameRate(void) = 0;												///< Get the current allowed frame rate.
 	virtual UnsignedInt getPacketArrivalCushion(void) = 0;						///< Get the smallest packet arrival cushion since this was last called.
+	virtual Real getEffectiveFrameRate(void) = 0;											///< Get the number of logic frames actually released per second.
+	virtual UnsignedInt getStallCount(void) = 0;											///< Get the number of times the game has waited on the network for more than a frame.
+	virtual UnsignedInt getStallTime(void) = 0;												///< Get the total time in milliseconds spent in those stalls.
 
 	// Chat functions
 	virtual void sendChat(UnicodeString text, Int playerMask) = 0;		///< Send a chat line using the normal system.
@@ -97,6 +100,7 @@ public:
 	virtual Real getOutgoingPacketsPerSecond( void ) = 0;
 	virtual Real getUnknownBytesPerSecond( void ) = 0;
 	virtual Real getUnknownPacketsPerSecond( void ) = 0;
+	virtual Real getSocketCallsPerSecond( void ) = 0;
 
 	virtual void updateLoadProgress( Int percent ) = 0;
 	virtual void loadProgressComplete( void ) = 0;
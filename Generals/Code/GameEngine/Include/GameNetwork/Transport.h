@@ -34,6 +34,46 @@
 #include "GameNetwork/udp.h"
 #include "GameNetwork/NetworkDefs.h"
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+// Capture files start with a NetCaptureFileHeader, followed by a NetCaptureRecord and
+// the raw datagram for everything the game sent or received, in the order it happened.
+// The datagrams are stored as they were on the wire, still encrypted, so the -netReplay
+// benchmark goes through exactly the same checks as a live packet.  When the game starts,
+// a NET_CAPTURE_USERS record says who's playing, so the benchmark can set up the same game.
+static const UnsignedInt NET_CAPTURE_MAGIC = 0x5043454E;	// "NECP"
+static const UnsignedInt NET_CAPTURE_VERSION = 2;
+
+enum
+{
+	NET_CAPTURE_SENT = 0,
+	NET_CAPTURE_RECEIVED = 1,
+	NET_CAPTURE_USERS = 2									///< a NetCaptureUsers instead of a datagram
+};
+
+#pragma pack(push, 1)
+struct NetCaptureFileHeader
+{
+	UnsignedInt magic;
+	UnsignedInt version;
+};
+
+struct NetCaptureRecord
+{
+	UnsignedInt time;											///< timeGetTime() when the datagram was sent or received
+	UnsignedByte direction;								///< NET_CAPTURE_SENT or NET_CAPTURE_RECEIVED
+	UnsignedInt addr;											///< the peer, in host order
+	UnsignedShort port;
+	UnsignedShort length;									///< number of datagram bytes that follow
+};
+
+struct NetCaptureUsers
+{
+	UnsignedByte localSlot;
+	UnsignedByte playerMask;							///< a bit for each slot with a player in it
+};
+#pragma pack(pop)
+#endif
+
 /**
  * The transport layer handles the UDP socket for the game, and will packetize and
  * de-packetize multiple ACK/CommandPacket/etc packets into larger aggregates.
@@ -46,25 +86,38 @@ class Transport //: public MemoryPoolObject
 public:
 
 	Transport();
-	~Transport();
+	virtual ~Transport();
 
 	Bool init( AsciiString ip, UnsignedShort port );
 	Bool init( UnsignedInt ip, UnsignedShort port );
 	void reset( void );
 	Bool update( void );									///< Call this once a GameEngine tick, regardless of whether the frame advances.
 
-	Bool doRecv( void );		///< call this to service the receive packets
-	Bool doSend( void );		///< call this to service the send queue.
+	// virtual so NetLoopbackHarness can stand in for the socket
+	virtual Bool doRecv( void );		///< call this to service the receive packets
+	virtual Bool doSend( void );		///< call this to service the send queue.
 
 	Bool queueSend(UnsignedInt addr, UnsignedShort port, const UnsignedByte *buf, Int len /*,
 		NetMessageFlags flags, Int id */);				///< Queue a packet for sending to the specified address and port.  This will be sent on the next update() call.
 
+	TransportMessage *getFreeSendSlot( void );	///< An empty send buffer to build a packet in directly, or NULL if the send queue is full.
+	void queueSendSlot(TransportMessage *slot, UnsignedInt addr, UnsignedShort port, Int len);	///< Queue a packet built in place in a slot from getFreeSendSlot().
+
 	inline Bool allowBroadcasts(Bool val) { if (!m_udpsock) return false; return (m_udpsock->AllowBroadcasts(val))?true:false; }
 
 	// Latency insertion and packet loss
 	void setLatency( Bool val ) { m_useLatency = val; }
 	void setPacketLoss( Bool val ) { m_usePacketLoss = val; }
 
+	static Bool unpackDatagram( TransportMessage *msg, Int len );	///< Decrypt a datagram of len bytes in place and check that it's one of ours.
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	// Traffic capture
+	void openCaptureFile( void );					///< Start the -netCapture named on the command line, if any.
+	void closeCaptureFile( void );
+	void captureUsers( Int localSlot, UnsignedByte playerMask );	///< Record who's in the game, if we're capturing.
+#endif
+
 	// Bandwidth metrics
 	Real getIncomingBytesPerSecond( void );
 	Real getIncomingPacketsPerSecond( void );
@@ -72,6 +125,7 @@ public:
 	Real getOutgoingPacketsPerSecond( void );
 	Real getUnknownBytesPerSecond( void );
 	Real getUnknownPacketsPerSecond( void );
+	Real getSocketCallsPerSecond( void );
 
 	TransportMessage m_outBuffer[MAX_MESSAGES];
 	TransportMessage m_inBuffer[MAX_MESSAGES];
@@ -96,10 +150,22 @@ private:
 	UnsignedInt m_incomingPackets[MAX_TRANSPORT_STATISTICS_SECONDS];
 	UnsignedInt m_unknownPackets[MAX_TRANSPORT_STATISTICS_SECONDS];
 	UnsignedInt m_outgoingPackets[MAX_TRANSPORT_STATISTICS_SECONDS];
+	UnsignedInt m_socketCalls[MAX_TRANSPORT_STATISTICS_SECONDS];
+	UnsignedInt m_lastSocketCalls;					///< m_udpsock's count as of the last update
 	Int m_statisticsSlot;
 	UnsignedInt m_lastSecond;
 
-	Bool isGeneralsPacket( TransportMessage *msg );
+	static Bool isGeneralsPacket( TransportMessage *msg );
+	Bool sendBatch( TransportMessage **batch, Int count );
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	// Traffic capture
+	FILE *m_captureFile;									///< every datagram we send or receive is written here, if open
+
+	void captureDatagram( UnsignedByte direction, UnsignedInt addr, UnsignedShort port, const unsigned char *buf, Int len );
+#endif
+
+	TransportMessage m_recvBatch[UDP::MAX_BATCH];	///< datagrams as they come off the socket, before they're checked
 };
 
 #endif // _TRANSPORT_H_
@@ -101,6 +101,7 @@ class UDP
   Int           SetBlocking(Int block);
 	
 	Int m_lastError;
+	UnsignedInt m_socketCalls;		// send and receive calls made on the socket, for the stats
 
  public:
                    UDP();
@@ -109,6 +110,16 @@ class UDP
   Int           Bind(const char *Host,UnsignedShort port);
   Int           Write(const unsigned char *msg,UnsignedInt len,UnsignedInt IP,UnsignedShort port);
   Int           Read(unsigned char *msg,UnsignedInt len,sockaddr_in *from);
+
+  enum { MAX_BATCH = 32 };	// most datagrams ReadMany and WriteMany will handle at once
+
+  // Read up to count datagrams (count <= MAX_BATCH) into msgs[i], each buffer len bytes, with the
+  // sizes in lens[i].  Returns the number read, or whatever Read would have returned if none were.
+  Int           ReadMany(unsigned char **msgs,UnsignedInt len,Int *lens,sockaddr_in *froms,Int count);
+  // Write count datagrams (count <= MAX_BATCH) in order, stopping at the first one that fails.
+  // Returns the number sent, or what Write returned for the first one if it failed.
+  Int           WriteMany(const unsigned char **msgs,const UnsignedInt *lens,const UnsignedInt *IPs,const UnsignedShort *ports,Int count);
+  UnsignedInt   GetSocketCalls(void) { return(m_socketCalls); }
   sockStat         GetStatus(void);
   void             ClearStatus(void);
   //int              Wait(Int sec,Int usec,fd_set &returnSet);
@@ -28,6 +28,7 @@
 #include "Common/ArchiveFileSystem.h"
 #include "Common/CommandLine.h"
 #include "Common/CRCDebug.h"
+#include "Common/FrameProfiler.h"
 #include "Common/LocalFileSystem.h"
 #include "Common/version.h"
 #include "GameClient/TerrainVisual.h" // for TERRAIN_LOD_MIN definition
@@ -461,6 +462,95 @@ Int parsePacketLoss(char *args[], int num)
 	return 2;
 }
 
+//=============================================================================
+//=============================================================================
+Int parsePacketReorder(char *args[], int num)
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_packetReorder = atoi(args[1]);
+	}
+	return 2;
+}
+
+//=============================================================================
+//=============================================================================
+Int parseBandwidthCap(char *args[], int num)
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_bandwidthCap = atoi(args[1]);
+	}
+	return 2;
+}
+
+//=============================================================================
+//=============================================================================
+Int parseNoEarlyResends(char *args[], int num)
+{
+	if (TheWritableGlobalData)
+	{
+		TheWritableGlobalData->m_noEarlyResends = TRUE;
+	}
+	return 1;
+}
+
+//=============================================================================
+//=============================================================================
+Int parseNoSendClasses(char *args[], int num)
+{
+	if (TheWritableGlobalData)
+	{
+		TheWritableGlobalData->m_noSendClasses = TRUE;
+	}
+	return 1;
+}
+
+//=============================================================================
+//=============================================================================
+Int parseNetCapture(char *args[], int num)
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_netCaptureFile = args[1];
+	}
+	return 2;
+}
+
+//=============================================================================
+//=============================================================================
+Int parseNetReplay(char *args[], int num)
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_netReplayFile = args[1];
+	}
+	return 2;
+}
+
+//=============================================================================
+//=============================================================================
+Int parseNetHarness(char *args[], int num)
+{
+	if (TheWritableGlobalData && num > 2)
+	{
+		TheWritableGlobalData->m_netHarnessPlayers = atoi(args[1]);
+		TheWritableGlobalData->m_netHarnessFrames = atoi(args[2]);
+	}
+	return 3;
+}
+
+//=============================================================================
+//=============================================================================
+Int parseNetHarnessFile(char *args[], int num)
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_netHarnessFileSize = atoi(args[1]);
+	}
+	return 2;
+}
+
 //=============================================================================
 //=============================================================================
 Int parseLowDetail(char *args[], int num)
@@ -679,6 +769,13 @@ Int parseVTune ( char *args[], int num )
 }
 /// end stuff for VTUNE
 
+Int parseCheckPartitionQueries( char *args[], int num )
+{
+	if( TheWritableGlobalData )
+		TheWritableGlobalData->m_checkPartitionQueries = TRUE;
+	return 1;
+}
+
 #endif // defined(_DEBUG) || defined(_INTERNAL)
 
 //=============================================================================
@@ -881,6 +978,50 @@ Int parsePlayStats(char *args[], int num)
 	return 2;
 }
 
+//=============================================================================
+/** -traceFrames <first> <last> [file]: record profiler zones for the given logic
+		frames and write them out as a Chrome trace. */
+//=============================================================================
+Int parseTraceFrames(char *args[], int num)
+{
+	if (num > 2)
+	{
+		const char *filename = "FrameTrace.json";
+		Int consumed = 3;
+		if (num > 3 && args[3][0] != '-')
+		{
+			filename = args[3];
+			consumed = 4;
+		}
+		FrameProfiler::captureFrames(atoi(args[1]), atoi(args[2]), filename);
+		return consumed;
+	}
+	return 1;
+}
+
+Int parseUpdateModuleStats(char *args[], int num)
+{
+	if (TheWritableGlobalData)
+	{
+		TheWritableGlobalData->m_updateModuleStats = TRUE;
+	}
+	return 1;
+}
+
+//=============================================================================
+/** -workerThreads <n>: how many threads the logic may split work across,
+		counting itself.  1 keeps everything on the logic thread. */
+//=============================================================================
+Int parseWorkerThreads(char *args[], int num)
+{
+	if (TheWritableGlobalData && num > 1)
+	{
+		TheWritableGlobalData->m_workerThreads = atoi(args[1]);
+		return 2;
+	}
+	return 1;
+}
+
 Int parseDemoLoadScreen(char *args[], int num)
 {
 	if (TheWritableGlobalData)
@@ -1105,6 +1246,9 @@ static CommandLineParam params[] =
 	{	"-particleEdit", parseParticleEdit },
 	{ "-scriptDebug", parseScriptDebug },
 	{ "-playStats", parsePlayStats },
+	{ "-traceFrames", parseTraceFrames },
+	{ "-updateModuleStats", parseUpdateModuleStats },
+	{ "-workerThreads", parseWorkerThreads },
 	{ "-mod", parseMod },
 #if !defined(_PLAYTEST) || (defined(_DEBUG) || defined(_INTERNAL))
 	{ "-noaudio", parseNoAudio },
@@ -1136,6 +1280,14 @@ static CommandLineParam params[] =
 	{ "-nomovecamera", parseNoMoveCamera },
 	{ "-nocinematic", parseNoCinematic },
 	{ "-packetloss", parsePacketLoss },
+	{ "-packetReorder", parsePacketReorder },
+	{ "-bandwidthCap", parseBandwidthCap },
+	{ "-noEarlyResends", parseNoEarlyResends },
+	{ "-noSendClasses", parseNoSendClasses },
+	{ "-netCapture", parseNetCapture },
+	{ "-netReplay", parseNetReplay },
+	{ "-netHarness", parseNetHarness },
+	{ "-netHarnessFile", parseNetHarnessFile },
 	{ "-latAvg", parseLatencyAverage },
 	{ "-latAmp", parseLatencyAmplitude },
 	{ "-latPeriod", parseLatencyPeriod },
@@ -1165,6 +1317,7 @@ static CommandLineParam params[] =
 	{ "-ignoreStackTrace", parseIgnoreStackTrace },
 	{ "-logToCon", parseLogToConsole },
 	{ "-vTune", parseVTune },
+	{ "-checkPartitionQueries", parseCheckPartitionQueries },
 	{ "-selectTheUnselectable", parseSelectAll },
 	// { "-RunAhead", parseRunAhead },
 	{ "-noshroud", parseNoShroud },
@@ -0,0 +1,270 @@
+/*
+**	Command & Conquer Generals(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+// FILE: FrameProfiler.cpp ////////////////////////////////////////////////////////////////////////
+// Scoped-zone timeline profiler with Chrome trace-event export.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "PreRTS.h"	// This must go first in EVERY cpp file int the GameEngine
+
+#include "Common/FrameProfiler.h"
+#include "Common/CriticalSection.h"
+
+//-------------------------------------------------------------------------------------------------
+/** Ring buffer of completed zones for one thread.  Only the owning thread writes to it. */
+//-------------------------------------------------------------------------------------------------
+struct FrameProfileThreadBuffer
+{
+	FrameProfileEvent*	m_events;
+	UnsignedInt					m_writeCount;		///< Total events ever written; the ring index is this modulo the size.
+	Int									m_slot;					///< Reported as the trace tid.
+};
+
+static FrameProfileThreadBuffer s_threadBuffers[FrameProfiler::MAX_THREADS];
+static Int s_numThreadBuffers = 0;
+static std::mutex s_threadBufferMutex;
+static thread_local FrameProfileThreadBuffer *s_myThreadBuffer = NULL;
+static thread_local Bool s_myThreadBufferFailed = FALSE;
+static Int s_logicThreadSlot = -1;
+
+typedef std::unordered_map< NameKeyType, AsciiString, rts::hash<NameKeyType>, rts::equal_to<NameKeyType> > KeyNameMap;
+static KeyNameMap s_keyNames;
+
+volatile Bool	FrameProfiler::s_capturing = FALSE;
+UnsignedInt		FrameProfiler::s_currentFrame = 0;
+UnsignedInt		FrameProfiler::s_captureFirstFrame = 0;
+UnsignedInt		FrameProfiler::s_captureLastFrame = 0;
+char					FrameProfiler::s_captureFilename[256] = "";
+
+//-------------------------------------------------------------------------------------------------
+/** Find or create the calling thread's buffer.  Returns NULL once all slots are taken. */
+//-------------------------------------------------------------------------------------------------
+static FrameProfileThreadBuffer *getMyThreadBuffer(void)
+{
+	if (s_myThreadBuffer || s_myThreadBufferFailed)
+		return s_myThreadBuffer;
+
+	std::lock_guard<std::mutex> lock(s_threadBufferMutex);
+	if (s_numThreadBuffers >= FrameProfiler::MAX_THREADS)
+	{
+		s_myThreadBufferFailed = TRUE;
+		return NULL;
+	}
+
+	FrameProfileThreadBuffer *buf = &s_threadBuffers[s_numThreadBuffers];
+	buf->m_events = new FrameProfileEvent[FrameProfiler::EVENTS_PER_THREAD];
+	buf->m_writeCount = 0;
+	buf->m_slot = s_numThreadBuffers;
+	++s_numThreadBuffers;
+
+	s_myThreadBuffer = buf;
+	return buf;
+}
+
+//-------------------------------------------------------------------------------------------------
+Int64 FrameProfiler::getTimeNS(void)
+{
+	static Int64 freq = 0;
+	if (freq == 0)
+		QueryPerformanceFrequency((LARGE_INTEGER *)&freq);
+
+	Int64 ticks;
+	QueryPerformanceCounter((LARGE_INTEGER *)&ticks);
+
+	// split the conversion so ticks * 1e9 can't overflow
+	return (ticks / freq) * 1000000000 + ((ticks % freq) * 1000000000) / freq;
+}
+
+//-------------------------------------------------------------------------------------------------
+void FrameProfiler::recordZone(const char *name, Int64 startNS, Int64 endNS)
+{
+	FrameProfileThreadBuffer *buf = getMyThreadBuffer();
+	if (buf == NULL)
+		return;
+
+	FrameProfileEvent &e = buf->m_events[buf->m_writeCount % EVENTS_PER_THREAD];
+	e.m_name = name;
+	e.m_startNS = startNS;
+	e.m_durationNS = endNS - startNS;
+	e.m_frame = s_currentFrame;
+	++buf->m_writeCount;
+}
+
+//-------------------------------------------------------------------------------------------------
+const char *FrameProfiler::getKeyName(NameKeyType key)
+{
+	KeyNameMap::const_iterator it = s_keyNames.find(key);
+	if (it != s_keyNames.end())
+		return it->second.str();
+
+	// keep our own reference so the string can't go away while it's sitting in a buffer
+	AsciiString &name = s_keyNames[key];
+	name = TheNameKeyGenerator->keyToName(key);
+	return name.str();
+}
+
+//-------------------------------------------------------------------------------------------------
+void FrameProfiler::startCapture(void)
+{
+	std::lock_guard<std::mutex> lock(s_threadBufferMutex);
+	for (Int i = 0; i < s_numThreadBuffers; ++i)
+		s_threadBuffers[i].m_writeCount = 0;
+
+	s_capturing = TRUE;
+}
+
+//-------------------------------------------------------------------------------------------------
+void FrameProfiler::stopCapture(void)
+{
+	s_capturing = FALSE;
+}
+
+//-------------------------------------------------------------------------------------------------
+void FrameProfiler::captureFrames(UnsignedInt firstFrame, UnsignedInt lastFrame, const char *filename)
+{
+	s_captureFirstFrame = firstFrame;
+	s_captureLastFrame = lastFrame;
+	strncpy(s_captureFilename, filename, sizeof(s_captureFilename) - 1);
+	s_captureFilename[sizeof(s_captureFilename) - 1] = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Zones are stamped with whatever frame was last passed in here, so this should be called at the
+		very top of the logic update. */
+//-------------------------------------------------------------------------------------------------
+void FrameProfiler::onFrame(UnsignedInt frame)
+{
+	s_currentFrame = frame;
+
+	if (s_logicThreadSlot < 0)
+	{
+		FrameProfileThreadBuffer *buf = getMyThreadBuffer();
+		if (buf)
+			s_logicThreadSlot = buf->m_slot;
+	}
+
+	if (s_captureFilename[0] == 0)
+		return;
+
+	if (!s_capturing && frame >= s_captureFirstFrame && frame <= s_captureLastFrame)
+	{
+		DEBUG_LOG(("FrameProfiler - capturing frames %d to %d\n", s_captureFirstFrame, s_captureLastFrame));
+		startCapture();
+	}
+	else if (s_capturing && frame > s_captureLastFrame)
+	{
+		stopCapture();
+		exportChromeTrace(s_captureFilename, s_captureFirstFrame, s_captureLastFrame);
+		s_captureFilename[0] = 0;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+static void writeJSONString(FILE *fp, const char *str)
+{
+	fputc('"', fp);
+	for (const char *c = str ? str : ""; *c; ++c)
+	{
+		if (*c == '"' || *c == '\\')
+			fputc('\\', fp);
+		if ((unsigned char)*c >= ' ')
+			fputc(*c, fp);
+	}
+	fputc('"', fp);
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Timestamps are written in microseconds relative to the earliest exported zone, which is what
+		chrome://tracing expects.  Other threads may still be recording into their buffers while this
+		runs, so it should be called after stopCapture(). */
+//-------------------------------------------------------------------------------------------------
+Bool FrameProfiler::exportChromeTrace(const char *filename, UnsignedInt firstFrame, UnsignedInt lastFrame)
+{
+	FILE *fp = fopen(filename, "w");
+	if (fp == NULL)
+	{
+		DEBUG_LOG(("FrameProfiler - couldn't open %s for writing\n", filename));
+		return FALSE;
+	}
+
+	std::lock_guard<std::mutex> lock(s_threadBufferMutex);
+
+	// find the time base first so the numbers in the file stay small
+	Int64 baseNS = 0;
+	Bool haveBase = FALSE;
+	for (Int i = 0; i < s_numThreadBuffers; ++i)
+	{
+		const FrameProfileThreadBuffer &buf = s_threadBuffers[i];
+		UnsignedInt count = min(buf.m_writeCount, (UnsignedInt)EVENTS_PER_THREAD);
+		for (UnsignedInt j = buf.m_writeCount - count; j < buf.m_writeCount; ++j)
+		{
+			const FrameProfileEvent &e = buf.m_events[j % EVENTS_PER_THREAD];
+			if (e.m_frame < firstFrame || e.m_frame > lastFrame)
+				continue;
+			if (!haveBase || e.m_startNS < baseNS)
+			{
+				baseNS = e.m_startNS;
+				haveBase = TRUE;
+			}
+		}
+	}
+
+	fprintf(fp, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+
+	Bool first = TRUE;
+	Int numEvents = 0;
+	for (Int i = 0; i < s_numThreadBuffers; ++i)
+	{
+		const FrameProfileThreadBuffer &buf = s_threadBuffers[i];
+
+		fprintf(fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"%s %d\"}}",
+			first ? "" : ",\n", buf.m_slot, buf.m_slot == s_logicThreadSlot ? "Logic" : "Thread", buf.m_slot);
+		first = FALSE;
+
+		if (buf.m_writeCount > EVENTS_PER_THREAD)
+		{
+			DEBUG_LOG(("FrameProfiler - thread %d wrapped, lost %d zones\n", buf.m_slot, buf.m_writeCount - EVENTS_PER_THREAD));
+		}
+
+		UnsignedInt count = min(buf.m_writeCount, (UnsignedInt)EVENTS_PER_THREAD);
+		for (UnsignedInt j = buf.m_writeCount - count; j < buf.m_writeCount; ++j)
+		{
+			const FrameProfileEvent &e = buf.m_events[j % EVENTS_PER_THREAD];
+			if (e.m_frame < firstFrame || e.m_frame > lastFrame)
+				continue;
+
+			fprintf(fp, ",\n{\"name\":");
+			writeJSONString(fp, e.m_name);
+			fprintf(fp, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%d,\"args\":{\"frame\":%u}}",
+				(e.m_startNS - baseNS) / 1000.0, e.m_durationNS / 1000.0, buf.m_slot, e.m_frame);
+			++numEvents;
+		}
+	}
+
+	fprintf(fp, "\n]}\n");
+	fclose(fp);
+
+	DEBUG_LOG(("FrameProfiler - wrote %d zones for frames %d to %d to %s\n", numEvents, firstFrame, lastFrame, filename));
+	return TRUE;
+}
@@ -64,6 +64,7 @@
 #include "Common/SpecialPower.h"
 #include "Common/TerrainTypes.h"
 #include "Common/Upgrade.h"
+#include "Common/WorkerPool.h"
 #include "Common/UserPreferences.h"
 #include "Common/Xfer.h"
 #include "Common/XferCRC.h"
@@ -102,6 +103,8 @@
 #include "GameNetwork/NetworkInterface.h"
 #include "GameNetwork/WOLBrowser/WebBrowser.h"
 #include "GameNetwork/LANAPI.h"
+#include "GameNetwork/NetCaptureBenchmark.h"
+#include "GameNetwork/NetLoopbackHarness.h"
 #include "GameNetwork/GameSpy/GameResultsThread.h"
 #include "GameNetwork/GameSpy/PeerDefs.h"
 #include "GameNetwork/GameSpy/PersistentStorageThread.h"
@@ -213,6 +216,8 @@ GameEngine::~GameEngine()
 	delete TheSubsystemList;
 	TheSubsystemList = NULL;
 
+	WorkerPool::shutdown();
+
 	delete TheNetwork;
 	TheNetwork = NULL;
 
@@ -442,6 +447,23 @@ void GameEngine::init( int argc, char *argv[] )
 			//populateMapListbox(NULL, true, true);
 			m_quitting = TRUE;
 		}
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+		if (TheGlobalData->m_netReplayFile.isNotEmpty())
+		{
+			// time the network code on a capture, then quit
+			NetCaptureBenchmark benchmark;
+			benchmark.run(TheGlobalData->m_netReplayFile.str());
+			m_quitting = TRUE;
+		}
+		if (TheGlobalData->m_netHarnessPlayers > 0)
+		{
+			// play a game between peers in this process, then quit
+			NetLoopbackHarness harness;
+			harness.run(TheGlobalData->m_netHarnessPlayers, TheGlobalData->m_netHarnessFrames);
+			m_quitting = TRUE;
+		}
+#endif
 		
 		// load the initial shell screen
 		//TheShell->push( AsciiString("Menus/MainMenu.wnd") );
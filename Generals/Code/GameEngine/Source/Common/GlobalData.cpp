@@ -369,6 +369,15 @@ GlobalData* GlobalData::m_theOriginal = NULL;
 	{ "LatencyPeriod",							INI::parseInt,				NULL,			offsetof( GlobalData, m_latencyPeriod ) },
 	{ "LatencyNoise",								INI::parseInt,				NULL,			offsetof( GlobalData, m_latencyNoise ) },
 	{ "PacketLoss",									INI::parseInt,				NULL,			offsetof( GlobalData, m_packetLoss ) },
+	{ "PacketReorder",							INI::parseInt,				NULL,			offsetof( GlobalData, m_packetReorder ) },
+	{ "BandwidthCap",								INI::parseInt,				NULL,			offsetof( GlobalData, m_bandwidthCap ) },
+	{ "NoEarlyResends",							INI::parseBool,				NULL,			offsetof( GlobalData, m_noEarlyResends ) },
+	{ "NoSendClasses",							INI::parseBool,				NULL,			offsetof( GlobalData, m_noSendClasses ) },
+	{ "NetCaptureFile",							INI::parseAsciiString,NULL,			offsetof( GlobalData, m_netCaptureFile ) },
+	{ "NetReplayFile",							INI::parseAsciiString,NULL,			offsetof( GlobalData, m_netReplayFile ) },
+	{ "NetHarnessPlayers",					INI::parseInt,				NULL,			offsetof( GlobalData, m_netHarnessPlayers ) },
+	{ "NetHarnessFrames",						INI::parseInt,				NULL,			offsetof( GlobalData, m_netHarnessFrames ) },
+	{ "NetHarnessFileSize",					INI::parseInt,				NULL,			offsetof( GlobalData, m_netHarnessFileSize ) },
 */
 
 	{ "BuildSpeed",									INI::parseReal,				NULL,			offsetof( GlobalData, m_BuildSpeed ) },
@@ -482,6 +491,7 @@ GlobalData* GlobalData::m_theOriginal = NULL;
 	{ "NetworkRunAheadMetricsTime", INI::parseInt, NULL, offsetof(GlobalData, m_networkRunAheadMetricsTime) },
 	{ "NetworkCushionHistoryLength", INI::parseInt, NULL, offsetof(GlobalData, m_networkCushionHistoryLength) },
 	{ "NetworkRunAheadSlack", INI::parseInt, NULL, offsetof(GlobalData, m_networkRunAheadSlack) },
+	{ "NetworkRunAheadStallTarget", INI::parseInt, NULL, offsetof(GlobalData, m_networkRunAheadStallTarget) },
 	{ "NetworkKeepAliveDelay", INI::parseInt, NULL, offsetof(GlobalData, m_networkKeepAliveDelay) },
 	{ "NetworkDisconnectTime", INI::parseInt, NULL, offsetof(GlobalData, m_networkDisconnectTime) },
 	{ "NetworkPlayerTimeoutTime", INI::parseInt, NULL, offsetof(GlobalData, m_networkPlayerTimeoutTime) },
@@ -561,6 +571,7 @@ GlobalData::GlobalData()
 	m_debugProjectileTileWidth = 10;
 	m_debugProjectileTileDuration = LOGICFRAMES_PER_SECOND;  // Changed By Sadullah Nader
 	m_debugThreatMap = FALSE;
+	m_checkPartitionQueries = FALSE;
 	m_maxDebugThreat = 5000;
 	m_debugThreatMapTileDuration = LOGICFRAMES_PER_SECOND;  // Changed By Sadullah Nader
 	m_debugCashValueMap = FALSE;
@@ -580,6 +591,15 @@ GlobalData::GlobalData()
 	m_latencyPeriod = 0;
 	m_latencyNoise = 0;
 	m_packetLoss = 0;
+	m_packetReorder = 0;
+	m_bandwidthCap = 0;
+	m_noEarlyResends = FALSE;
+	m_noSendClasses = FALSE;
+	m_netCaptureFile.clear();
+	m_netReplayFile.clear();
+	m_netHarnessPlayers = 0;
+	m_netHarnessFrames = 0;
+	m_netHarnessFileSize = 0;
 	m_saveStats = FALSE;
 	m_saveAllStats = FALSE;
 	m_useLocalMOTD = FALSE;
@@ -588,6 +608,8 @@ GlobalData::GlobalData()
 #endif
 
 	m_playStats = -1;
+	m_updateModuleStats = FALSE;
+	m_workerThreads = 0;
 	m_incrementalAGPBuf = FALSE;
 	m_mapName.clear();
 	m_moveHintName.clear();
@@ -922,6 +944,7 @@ GlobalData::GlobalData()
 	m_networkRunAheadMetricsTime = 500;
 	m_networkCushionHistoryLength = 10;
 	m_networkRunAheadSlack = 10;
+	m_networkRunAheadStallTarget = 5;
 	m_networkKeepAliveDelay = 20;
 	m_networkDisconnectTime = 5000;
 	m_networkPlayerTimeoutTime = 60000;
@@ -457,6 +457,7 @@ AsciiString GameMessage::getCommandTypeAsAsciiString(GameMessage::Type t)
 	CHECK_IF(MSG_META_DEBUG_VTUNE_OFF)
 	CHECK_IF(MSG_META_DEBUG_TOGGLE_FEATHER_WATER)
 	CHECK_IF(MSG_META_DEBUG_DUMP_ASSETS)
+	CHECK_IF(MSG_META_DEBUG_DUMP_UPDATE_MODULE_STATS)
 	CHECK_IF(MSG_NO_DRAW)
 	CHECK_IF(MSG_META_DEMO_TOGGLE_METRICS)
 	CHECK_IF(MSG_META_DEMO_TOGGLE_PROJECTILEDEBUG)
@@ -49,6 +49,7 @@
 #include "Common/MiscAudio.h"
 #include "Common/Player.h"
 #include "Common/Xfer.h"
+#include "GameLogic/ScriptEngine.h"
 
 // ------------------------------------------------------------------------------------------------
 UnsignedInt Money::withdraw(UnsignedInt amountToWithdraw, Bool playSound)
@@ -68,6 +69,8 @@ UnsignedInt Money::withdraw(UnsignedInt amountToWithdraw, Bool playSound)
 		TheAudio->addAudioEvent(&event);
 
 	m_money -= amountToWithdraw;
+	if (TheScriptEngine)
+		TheScriptEngine->notifyOfScriptEvent(ScriptEngine::SCRIPT_EVENT_CREDITS);
 
 	return amountToWithdraw;
 }
@@ -87,6 +90,8 @@ void Money::deposit(UnsignedInt amountToDeposit, Bool playSound)
 		TheAudio->addAudioEvent(&event);
 	
 	m_money += amountToDeposit;
+	if (TheScriptEngine)
+		TheScriptEngine->notifyOfScriptEvent(ScriptEngine::SCRIPT_EVENT_CREDITS);
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -898,6 +898,8 @@ void TeamPrototype::setControllingPlayer(Player *newController)
 
 	// impossible to get here with a NULL pointer.
 	m_owningPlayer->addTeamToList(this);
+	if (TheScriptEngine)
+		TheScriptEngine->notifyOfScriptEvent(ScriptEngine::SCRIPT_EVENT_TEAM_MEMBERSHIP);
 }
 
 // ------------------------------------------------------------------------
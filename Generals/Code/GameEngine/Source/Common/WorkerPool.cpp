@@ -0,0 +1,198 @@
+/*
+**	Command & Conquer Generals(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+// FILE: WorkerPool.cpp ///////////////////////////////////////////////////////////////////////////
+// Worker threads for parallelFor.
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "PreRTS.h"	// This must go first in EVERY cpp file int the GameEngine
+
+#include <atomic>
+#include <condition_variable>
+#include <thread>
+
+#include "Common/WorkerPool.h"
+#include "Common/GlobalData.h"
+#include "GameLogic/FPUControl.h"
+
+//-------------------------------------------------------------------------------------------------
+/** The job currently being worked on.  Only one at a time; the caller fills it in, bumps
+		s_generation, and then pitches in until every chunk has been claimed. */
+//-------------------------------------------------------------------------------------------------
+struct WorkerPoolJob
+{
+	WorkerPool::RangeProc	m_proc;
+	void*									m_userData;
+	Int										m_count;
+	Int										m_grain;
+	std::atomic<Int>			m_nextItem;			///< first item not yet claimed
+	std::atomic<Int>			m_busyWorkers;	///< workers that haven't finished with this job yet
+};
+
+static WorkerPoolJob s_job;
+static std::thread *s_workers[WorkerPool::MAX_WORKERS];
+static Int s_numWorkers = -1;		///< -1 until the threads have been started
+static std::mutex s_mutex;
+static std::condition_variable s_wakeWorkers;
+static std::condition_variable s_workersDone;
+static UnsignedInt s_generation = 0;
+static Bool s_quit = FALSE;
+static thread_local Bool s_insideJob = FALSE;
+
+//-------------------------------------------------------------------------------------------------
+/** Claim and run chunks of the current job until there are none left. */
+//-------------------------------------------------------------------------------------------------
+static void runChunks(void)
+{
+	for (;;)
+	{
+		Int begin = s_job.m_nextItem.fetch_add(s_job.m_grain);
+		if (begin >= s_job.m_count)
+			return;
+
+		Int end = min(begin + s_job.m_grain, s_job.m_count);
+		(*s_job.m_proc)(begin, end, s_job.m_userData);
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+static void workerThreadProc(void)
+{
+	// the work may be logic work, so use the same float mode the logic thread does
+	setFPMode();
+
+	s_insideJob = TRUE;
+
+	UnsignedInt seenGeneration = 0;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(s_mutex);
+			while (!s_quit && s_generation == seenGeneration)
+				s_wakeWorkers.wait(lock);
+			if (s_quit)
+				return;
+			seenGeneration = s_generation;
+		}
+
+		runChunks();
+
+		if (s_job.m_busyWorkers.fetch_sub(1) == 1)
+		{
+			std::lock_guard<std::mutex> lock(s_mutex);
+			s_workersDone.notify_one();
+		}
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+static void startWorkers(void)
+{
+	Int threads = TheGlobalData ? TheGlobalData->m_workerThreads : 1;
+	if (threads <= 0)
+	{
+		// leave a core for the client and audio threads
+		threads = (Int)std::thread::hardware_concurrency() - 1;
+	}
+
+	s_numWorkers = min(max(threads - 1, 0), (Int)WorkerPool::MAX_WORKERS);
+	for (Int i = 0; i < s_numWorkers; ++i)
+		s_workers[i] = new std::thread(workerThreadProc);
+
+	DEBUG_LOG(("WorkerPool - started %d worker threads\n", s_numWorkers));
+}
+
+//-------------------------------------------------------------------------------------------------
+Int WorkerPool::getThreadCount(void)
+{
+	if (s_numWorkers < 0)
+		startWorkers();
+	return s_numWorkers + 1;
+}
+
+//-------------------------------------------------------------------------------------------------
+void WorkerPool::parallelFor(Int count, Int grain, RangeProc proc, void *userData)
+{
+	if (count <= 0)
+		return;
+	if (grain < 1)
+		grain = 1;
+
+	if (s_numWorkers < 0)
+		startWorkers();
+
+	if (s_numWorkers == 0 || s_insideJob || count <= grain)
+	{
+		(*proc)(0, count, userData);
+		return;
+	}
+
+	s_job.m_proc = proc;
+	s_job.m_userData = userData;
+	s_job.m_count = count;
+	s_job.m_grain = grain;
+	s_job.m_nextItem = 0;
+	s_job.m_busyWorkers = s_numWorkers;
+
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+		++s_generation;
+	}
+	s_wakeWorkers.notify_all();
+
+	s_insideJob = TRUE;
+	runChunks();
+	s_insideJob = FALSE;
+
+	// every chunk has been claimed, but the workers may still be running theirs
+	std::unique_lock<std::mutex> lock(s_mutex);
+	while (s_job.m_busyWorkers.load() != 0)
+		s_workersDone.wait(lock);
+}
+
+//-------------------------------------------------------------------------------------------------
+void WorkerPool::shutdown(void)
+{
+	if (s_numWorkers <= 0)
+	{
+		s_numWorkers = -1;
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(s_mutex);
+		s_quit = TRUE;
+	}
+	s_wakeWorkers.notify_all();
+
+	for (Int i = 0; i < s_numWorkers; ++i)
+	{
+		s_workers[i]->join();
+		delete s_workers[i];
+		s_workers[i] = NULL;
+	}
+
+	s_numWorkers = -1;
+	s_quit = FALSE;
+}
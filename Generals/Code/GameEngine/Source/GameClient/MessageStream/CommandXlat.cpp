@@ -3732,6 +3732,16 @@ GameMessageDisposition CommandTranslator::translateGameMessage(const GameMessage
 			disp = DESTROY_MESSAGE;
 			break;
 		}  
+
+		//-----------------------------------------------------------------------------------------
+		case GameMessage::MSG_META_DEBUG_DUMP_UPDATE_MODULE_STATS:
+		{
+			TheGameLogic->dumpUpdateModuleStats("UpdateModuleStats.txt");
+			TheGameLogic->resetUpdateModuleStats();
+			TheInGameUI->message( UnicodeString( L"Update module stats dumped to UpdateModuleStats.txt" ) );
+			disp = DESTROY_MESSAGE;
+			break;
+		}  
 		
 		//------------------------------------------------------------------------------- DEMO MESSAGES
 		//-----------------------------------------------------------------------------------------
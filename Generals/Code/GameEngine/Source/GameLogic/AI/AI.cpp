@@ -524,6 +524,16 @@ public:
 		return true;
 	}
 
+	virtual Bool addToMask(PartitionFilterMask &mask) const
+	{
+		if (!mask.addMapStatus(m_obj->isOffMap() ? PartitionFilterMask::MAP_STATUS_OFF_MAP : PartitionFilterMask::MAP_STATUS_ON_MAP))
+			return false;
+		if (!mask.addRelationship(m_obj, 1 << ENEMIES))
+			return false;
+		mask.m_rejectDead = true;
+		return true;
+	}
+
 #if defined(_DEBUG) || defined(_INTERNAL)
 	virtual const char* debugGetName() { return "PartitionFilterLiveMapEnemies"; }
 #endif
@@ -669,6 +679,9 @@ Object *AI::findClosestEnemy( const Object *me, Real range, UnsignedInt qualifie
 
 	filters[numFilters] = NULL;
 
+	// lots of units acquire targets from the same few cells, so let them share the cell walks
+	PartitionScanBatch scanBatch;
+
 	if (info == NULL || info == TheScriptEngine->getDefaultAttackInfo()) 
 	{
 		// No additional attack info, so just return the closest one.
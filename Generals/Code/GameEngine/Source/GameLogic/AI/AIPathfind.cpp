@@ -32,6 +32,7 @@
 #include "Common/PerfTimer.h"
 #include "Common/Player.h"
 #include "Common/CRCDebug.h"
+#include "Common/FrameProfiler.h"
 #include "Common/GlobalData.h"
 #include "Common/LatchRestore.h"	 
 #include "Common/ThingTemplate.h"
@@ -5382,6 +5383,7 @@ Path *Pathfinder::getAircraftPath( const Object *obj, const Coord3D *to )
 void Pathfinder::processPathfindQueue(void)
 {
 	//USE_PERF_TIMER(processPathfindQueue)
+	PROFILE_ZONE("Pathfinder::processPathfindQueue");
 	if (!m_isMapReady) {
 		return;
 	}
@@ -36,6 +36,7 @@
 #include "Common/Team.h" 
 #include "Common/ThingFactory.h"
 #include "Common/BuildAssistant.h"
+#include "Common/FrameProfiler.h"
 #include "Common/SpecialPower.h"
 #include "Common/ThingTemplate.h"
 #include "Common/WellKnownKeys.h"
@@ -947,6 +948,7 @@ void AISkirmishPlayer::doTeamBuilding( void )
  */
 void AISkirmishPlayer::update( void )
 {
+	PROFILE_ZONE("AISkirmishPlayer::update");
 	AIPlayer::update();
 }
 
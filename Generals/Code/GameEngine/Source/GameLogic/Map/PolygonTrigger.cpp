@@ -38,6 +38,12 @@
 /* ********* PolygonTrigger class ****************************/
 PolygonTrigger *PolygonTrigger::ThePolygonTriggerListPtr = NULL;
 Int PolygonTrigger::s_currentID = 1;
+std::vector<PolygonTriggerPtrVector> PolygonTrigger::s_indexCells;
+IRegion2D PolygonTrigger::s_indexBounds;
+Int PolygonTrigger::s_indexCellSize = PolygonTrigger::SPATIAL_INDEX_CELL_SIZE;
+Int PolygonTrigger::s_indexCellsX = 0;
+Int PolygonTrigger::s_indexCellsY = 0;
+Bool PolygonTrigger::s_indexValid = false;
 /**
  PolygonTrigger - Constructor.
 */
@@ -285,6 +291,7 @@ void PolygonTrigger::addPolygonTrigger(PolygonTrigger *pTrigger)
 	}
 	pTrigger->m_nextPolygonTrigger = ThePolygonTriggerListPtr;
 	ThePolygonTriggerListPtr = pTrigger;
+	invalidateSpatialIndex();
 }
 
 /**
@@ -310,6 +317,7 @@ void PolygonTrigger::removePolygonTrigger(PolygonTrigger *pTrigger)
 		}
 	}
 	pTrigger->m_nextPolygonTrigger = NULL;
+	invalidateSpatialIndex();
 }
 
 /**
@@ -320,9 +328,125 @@ void PolygonTrigger::deleteTriggers(void)
 	PolygonTrigger *pList = ThePolygonTriggerListPtr;	
 	ThePolygonTriggerListPtr = NULL;
 	s_currentID = 1;
+	invalidateSpatialIndex();
 	pList->deleteInstance();
 }
 
+/**
+ PolygonTrigger::buildSpatialIndex buckets the triggers into a grid of cells by bounds.
+*/
+void PolygonTrigger::buildSpatialIndex(void)
+{
+	s_indexCells.clear();
+	s_indexCellsX = s_indexCellsY = 0;
+	s_indexCellSize = SPATIAL_INDEX_CELL_SIZE;
+	s_indexValid = true;
+
+	const PolygonTrigger *pTrig;
+	Bool any = false;
+	for (pTrig=getFirstPolygonTrigger(); pTrig; pTrig = pTrig->getNext()) {
+		if (pTrig->m_numPoints == 0) continue;
+		if (pTrig->m_boundsNeedsUpdate) {
+			pTrig->updateBounds();
+		}
+		if (!any) {
+			s_indexBounds = pTrig->m_bounds;
+			any = true;
+			continue;
+		}
+		if (pTrig->m_bounds.lo.x < s_indexBounds.lo.x) s_indexBounds.lo.x = pTrig->m_bounds.lo.x;
+		if (pTrig->m_bounds.lo.y < s_indexBounds.lo.y) s_indexBounds.lo.y = pTrig->m_bounds.lo.y;
+		if (pTrig->m_bounds.hi.x > s_indexBounds.hi.x) s_indexBounds.hi.x = pTrig->m_bounds.hi.x;
+		if (pTrig->m_bounds.hi.y > s_indexBounds.hi.y) s_indexBounds.hi.y = pTrig->m_bounds.hi.y;
+	}
+	if (!any) {
+		return;
+	}
+
+	// Huge or very spread out trigger sets just get bigger cells.
+	while (true) {
+		s_indexCellsX = (s_indexBounds.hi.x - s_indexBounds.lo.x) / s_indexCellSize + 1;
+		s_indexCellsY = (s_indexBounds.hi.y - s_indexBounds.lo.y) / s_indexCellSize + 1;
+		if (s_indexCellsX*s_indexCellsY <= SPATIAL_INDEX_MAX_CELLS) break;
+		s_indexCellSize *= 2;
+	}
+	s_indexCells.resize(s_indexCellsX*s_indexCellsY);
+
+	for (pTrig=getFirstPolygonTrigger(); pTrig; pTrig = pTrig->getNext()) {
+		if (pTrig->m_numPoints == 0) continue;
+		Int loX = (pTrig->m_bounds.lo.x - s_indexBounds.lo.x) / s_indexCellSize;
+		Int loY = (pTrig->m_bounds.lo.y - s_indexBounds.lo.y) / s_indexCellSize;
+		Int hiX = (pTrig->m_bounds.hi.x - s_indexBounds.lo.x) / s_indexCellSize;
+		Int hiY = (pTrig->m_bounds.hi.y - s_indexBounds.lo.y) / s_indexCellSize;
+		Int x, y;
+		for (y=loY; y<=hiY; y++) {
+			for (x=loX; x<=hiX; x++) {
+				s_indexCells[y*s_indexCellsX + x].push_back(const_cast<PolygonTrigger *>(pTrig));
+			}
+		}
+	}
+}
+
+/**
+ PolygonTrigger::getPolygonTriggersNear returns the triggers whose bounds overlap the
+ index cell containing point.  Any trigger that contains point is in the list.
+*/
+const PolygonTriggerPtrVector *PolygonTrigger::getPolygonTriggersNear(const ICoord3D &point)
+{
+	if (!s_indexValid) {
+		buildSpatialIndex();
+	}
+	if (s_indexCells.empty()) {
+		return NULL;
+	}
+	if (point.x < s_indexBounds.lo.x || point.y < s_indexBounds.lo.y) return NULL;
+	if (point.x > s_indexBounds.hi.x || point.y > s_indexBounds.hi.y) return NULL;
+	Int x = (point.x - s_indexBounds.lo.x) / s_indexCellSize;
+	Int y = (point.y - s_indexBounds.lo.y) / s_indexCellSize;
+	const PolygonTriggerPtrVector *cell = &s_indexCells[y*s_indexCellsX + x];
+	if (cell->empty()) {
+		return NULL;
+	}
+	return cell;
+}
+
+/**
+ PolygonTrigger::isPolygonTriggerInList returns true if pTrigger is still a live trigger. 
+ Doesn't dereference pTrigger, so it is safe to call with a stale pointer.
+*/
+Bool PolygonTrigger::isPolygonTriggerInList(const PolygonTrigger *pTrigger)
+{
+	for (const PolygonTrigger *pTrig=getFirstPolygonTrigger(); pTrig; pTrig = pTrig->getNext()) {
+		if (pTrig == pTrigger) return true;
+	}
+	return false;
+}
+
+/**
+ PolygonTrigger::addOccupant notes that an object is inside this trigger.
+*/
+void PolygonTrigger::addOccupant(ObjectID id) const
+{
+	for (ObjectIDVector::const_iterator it = m_occupants.begin(); it != m_occupants.end(); ++it) {
+		if (*it == id) return;
+	}
+	m_occupants.push_back(id);
+}
+
+/**
+ PolygonTrigger::removeOccupant notes that an object is no longer inside this trigger.
+*/
+void PolygonTrigger::removeOccupant(ObjectID id) const
+{
+	for (ObjectIDVector::iterator it = m_occupants.begin(); it != m_occupants.end(); ++it) {
+		if (*it == id) {
+			*it = m_occupants.back();
+			m_occupants.pop_back();
+			return;
+		}
+	}
+}
+
 /**
  PolygonTrigger::addPoint adds a point at the end of the polygon.
  NOTE: It is expected that this will only get called in the editor, as in the game
@@ -337,6 +461,7 @@ void PolygonTrigger::addPoint(const ICoord3D &point)
 	m_points[m_numPoints] = point;
 	m_numPoints++;
 	m_boundsNeedsUpdate = true;
+	invalidateSpatialIndex();
 }
 
 /**
@@ -357,6 +482,7 @@ void PolygonTrigger::setPoint(const ICoord3D &point, Int ndx)
 	}
 	m_points[ndx] = point;
 	m_boundsNeedsUpdate = true;
+	invalidateSpatialIndex();
 }
 
 /**
@@ -382,6 +508,7 @@ void PolygonTrigger::insertPoint(const ICoord3D &point, Int ndx)
 	m_points[ndx] = point;
 	m_numPoints++;
 	m_boundsNeedsUpdate = true;
+	invalidateSpatialIndex();
 }
 
 /**
@@ -399,6 +526,7 @@ void PolygonTrigger::deletePoint(Int ndx)
 	}
 	m_numPoints--;
 	m_boundsNeedsUpdate = true;
+	invalidateSpatialIndex();
 }
 
 void PolygonTrigger::getCenterPoint(Coord3D* pOutCoord)	const
@@ -533,6 +661,9 @@ void PolygonTrigger::xfer( Xfer *xfer )
 	// bounds need update
 	xfer->xferBool( &m_boundsNeedsUpdate );
 
+	if( xfer->getXferMode() == XFER_LOAD )
+		invalidateSpatialIndex();
+
 }  // end xfer
 
 // ------------------------------------------------------------------------------------------------
@@ -2845,6 +2845,7 @@ void TerrainLogic::flattenTerrain(Object *obj)
 		break;
 	} // switch
 
+	ThePartitionManager->friend_noteTerrainChanged();
 }
 
 // ------------------------------------------------------------------------------------------------
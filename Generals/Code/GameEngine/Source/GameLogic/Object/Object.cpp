@@ -222,6 +222,7 @@ Object::Object( const ThingTemplate *tt, ObjectStatusBits statusBits, Team *team
 	//Initializations inserted
 	m_formationOffset.x = m_formationOffset.y = 0.0f;
 	m_iPos.zero();
+	m_numTriggerAreasActive = 0;
 	//
 	for( i = 0; i < DISABLED_COUNT; i++ )
 	{
@@ -520,6 +521,14 @@ Object::~Object()
 	/// @todo Generalize the notion of objects entering and leaving the world, so we don't have to special case this
 	TheAI->pathfinder()->removeObjectFromPathfindMap( this );
 
+	// leave any trigger areas we are in.  The map may already have been unloaded, so make sure
+	// the areas still exist first.
+	for (Int i=0; i<m_numTriggerAreasActive; i++) 
+	{
+		if (m_triggerInfo[i].isInside && PolygonTrigger::isPolygonTriggerInList(m_triggerInfo[i].pTrigger))
+			m_triggerInfo[i].pTrigger->removeOccupant(getID());
+	}
+
 	if (!isKindOf(KINDOF_PROJECTILE) && !isKindOf(KINDOF_INERT)) {
 		// Notify script conditions to update conditions that consider unit counts.
 		// We ignore projectiles cause they are frequently created & destroyed, and are not
@@ -798,6 +807,8 @@ void Object::setOrRestoreTeam( Team* team, Bool restoring )
 		
 	// Switch //////////////////////////
 	m_team = team;
+	if (TheScriptEngine)
+		TheScriptEngine->notifyOfScriptEvent(ScriptEngine::SCRIPT_EVENT_TEAM_MEMBERSHIP);
 
 	// After Switch //////////////////////////
 	if (m_team)
@@ -1784,6 +1795,11 @@ void Object::setEffectivelyDead(Bool dead)
 	else
 		BitClear(m_privateStatus, EFFECTIVELY_DEAD);
 
+	if (!isKindOf(KINDOF_PROJECTILE) && !isKindOf(KINDOF_INERT)) {
+		// Dead objects drop out of script unit counts.
+		TheScriptEngine->notifyOfScriptEvent(ScriptEngine::SCRIPT_EVENT_OBJECT_COUNT);
+	}
+
 	if (dead)
 	{
 		if( m_radarData )
@@ -2096,8 +2112,8 @@ void Object::updateTriggerAreaFlags()
 	// Update the flags, and remove any trigger areas that this object isn't inside.
 	for (Int i=0; i<m_numTriggerAreasActive; i++) 
 	{
-		if (!m_triggerInfo[j].isInside) 
-			continue;
+		if (!m_triggerInfo[i].isInside) 
+			continue;	// removed from the trigger's occupants when we exited it.
 		m_triggerInfo[j].entered = false;
 		m_triggerInfo[j].exited = false;
 		m_triggerInfo[j].isInside = m_triggerInfo[i].isInside;
@@ -2326,10 +2342,12 @@ void Object::setTriggerAreaFlagsForChangeInPosition()
 		{
 			m_triggerInfo[i].isInside = false;
 			m_triggerInfo[i].exited = true;
+			m_triggerInfo[i].pTrigger->removeOccupant(getID());
 			m_enteredOrExitedFrame = now;
 			if (m_team) 
 				m_team->setEnteredExited();
 			TheGameLogic->updateObjectsChangedTriggerAreas();
+			TheScriptEngine->notifyOfScriptEvent(ScriptEngine::SCRIPT_EVENT_AREA_OCCUPANCY);
 #ifdef _DEBUG
 			//TheScriptEngine->AppendDebugMessage("Object exited.", false);
 #endif
@@ -2338,8 +2356,14 @@ void Object::setTriggerAreaFlagsForChangeInPosition()
 
 	m_iPos = iPos;
 
-	for (const PolygonTrigger *pTrig = PolygonTrigger::getFirstPolygonTrigger(); pTrig; pTrig = pTrig->getNext()) 
+	// Only the triggers whose bounds are near us can contain us.
+	const PolygonTriggerPtrVector *nearTriggers = PolygonTrigger::getPolygonTriggersNear(m_iPos);
+	if (nearTriggers == NULL)
+		return;
+
+	for (PolygonTriggerPtrVector::const_iterator it = nearTriggers->begin(); it != nearTriggers->end(); ++it) 
 	{
+		const PolygonTrigger *pTrig = *it;
 		Bool skip = false;
 		for (i = 0; i < m_numTriggerAreasActive; i++) 
 		{
@@ -2360,10 +2384,12 @@ void Object::setTriggerAreaFlagsForChangeInPosition()
 				m_triggerInfo[m_numTriggerAreasActive].entered = true;
 				m_triggerInfo[m_numTriggerAreasActive].exited = false;
 				m_triggerInfo[m_numTriggerAreasActive].pTrigger = pTrig;  
+				pTrig->addOccupant(getID());
 				m_enteredOrExitedFrame = now;
 				if (m_team) 
 					m_team->setEnteredExited();
 				TheGameLogic->updateObjectsChangedTriggerAreas();
+				TheScriptEngine->notifyOfScriptEvent(ScriptEngine::SCRIPT_EVENT_AREA_OCCUPANCY);
 				++m_numTriggerAreasActive;
 #ifdef _DEBUG
 				//TheScriptEngine->AppendDebugMessage("Object entered.", false);
@@ -2465,9 +2491,23 @@ void Object::setID( ObjectID id )
 	// remove this objects previous id from the lookup table
 	TheGameLogic->removeObjectFromLookupTable( this );
 
+	// trigger areas track their occupants by id
+	Int i;
+	for( i = 0; i < m_numTriggerAreasActive; ++i )
+	{
+		if( m_triggerInfo[ i ].isInside )
+			m_triggerInfo[ i ].pTrigger->removeOccupant( m_id );
+	}
+
 	// assign new id
 	m_id = id;
 
+	for( i = 0; i < m_numTriggerAreasActive; ++i )
+	{
+		if( m_triggerInfo[ i ].isInside )
+			m_triggerInfo[ i ].pTrigger->addOccupant( m_id );
+	}
+
 	// add new id to lookup table
 	TheGameLogic->addObjectToLookupTable( this );
 
@@ -3674,6 +3714,14 @@ void Object::xfer( Xfer *xfer )
 
 	// Entered & exited housekeeping.
 	Int i;
+	if (xfer->getXferMode() == XFER_LOAD)
+	{
+		// we are about to overwrite our trigger info, so leave the areas it says we are in.
+		for (i=0; i<m_numTriggerAreasActive; i++) {
+			if (m_triggerInfo[i].isInside && m_triggerInfo[i].pTrigger)
+				m_triggerInfo[i].pTrigger->removeOccupant(getID());
+		}
+	}
 	xfer->xferByte(&m_numTriggerAreasActive);
 	xfer->xferUnsignedInt(&m_enteredOrExitedFrame);
 	xfer->xferICoord3D(&m_iPos);
@@ -3700,6 +3748,8 @@ void Object::xfer( Xfer *xfer )
 		xfer->xferByte(&m_triggerInfo[i].entered);
 		xfer->xferByte(&m_triggerInfo[i].exited);
 		xfer->xferByte(&m_triggerInfo[i].isInside);
+		if (xfer->getXferMode() == XFER_LOAD && m_triggerInfo[i].isInside && m_triggerInfo[i].pTrigger)
+			m_triggerInfo[i].pTrigger->addOccupant(getID());
 	}
 	// Layer object is pathing on.
 	xfer->xferUser(&m_layer, sizeof(m_layer));
@@ -51,6 +51,7 @@
 
 #include "Common/ActionManager.h"
 #include "Common/DiscreteCircle.h"
+#include "Common/FrameProfiler.h"
 #include "Common/GameEngine.h"
 #include "Common/GameState.h"
 #include "Common/MessageStream.h"
@@ -61,6 +62,7 @@
 #include "Common/Radar.h"
 #include "Common/ThingFactory.h"	// for bullet type hack
 #include "Common/ThingTemplate.h"
+#include "Common/WorkerPool.h"
 #include "Common/Xfer.h"
 
 #include "GameLogic/AIPathfind.h"
@@ -141,9 +143,8 @@ struct CellValueProcParms
 {
 	Int valueRequired;
 	Bool greaterThan;
-	ValueOrThreat valueType;
-	PlayerMaskType allPlayersMask[MAX_PLAYER_COUNT];
-	PlayerMaskType allowedPlayersMasks;
+	const UnsignedInt *cellValues;	///< from a ValueMapCache
+	Int cellCountX;
 };
 
 static int cellValueProc(PartitionCell* cell, void* userData);
@@ -268,6 +269,103 @@ inline Bool filtersAllow(PartitionFilter **filters, Object *objOther)
 #endif
 }
 
+//-----------------------------------------------------------------------------
+/**
+	Fold whatever filters can be folded into the context's PartitionFilterMask, and
+	gather the rest into its NULL-terminated list of filters that still need calling.
+*/
+void PartitionQueryContext::compileFilters(PartitionFilter **filters)
+{
+	m_filterMask.clear();
+	m_remainingFilters.clear();
+	for (PartitionFilter **fp = filters; fp && *fp; fp++)
+	{
+#ifndef FILTER_PROFILING
+		if ((*fp)->addToMask(m_filterMask))
+			continue;
+#endif
+		m_remainingFilters.push_back(*fp);
+	}
+	m_remainingFilters.push_back(NULL);
+}
+
+//-----------------------------------------------------------------------------
+/** The inline equivalent of calling every filter that was folded into mask. */
+//-----------------------------------------------------------------------------
+inline Bool PartitionQueryContext::maskAllows(const Object *objOther)
+{
+	const PartitionFilterMask &mask = m_filterMask;
+
+	if (mask.m_rejectDead && objOther->isEffectivelyDead())
+		return false;
+
+	if (mask.m_mapStatus != PartitionFilterMask::MAP_STATUS_ANY && 
+			objOther->isOffMap() != (mask.m_mapStatus == PartitionFilterMask::MAP_STATUS_OFF_MAP))
+		return false;
+
+	UnsignedInt status = objOther->getStatusBits();
+	if ((status & mask.m_statusMustBeSet) != mask.m_statusMustBeSet || (status & mask.m_statusMustBeClear) != 0)
+		return false;
+
+	if (mask.m_testKindOf && !objOther->isKindOfMulti(mask.m_kindOfMustBeSet, mask.m_kindOfMustBeClear))
+		return false;
+
+	if (mask.m_relationshipObj && (mask.m_relationshipFlags & (1 << getRelationship(mask.m_relationshipObj, objOther))) == 0)
+		return false;
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+Bool PartitionFilterMask::addMapStatus(MapStatus status)
+{
+	if (m_mapStatus != MAP_STATUS_ANY && m_mapStatus != status)
+		return false;
+	m_mapStatus = status;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+Bool PartitionFilterMask::addRelationship(const Object *obj, Int flags)
+{
+	if (obj == NULL)
+		return false;
+	if (m_relationshipObj != NULL)
+	{
+		if (m_relationshipObj != obj)
+			return false;
+		m_relationshipFlags &= flags;
+		return true;
+	}
+	m_relationshipObj = obj;
+	m_relationshipFlags = flags;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+Relationship PartitionQueryContext::getRelationship(const Object *obj, const Object *other)
+{
+	// defectors get special treatment in Object::getRelationship, so don't remember those
+	const Team *team = other->getTeam();
+	if (team == NULL || other->getIsUndetectedDefector())
+		return obj->getRelationship(other);
+
+	if (obj != m_relationshipObj)
+	{
+		for (Int i = 0; i < RELATIONSHIP_CACHE_SIZE; ++i)
+			m_relationshipTeams[i] = NULL;
+		m_relationshipObj = obj;
+	}
+
+	Int slot = (Int)(((size_t)team >> 4) % RELATIONSHIP_CACHE_SIZE);
+	if (m_relationshipTeams[slot] != team)
+	{
+		m_relationshipTeams[slot] = team;
+		m_relationships[slot] = obj->getRelationship(other);
+	}
+	return m_relationships[slot];
+}
+
 //-----------------------------------------------------------------------------
 inline void vecDiff_2D(const Coord3D *posA, const Coord3D *posB, Coord3D *resultVec)
 {
@@ -1331,6 +1429,47 @@ void PartitionCell::removeLooker(Int playerIndex)
 	}
 }
 
+//-----------------------------------------------------------------------------
+/**
+	Same as calling addLooker for each player in the mask. A cell that is already being
+	looked at can't change status, so those players just get their count bumped here
+	without the edge checks.
+*/
+void PartitionCell::addLookers( UnsignedInt playerIndexMask )
+{
+	for( Int playerIndex = 0; playerIndexMask != 0; ++playerIndex, playerIndexMask >>= 1 )
+	{
+		if( (playerIndexMask & 1) == 0 )
+			continue;
+
+		Short &currentShroud = m_shroudLevel[playerIndex].m_currentShroud;
+		if( currentShroud < 0 )
+			--currentShroud;
+		else
+			addLooker( playerIndex );
+	}
+}
+
+//-----------------------------------------------------------------------------
+/**
+	Same as calling removeLooker for each player in the mask. Only the last looker
+	leaving can change the status, so everything else is just a count decrement.
+*/
+void PartitionCell::removeLookers( UnsignedInt playerIndexMask )
+{
+	for( Int playerIndex = 0; playerIndexMask != 0; ++playerIndex, playerIndexMask >>= 1 )
+	{
+		if( (playerIndexMask & 1) == 0 )
+			continue;
+
+		Short &currentShroud = m_shroudLevel[playerIndex].m_currentShroud;
+		if( currentShroud < -1 )
+			++currentShroud;
+		else
+			removeLooker( playerIndex );
+	}
+}
+
 //-----------------------------------------------------------------------------
 void PartitionCell::addShrouder( Int playerIndex )
 {
@@ -1460,6 +1599,7 @@ void PartitionCell::friend_addToCellList(CellAndObjectIntersection *coi)
 	{
 		coi->friend_addToCellList(&m_firstCoiInCell);
 		++m_coiCount;
+		ThePartitionManager->friend_noteCellMembershipChanged();
 	}
 }
 
@@ -1470,6 +1610,7 @@ void PartitionCell::friend_removeFromCellList(CellAndObjectIntersection *coi)
 	{
 		coi->friend_removeFromCellList(&m_firstCoiInCell);
 		--m_coiCount;
+		ThePartitionManager->friend_noteCellMembershipChanged();
 	}
 }
 
@@ -1548,7 +1689,8 @@ PartitionData::PartitionData()
 	m_coiArrayCount = 0;
 	m_coiArray = NULL;
 	m_coiInUseCount = 0;
-	m_doneFlag = 0;
+	DEBUG_ASSERTCRASH(ThePartitionManager, ("ThePartitionManager is null"));
+	m_queryIndex = ThePartitionManager ? ThePartitionManager->friend_allocateQueryIndex() : 0;
 	m_dirtyStatus = NOT_DIRTY;
 	m_lastCell = NULL;
 	for (int i = 0; i < MAX_PLAYER_COUNT; ++i)
@@ -1572,6 +1714,8 @@ PartitionData::~PartitionData()
 		ThePartitionManager->removeFromDirtyModules(this);
 		//DEBUG_ASSERTCRASH(!ThePartitionManager->isInListDirtyModules(this), ("hmm\n"));
 	}
+	if (ThePartitionManager)
+		ThePartitionManager->friend_releaseQueryIndex(m_queryIndex);
 } 
 
 //-----------------------------------------------------------------------------
@@ -1734,37 +1878,23 @@ void PartitionData::removeAllTouchedCells()
 }
 
 // -----------------------------------------------------------------------------
-void PartitionData::addSubPixToCoverage(PartitionCell *cell)
+void PartitionData::addSubPixToCoverage(std::vector<PartitionCell*> &cells, PartitionCell *cell)
 {
-	DEBUG_ASSERTCRASH(m_coiInUseCount < m_coiArrayCount, ("not enough cois allocated for this object"));
 	if (cell)
 	{			
-		// see if we already have a coi for this cell.
-		CellAndObjectIntersection *coi = m_coiArray;
-		CellAndObjectIntersection *coiToUse = NULL;
-		for (Int i = m_coiInUseCount; i; --i, ++coi)
-		{
-			if (coi->getCell() == cell)
-			{
-				coiToUse = coi;
-				break;
-			}
-		}
-		DEBUG_ASSERTCRASH(coiToUse != NULL || m_coiInUseCount < m_coiArrayCount, ("not enough cois allocated for this object"));
-		if (coiToUse == NULL && m_coiInUseCount < m_coiArrayCount)
+		// see if we already have this cell.
+		for (std::vector<PartitionCell*>::const_iterator it = cells.begin(); it != cells.end(); ++it)
 		{
-			// nope, no coi for this cell, allocate a new one
-			coiToUse = &m_coiArray[m_coiInUseCount++];
-		}
-		if (coiToUse)
-		{
-			coiToUse->addCoverage(cell, this);
+			if (*it == cell)
+				return;
 		}
+		cells.push_back(cell);
 	}
 }
 
 // -----------------------------------------------------------------------------
 void PartitionData::doRectFill(
+	std::vector<PartitionCell*> &cells,
 	Real centerX,
 	Real centerY,
 	Real halfsizeX,
@@ -1814,7 +1944,7 @@ void PartitionData::doRectFill(
 			PartitionCell *cell = ThePartitionManager->getCellAt(cellx, celly);	// might be null if off the edge
 			if (cell)
 			{
-				addSubPixToCoverage(cell);
+				addSubPixToCoverage(cells, cell);
 			}
 		}
 	}
@@ -1822,27 +1952,26 @@ void PartitionData::doRectFill(
 }
 
 // -----------------------------------------------------------------------------
-void PartitionData::hLineCircle(Int x1, Int x2, Int y)
+void PartitionData::hLineCircle(std::vector<PartitionCell*> &cells, Int x1, Int x2, Int y)
 {
 	for (Int x = x1; x <= x2; ++x)
 	{
 		PartitionCell* cell = ThePartitionManager->getCellAt(x, y);
 		if (cell)
 		{
-      addSubPixToCoverage(cell);
+      addSubPixToCoverage(cells, cell);
 		}
 	}
 }
 
 // -----------------------------------------------------------------------------
 void PartitionData::doCircleFill(
+	std::vector<PartitionCell*> &cells,
 	Real centerX,
 	Real centerY,
 	Real radius
 )
 {
-	DEBUG_ASSERTCRASH(m_coiInUseCount == 0, ("expected no coi in use here"));
-
 	Int cellCenterX, cellCenterY;
 	ThePartitionManager->worldToCell(centerX, centerY, &cellCenterX, &cellCenterY);
 
@@ -1854,10 +1983,10 @@ void PartitionData::doCircleFill(
 	Int dec = 3 - 2*cellRadius;
 	for (Int x = 0; x < cellRadius; x++)
 	{
-		hLineCircle(cellCenterX - x, cellCenterX + x, cellCenterY + y);
-		hLineCircle(cellCenterX - x, cellCenterX + x, cellCenterY - y);
-		hLineCircle(cellCenterX - y, cellCenterX + y, cellCenterY + x);
-		hLineCircle(cellCenterX - y, cellCenterX + y, cellCenterY - x);
+		hLineCircle(cells, cellCenterX - x, cellCenterX + x, cellCenterY + y);
+		hLineCircle(cells, cellCenterX - x, cellCenterX + x, cellCenterY - y);
+		hLineCircle(cells, cellCenterX - y, cellCenterX + y, cellCenterY + x);
+		hLineCircle(cells, cellCenterX - y, cellCenterX + y, cellCenterY - x);
 
 		if (dec >= 0)
 		{
@@ -1870,17 +1999,16 @@ void PartitionData::doCircleFill(
 
 // -----------------------------------------------------------------------------
 void PartitionData::doSmallFill(
+	std::vector<PartitionCell*> &cells,
 	Real centerX,
 	Real centerY,
 	Real radius
 )
 {
-	DEBUG_ASSERTCRASH(m_coiInUseCount == 0, ("expected no coi in use here"));
-
+	// (updateCellsTouched complains about this, since we may be on a worker thread here)
 	Real halfCellSize = ThePartitionManager->getCellSize() * 0.5f;
 	if (radius > halfCellSize)
 	{
-		DEBUG_CRASH(("object is too large to use a 'small' geometry, truncating size to cellsize\n"));
 		radius = halfCellSize;
 	}
 
@@ -1888,9 +2016,6 @@ void PartitionData::doSmallFill(
 	ThePartitionManager->worldToCell(centerX - radius, centerY - radius, &cx1, &cy1);
 	ThePartitionManager->worldToCell(centerX + radius, centerY + radius, &cx2, &cy2);
 
-	DEBUG_ASSERTCRASH(absInt(cx2-cx1)<=1,("bad cx"));
-	DEBUG_ASSERTCRASH(absInt(cy2-cy1)<=1,("bad cy"));
-
 	for (Int x = cx1; x <= cx2; x++)
 	{
 		for (Int y = cy1; y <= cy2; y++)
@@ -1898,20 +2023,10 @@ void PartitionData::doSmallFill(
 			PartitionCell *cell = ThePartitionManager->getCellAt(x, y);
 			if (cell)
 			{
-				m_coiArray[m_coiInUseCount++].addCoverage(cell, this);
+				cells.push_back(cell);
 			}
 		}
 	}
-
-	#ifdef INTENSE_DEBUG
-	for (int i = 0; i < m_coiInUseCount; i++)
-	{
-		for (int j = 0; j < i; j++)
-		{
-			DEBUG_ASSERTCRASH(m_coiArray[i].getCell() != m_coiArray[j].getCell(), ("dup cells"));
-		}
-	}
-	#endif
 }
 
 //-----------------------------------------------------------------------------
@@ -2022,61 +2137,90 @@ Bool PartitionManager::geomCollidesWithGeom(const Coord3D* pos1,
 }
 
 //-----------------------------------------------------------------------------
-void PartitionData::updateCellsTouched()
+void PartitionData::getShape(PartitionCellsTouched &cellsTouched) const
 {
-	GeometryType geom;
-	Bool isSmall;
-	Coord3D pos;
-	Real angle,majorRadius,minorRadius;
-
-
-	Object *obj = getObject();
+	const Object *obj = getObject();
 	DEBUG_ASSERTCRASH(obj != NULL || m_ghostObject != NULL, ("must be attached to an Object here 1"));
 
 	if (obj)
 	{	
-		//we have no object using this PartitionData but we still have a GhostObject so copy its data.
-		geom = obj->getGeometryInfo().getGeomType();
-		isSmall = obj->getGeometryInfo().getIsSmall();
-		pos = *(obj->getPosition());
-		angle = obj->getOrientation();
-		majorRadius = obj->getGeometryInfo().getMajorRadius();
-		minorRadius = obj->getGeometryInfo().getMinorRadius();
+		cellsTouched.m_geom = obj->getGeometryInfo().getGeomType();
+		cellsTouched.m_isSmall = obj->getGeometryInfo().getIsSmall();
+		cellsTouched.m_pos = *(obj->getPosition());
+		cellsTouched.m_angle = obj->getOrientation();
+		cellsTouched.m_majorRadius = obj->getGeometryInfo().getMajorRadius();
+		cellsTouched.m_minorRadius = obj->getGeometryInfo().getMinorRadius();
 	}
 	else if (m_ghostObject)
 	{
-		geom = m_ghostObject->getGeometryType();
-		isSmall = m_ghostObject->getGeometrySmall();
-		pos = *m_ghostObject->getParentPosition();
-		angle = m_ghostObject->getParentAngle();
-		majorRadius = m_ghostObject->getGeometryMajorRadius();
-		minorRadius = m_ghostObject->getGeometryMinorRadius();
+		//we have no object using this PartitionData but we still have a GhostObject so copy its data.
+		cellsTouched.m_geom = m_ghostObject->getGeometryType();
+		cellsTouched.m_isSmall = m_ghostObject->getGeometrySmall();
+		cellsTouched.m_pos = *m_ghostObject->getParentPosition();
+		cellsTouched.m_angle = m_ghostObject->getParentAngle();
+		cellsTouched.m_majorRadius = m_ghostObject->getGeometryMajorRadius();
+		cellsTouched.m_minorRadius = m_ghostObject->getGeometryMinorRadius();
 	}
+}
 
-	removeAllTouchedCells();
-	if (isSmall)
+//-----------------------------------------------------------------------------
+void PartitionData::gatherCellsTouched(PartitionCellsTouched &cellsTouched)
+{
+	const Coord3D &pos = cellsTouched.m_pos;
+
+	cellsTouched.m_cells.clear();
+	if (cellsTouched.m_isSmall)
 	{
-		doSmallFill(pos.x, pos.y, majorRadius);
+		doSmallFill(cellsTouched.m_cells, pos.x, pos.y, cellsTouched.m_majorRadius);
 	}
 	else
 	{
-		switch(geom)
+		switch(cellsTouched.m_geom)
 		{
 			case GEOMETRY_SPHERE:
 			case GEOMETRY_CYLINDER:
 			{
-				doCircleFill(pos.x, pos.y, majorRadius);
+				doCircleFill(cellsTouched.m_cells, pos.x, pos.y, cellsTouched.m_majorRadius);
 				break;
 			}
 
 			case GEOMETRY_BOX:
 			{
-				doRectFill(pos.x, pos.y, majorRadius, minorRadius, angle);
+				doRectFill(cellsTouched.m_cells, pos.x, pos.y, cellsTouched.m_majorRadius, cellsTouched.m_minorRadius, cellsTouched.m_angle);
 				break;
 			}
 		};
 	}
+}
+
+//-----------------------------------------------------------------------------
+void PartitionData::updateCellsTouched(const PartitionCellsTouched *precomputed)
+{
+	static PartitionCellsTouched s_cellsTouched;
+
+	Object *obj = getObject();
+
+	getShape(s_cellsTouched);
+	const PartitionCellsTouched *cellsTouched = &s_cellsTouched;
+	if (precomputed && precomputed->isSameShape(s_cellsTouched))
+		cellsTouched = precomputed;
+	else
+		gatherCellsTouched(s_cellsTouched);
+
+	DEBUG_ASSERTCRASH(!cellsTouched->m_isSmall || cellsTouched->m_majorRadius <= ThePartitionManager->getCellSize() * 0.5f,
+		("object is too large to use a 'small' geometry, truncating size to cellsize\n"));
+
+	removeAllTouchedCells();
+	for (std::vector<PartitionCell*>::const_iterator it = cellsTouched->m_cells.begin(); it != cellsTouched->m_cells.end(); ++it)
+	{
+		DEBUG_ASSERTCRASH(m_coiInUseCount < m_coiArrayCount, ("not enough cois allocated for this object"));
+		if (m_coiInUseCount < m_coiArrayCount)
+		{
+			m_coiArray[m_coiInUseCount++].addCoverage(*it, this);
+		}
+	}
 
+	const Coord3D &pos = cellsTouched->m_pos;
 	Int currentCellIndexX, currentCellIndexY;
 	ThePartitionManager->worldToCell( pos.x, pos.y, &currentCellIndexX, &currentCellIndexY );
 	const PartitionCell *currentCell = ThePartitionManager->getCellAt( currentCellIndexX, currentCellIndexY );
@@ -2551,6 +2695,28 @@ PartitionManager::PartitionManager()
 #ifdef FASTER_GCO
 	m_maxGcoRadius = 0;
 #endif
+	m_queryIndexCount = 0;
+	m_queryContextDepth = 0;
+	m_queriesFrozen = false;
+#ifdef FASTER_GCO
+	m_scanCacheSerial = 0;
+#endif
+	m_scanBatchDepth = 0;
+	m_cellMembershipSerial = 0;
+	m_scanCellsWalked = 0;
+	m_scanCellsRequested = 0;
+	m_lastFrameScanCellsWalked = 0;
+	m_lastFrameScanCellsRequested = 0;
+	m_totalScanCellsWalked = 0;
+	m_totalScanCellsRequested = 0;
+	m_valueMapQueries = 0;
+	m_valueMapBuilds = 0;
+	m_valueMapRescans = 0;
+	for (Int i = 0; i < LOS_CACHE_SIZE; ++i)
+		m_losCache[i].m_serial = 0;
+	m_losCacheSerial = 1;
+	m_losQueries = 0;
+	m_losCacheHits = 0;
 } 
 
 //-----------------------------------------------------------------------------
@@ -2559,8 +2725,33 @@ PartitionManager::~PartitionManager()
 
 	shutdown();
 
+	for (std::vector<PartitionQueryContext*>::iterator it = m_queryContexts.begin(); it != m_queryContexts.end(); ++it)
+		delete *it;
+	m_queryContexts.clear();
+
 }  // end ~PartitionManager
 
+//-----------------------------------------------------------------------------
+Int PartitionManager::friend_allocateQueryIndex()
+{
+	DEBUG_ASSERTCRASH(!m_queriesFrozen, ("partition data created while queries are frozen"));
+	if (!m_freeQueryIndices.empty())
+	{
+		Int index = m_freeQueryIndices.back();
+		m_freeQueryIndices.pop_back();
+		return index;
+	}
+	return m_queryIndexCount++;
+}
+
+//-----------------------------------------------------------------------------
+void PartitionManager::friend_releaseQueryIndex(Int index)
+{
+	DEBUG_ASSERTCRASH(!m_queriesFrozen, ("partition data deleted while queries are frozen"));
+	DEBUG_ASSERTCRASH(index >= 0 && index < m_queryIndexCount, ("bad query index"));
+	m_freeQueryIndices.push_back(index);
+}
+
 //-----------------------------------------------------------------------------
 #ifdef PM_CACHE_TERRAIN_HEIGHT
 static void calcHeights(const Region3D& world, Real cellSize, Int x, Int y, Real& loZ, Real& hiZ)
@@ -2669,6 +2860,34 @@ void PartitionManager::reset()
 
 	resetPendingUndoShroudRevealQueue();
 
+#ifdef DEBUG_LOGGING
+	if (m_totalScanCellsRequested > 0)
+	{
+		DEBUG_LOG(("PartitionManager - closest-object searches walked %.0f cells, %.0f without scan batching (%.1f%%)\n",
+			(double)m_totalScanCellsWalked, (double)m_totalScanCellsRequested, 100.0 * m_totalScanCellsWalked / m_totalScanCellsRequested));
+	}
+	if (m_valueMapQueries > 0)
+	{
+		DEBUG_LOG(("PartitionManager - %d value map queries, %d of them built a map, %d rescanned one\n", m_valueMapQueries, m_valueMapBuilds, m_valueMapRescans));
+	}
+	if (m_losQueries > 0)
+	{
+		DEBUG_LOG(("PartitionManager - %d terrain line-of-sight queries, %d answered from the cache (%.1f%%)\n",
+			m_losQueries, m_losCacheHits, 100.0 * m_losCacheHits / m_losQueries));
+	}
+#endif
+	m_scanCellsWalked = 0;
+	m_scanCellsRequested = 0;
+	m_lastFrameScanCellsWalked = 0;
+	m_lastFrameScanCellsRequested = 0;
+	m_totalScanCellsWalked = 0;
+	m_totalScanCellsRequested = 0;
+	m_valueMapQueries = 0;
+	m_valueMapBuilds = 0;
+	m_valueMapRescans = 0;
+	m_losQueries = 0;
+	m_losCacheHits = 0;
+
 	shutdown();
 	//init();
 }
@@ -2693,7 +2912,11 @@ void PartitionManager::shutdown()
 
 #ifdef FASTER_GCO
 	m_radiusVec.clear();
+	m_scanCaches.clear();
 #endif
+	m_valueMapCaches.clear();
+	m_valueMapUpdates.clear();
+	++m_losCacheSerial;
 
 	resetPendingUndoShroudRevealQueue();
 	
@@ -2708,11 +2931,93 @@ void PartitionManager::shutdown()
 	m_worldExtents.hi.zero();
 }
 
+//-----------------------------------------------------------------------------
+void PartitionManager::gatherCellsTouchedProc(Int begin, Int end, void *userData)
+{
+	PartitionManager *self = (PartitionManager *)userData;
+	for (Int i = begin; i < end; ++i)
+	{
+		self->m_cellsTouchedModules[i]->friend_gatherCellsTouched(self->m_cellsTouched[i]);
+	}
+}
+
+//-----------------------------------------------------------------------------
+/**
+	Work out the cells touched by every module that needs its cells updated, spread
+	over the worker threads. Hooking the cells up (and finding collisions) still
+	happens one module at a time, in dirty list order, since what each module finds
+	depends on the modules before it; this just takes the geometry out of that loop.
+	Anything that changes shape before its turn comes is simply worked out again then.
+*/
+void PartitionManager::precomputeCellsTouched()
+{
+	enum { MIN_MODULES = 32, MODULES_PER_CHUNK = 16 };
+
+	m_cellsTouchedModules.clear();
+	if (WorkerPool::getThreadCount() < 2)
+		return;
+
+	for (PartitionData *mod = m_dirtyModules; mod; mod = mod->friend_getNextDirty())
+	{
+		if (mod->isInNeedOfUpdatingCells())
+			m_cellsTouchedModules.push_back(mod);
+	}
+
+	Int count = m_cellsTouchedModules.size();
+	if (count < MIN_MODULES)
+	{
+		m_cellsTouchedModules.clear();
+		return;
+	}
+
+	if ((Int)m_cellsTouched.size() < count)
+		m_cellsTouched.resize(count);
+	if ((Int)m_cellsTouchedSlots.size() < m_queryIndexCount)
+		m_cellsTouchedSlots.resize(m_queryIndexCount, -1);
+
+	for (Int i = 0; i < count; ++i)
+		m_cellsTouchedSlots[m_cellsTouchedModules[i]->friend_getQueryIndex()] = i;
+
+	WorkerPool::parallelFor(count, MODULES_PER_CHUNK, gatherCellsTouchedProc, this);
+}
+
+//-----------------------------------------------------------------------------
+/** Return (and use up) the cells precomputeCellsTouched worked out for mod, if any. */
+const PartitionCellsTouched *PartitionManager::getPrecomputedCellsTouched(PartitionData *mod)
+{
+	if (m_cellsTouchedModules.empty())
+		return NULL;
+
+	Int queryIndex = mod->friend_getQueryIndex();
+	if (queryIndex >= (Int)m_cellsTouchedSlots.size())
+		return NULL;
+
+	// slots are never cleared, so make sure this one is really from this frame and for this module
+	Int slot = m_cellsTouchedSlots[queryIndex];
+	if (slot < 0 || slot >= (Int)m_cellsTouchedModules.size() || m_cellsTouchedModules[slot] != mod)
+		return NULL;
+
+	m_cellsTouchedModules[slot] = NULL;
+	return &m_cellsTouched[slot];
+}
+
 //-----------------------------------------------------------------------------
 //DECLARE_PERF_TIMER(PartitionManager_update)
 void PartitionManager::update()
 {
 	//USE_PERF_TIMER(PartitionManager_update)
+	PROFILE_ZONE("PartitionManager::update");
+	DEBUG_ASSERTCRASH(!m_queriesFrozen, ("partition updated while queries are frozen"));
+
+	m_lastFrameScanCellsWalked = m_scanCellsWalked;
+	m_lastFrameScanCellsRequested = m_scanCellsRequested;
+	m_totalScanCellsWalked += m_scanCellsWalked;
+	m_totalScanCellsRequested += m_scanCellsRequested;
+	m_scanCellsWalked = 0;
+	m_scanCellsRequested = 0;
+
+	// things have moved since the last frame, so there's little point keeping old line-of-sight answers
+	++m_losCacheSerial;
 	{
 #ifdef INTENSE_DEBUG
 		Int cc = 0;
@@ -2722,6 +3027,8 @@ void PartitionManager::update()
 			m_updatedSinceLastReset = true;
 		}
 
+		precomputeCellsTouched();
+
 		PartitionContactList ctList;
 		TheContactList = &ctList;
 		while (m_dirtyModules)
@@ -2745,7 +3052,7 @@ void PartitionManager::update()
 
 			if (updateEm)
 			{
-				dirty->friend_updateCellsTouched();
+				dirty->friend_updateCellsTouched(getPrecomputedCellsTouched(dirty));
 			}
 
 			if (collideEm && !dirty->getObject()->isKindOf(KINDOF_IMMOBILE))
@@ -2754,6 +3061,9 @@ void PartitionManager::update()
 			}
 		}
 		
+		// anything left over was unregistered before we got to it
+		m_cellsTouchedModules.clear();
+
 		ctList.processContactList();
 #ifdef INTENSE_DEBUG
 		DEBUG_ASSERTLOG(cc==0,("updated partition info for %d objects\n",cc));
@@ -3193,15 +3503,115 @@ Object *PartitionManager::getClosestObjects(
 	Int64 startTime64;
 	GetPrecisionTimer(&startTime64);
 #endif
-	
-#ifdef _DEBUG
-	static Int theEntrancyCount = 0;
-	DEBUG_ASSERTCRASH(theEntrancyCount == 0, ("sorry, this routine is not reentrant"));
-	++theEntrancyCount;
+
+	// borrow a context for this nesting level, so that a filter is free to do a query of its own
+	if (m_queryContextDepth == (Int)m_queryContexts.size())
+		m_queryContexts.push_back(new PartitionQueryContext);
+	PartitionQueryContext *ctx = m_queryContexts[m_queryContextDepth++];
+
+	Object *closestObj = doClosestObjectsQuery(*ctx, obj, pos, maxDist, dc, filters, iterArg, false, closestDistArg, closestVecArg);
+
+	--m_queryContextDepth;
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+	if (TheGlobalData->m_checkPartitionQueries)
+		checkClosestObjectsQuery(obj, pos, maxDist, dc, filters, iterArg, closestObj);
+#endif
+
+#ifdef DUMP_PERF_STATS
+	Int64 endTime64;
+	GetPrecisionTimer(&endTime64);
+	Int64 delta = (endTime64 - startTime64);
+	s_timeInClosestObjects += delta;
+	s_timeInClosestObjectsThisFrame += delta;
 #endif
 
+	return closestObj;	// might be null...
+}
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+//-----------------------------------------------------------------------------
+static Bool compareResults(const PartitionQueryContext::Result &a, const PartitionQueryContext::Result &b)
+{
+	return a.m_obj->getID() < b.m_obj->getID();
+}
+
+//-----------------------------------------------------------------------------
+void PartitionManager::checkClosestObjectsQuery(
+	const Object *obj, 
+	const Coord3D *pos, 
+	Real maxDist, 
+	DistanceCalculationType dc, 
+	PartitionFilter **filters, 
+	SimpleObjectIterator *iterArg,
+	Object *closestObj
+)
+{
+	// a context of its own, and frozen so the scan caches are left alone, as on a worker thread.
+	// (the filters are run twice, so one that counts what it has let through will trip this.)
+	PartitionQueryContext ctx;
+	Bool wasFrozen = m_queriesFrozen;
+	setQueriesFrozen(true);
+
+	if (iterArg == NULL)
+	{
+		Object *other = queryClosestObject(ctx, obj, pos, maxDist, dc, filters);
+		DEBUG_ASSERTCRASH(other == closestObj, ("closest object query found %d, but %d through a fresh context",
+			closestObj ? closestObj->getID() : INVALID_ID, other ? other->getID() : INVALID_ID));
+	}
+	else
+	{
+		queryObjectsInRange(ctx, obj, pos, maxDist, dc, filters);
+
+		// the iterator and the context may have them in different orders
+		PartitionQueryContext::ResultVec expected;
+		Real distSqr;
+		for (Object *them = iterArg->firstWithNumeric(&distSqr); them; them = iterArg->nextWithNumeric(&distSqr))
+		{
+			PartitionQueryContext::Result r;
+			r.m_obj = them;
+			r.m_distSqr = distSqr;
+			expected.push_back(r);
+		}
+		PartitionQueryContext::ResultVec actual = ctx.getResults();
+		std::sort(expected.begin(), expected.end(), compareResults);
+		std::sort(actual.begin(), actual.end(), compareResults);
+
+		DEBUG_ASSERTCRASH(expected.size() == actual.size(), ("range query found %d objects, but %d through a fresh context",
+			(Int)expected.size(), (Int)actual.size()));
+		for (size_t i = 0; i < expected.size() && i < actual.size(); ++i)
+		{
+			DEBUG_ASSERTCRASH(expected[i].m_obj == actual[i].m_obj && expected[i].m_distSqr == actual[i].m_distSqr,
+				("range query found object %d at %f, but object %d at %f through a fresh context",
+				expected[i].m_obj->getID(), expected[i].m_distSqr, actual[i].m_obj->getID(), actual[i].m_distSqr));
+		}
+	}
+
+	setQueriesFrozen(wasFrozen);
+}
+#endif
+
+//-----------------------------------------------------------------------------
+Object *PartitionManager::doClosestObjectsQuery(
+	PartitionQueryContext &ctx,
+	const Object *obj, 
+	const Coord3D *pos, 
+	Real maxDist, 
+	DistanceCalculationType dc, 
+	PartitionFilter **filters, 
+	SimpleObjectIterator *iterArg,
+	Bool collectAll,
+	Real *closestDistArg,
+	Coord3D *closestVecArg
+)
+{
 	DEBUG_ASSERTCRASH((obj==NULL) != (pos == NULL), ("either obj or pos must be null"));
 
+	ctx.beginQuery(m_queryIndexCount);
+	ctx.compileFilters(filters);
+	PartitionFilter **remainingFilters = ctx.getRemainingFilters();
+	Bool gatherAll = (iterArg != NULL || collectAll);
+
 	DistCalcProc distProc = theDistCalcProcs[dc];
 
 	const Coord3D *objPos;
@@ -3244,8 +3654,10 @@ Object *PartitionManager::getClosestObjects(
 
 	Bool foundAny = false;
 
-	static Int theIterFlag = 1;	// nonzero, thanks
-	++theIterFlag;
+	// the scan caches are shared, so they're only for the logic thread
+	const ScanCache *scanCache = NULL;
+	if (m_scanBatchDepth > 0 && !m_queriesFrozen)
+		scanCache = getScanCache(ctx, cellCenterX, cellCenterY, maxRadiusLimit);
 
 	/*
 		m_radiusVec[curRadius] contains a list of the cells (foo) that could
@@ -3256,60 +3668,94 @@ Object *PartitionManager::getClosestObjects(
     const OffsetVec& offsets = m_radiusVec[curRadius];
 		if (offsets.empty())
 			continue;
-    for (OffsetVec::const_iterator it = offsets.begin(); it != offsets.end(); ++it)
+
+		if (!m_queriesFrozen)
 		{
-			PartitionCell* thisCell = getCellAt(cellCenterX + it->x, cellCenterY + it->y);
-			if (thisCell == NULL)
-				continue;
+			m_scanCellsRequested += offsets.size();
+			if (scanCache == NULL)
+				m_scanCellsWalked += offsets.size();
+		}
 
-			for (CellAndObjectIntersection *thisCoi = thisCell->getFirstCoiInCell(); thisCoi; thisCoi = thisCoi->getNextCoi())
+		Int candidateIndex = 0, candidateEnd = 0;
+		OffsetVec::const_iterator it = offsets.begin();
+		CellAndObjectIntersection *thisCoi = NULL;
+		if (scanCache)
+		{
+			candidateIndex = scanCache->m_radiusStart[curRadius];
+			candidateEnd = scanCache->m_radiusStart[curRadius + 1];
+		}
+
+		for (;;)
+		{
+			// find the next candidate, either from the cache or by walking the cells
+			PartitionData *thisMod;
+			if (scanCache)
 			{
-				PartitionData *thisMod = thisCoi->getModule();
-				Object *thisObj = thisMod->getObject();
+				if (candidateIndex >= candidateEnd)
+					break;
+				thisMod = scanCache->m_candidates[candidateIndex++];
+			}
+			else
+			{
+				while (thisCoi == NULL && it != offsets.end())
+				{
+					PartitionCell* thisCell = getCellAt(cellCenterX + it->x, cellCenterY + it->y);
+					++it;
+					if (thisCell)
+						thisCoi = thisCell->getFirstCoiInCell();
+				}
+				if (thisCoi == NULL)
+					break;
+				thisMod = thisCoi->getModule();
+				thisCoi = thisCoi->getNextCoi();
+			}
 
-				// never compare against ourself.
-				if (thisObj == obj || thisObj == NULL) 
-					continue;
+			Object *thisObj = thisMod->getObject();
 
-				// since an object can exist in multiple COIs, we use this to avoid processing
-				// the same one more than once.
-				if (thisMod->friend_getDoneFlag() == theIterFlag)
-					continue;
-				thisMod->friend_setDoneFlag(theIterFlag);
-			
-				Real thisDistSqr;
-				Coord3D distVec;
-				if (!(*distProc)(objPos, objToUse, thisObj->getPosition(), thisObj, thisDistSqr, distVec, closestDistSqr))
-					continue;
+			// never compare against ourself.
+			if (thisObj == obj || thisObj == NULL) 
+				continue;
 
-				if (!filtersAllow(filters, thisObj))
-					continue;
+			// since an object can exist in multiple COIs, we use this to avoid processing
+			// the same one more than once. (the cache has no duplicates to begin with.)
+			if (scanCache == NULL && !ctx.markVisited(thisMod))
+				continue;
+		
+			Real thisDistSqr;
+			Coord3D distVec;
+			if (!(*distProc)(objPos, objToUse, thisObj->getPosition(), thisObj, thisDistSqr, distVec, closestDistSqr))
+				continue;
 
-				// ok, this is within the range, and the filters allow it.
-				// add it to the iter, if we have one....
+			if (!ctx.maskAllows(thisObj) || !filtersAllow(remainingFilters, thisObj))
+				continue;
+
+			// ok, this is within the range, and the filters allow it.
+			// add it to the iter, if we have one....
+			if (gatherAll)
+			{
 				if (iterArg)
-				{
 					iterArg->insert(thisObj, thisDistSqr);
-				}
 				else
+					ctx.addResult(thisObj, thisDistSqr);
+			}
+			else
+			{
+				// hey, this is the new closest object! cool.
+				// (note that we can't break out now 'cuz we have to finish examining the
+				// rest of curRadius)
+				closestObj = thisObj;
+				closestDistSqr = thisDistSqr;
+				closestVec = distVec;
+
+				if (!foundAny)
 				{
-					// hey, this is the new closest object! cool.
-					// (note that we can't break out now 'cuz we have to finish examining the
-					// rest of curRadius)
-					closestObj = thisObj;
-					closestDistSqr = thisDistSqr;
-					closestVec = distVec;
-
-					if (!foundAny)
-					{
-						// if not adding to iterArg, we want to stop once we have the closest object. 
-						maxRadiusLimit = curRadius;
-					}
-					foundAny = true;
+					// if not adding to iterArg, we want to stop once we have the closest object. 
+					maxRadiusLimit = curRadius;
 				}
+				foundAny = true;
+			}
 
-			} // next coi
-		}	// next cell in this radius
+		} // next candidate in this radius
   } // next radius
 
 #else // not FASTER_GCO
@@ -3327,9 +3773,6 @@ Object *PartitionManager::getClosestObjects(
 
 	Bool foundAny = false;
 
-	static Int theIterFlag = 1;	// nonzero, thanks
-	++theIterFlag;
-
 	PartitionCell *thisCell;
 	while ((thisCell = iter.nextNonEmpty()) != NULL)
 	{
@@ -3346,10 +3789,8 @@ Object *PartitionManager::getClosestObjects(
 			if (thisObj == obj) 
 				continue;
 
-			if (thisMod->friend_getDoneFlag() == theIterFlag)
+			if (!ctx.markVisited(thisMod))
 				continue;
-
-			thisMod->friend_setDoneFlag(theIterFlag);
 		
 			// hmm, ok, calc the distance.
 			Real thisDistSqr;
@@ -3358,13 +3799,16 @@ Object *PartitionManager::getClosestObjects(
 				continue;
 
 			// check the filters now
-			if (!filtersAllow(filters, thisObj))
+			if (!ctx.maskAllows(thisObj) || !filtersAllow(remainingFilters, thisObj))
 				continue;
 
 			// ok, guess this is a winner!
-			if (iterArg)
+			if (gatherAll)
 			{
-				iterArg->insert(thisObj, thisDistSqr);
+				if (iterArg)
+					iterArg->insert(thisObj, thisDistSqr);
+				else
+					ctx.addResult(thisObj, thisDistSqr);
 			}
 			else
 			{
@@ -3397,18 +3841,87 @@ Object *PartitionManager::getClosestObjects(
 		*closestDistArg = (Real)sqrtf(closestDistSqr);
 	}
 
-#ifdef _DEBUG
-	--theEntrancyCount;
-#endif
-#ifdef DUMP_PERF_STATS
-	Int64 endTime64;
-	GetPrecisionTimer(&endTime64);
-	Int64 delta = (endTime64 - startTime64);
-	s_timeInClosestObjects += delta;
-	s_timeInClosestObjectsThisFrame += delta;
+	return closestObj;	// might be null...
+}
+
+#ifdef FASTER_GCO
+//-----------------------------------------------------------------------------
+/**
+	Return the candidate list for searches centered on the given cell, out to at least
+	maxRadius, building it if need be. Every cache is thrown away as soon as any object
+	changes cells, which normally only happens in update(), so during the object updates
+	they stay good for the whole frame.
+*/
+const PartitionManager::ScanCache *PartitionManager::getScanCache(PartitionQueryContext &ctx, Int cellX, Int cellY, Int maxRadius)
+{
+	if (m_scanCacheSerial != m_cellMembershipSerial)
+	{
+		m_scanCaches.clear();
+		m_scanCacheSerial = m_cellMembershipSerial;
+	}
+
+	ScanCache &cache = m_scanCaches[cellY * m_cellCountX + cellX];
+	if ((Int)cache.m_radiusStart.size() >= maxRadius + 2)
+		return &cache;
+
+	// not built, or not built far enough out. do it over, walking the cells exactly the way
+	// doClosestObjectsQuery would, so the order (and therefore tie-breaking) is unchanged.
+	cache.m_candidates.clear();
+	cache.m_radiusStart.clear();
+	ctx.beginVisits(m_queryIndexCount);
+	for (Int curRadius = 0; curRadius <= maxRadius; ++curRadius)
+	{
+		cache.m_radiusStart.push_back(cache.m_candidates.size());
+
+		const OffsetVec& offsets = m_radiusVec[curRadius];
+		m_scanCellsWalked += offsets.size();
+		for (OffsetVec::const_iterator it = offsets.begin(); it != offsets.end(); ++it)
+		{
+			PartitionCell* thisCell = getCellAt(cellX + it->x, cellY + it->y);
+			if (thisCell == NULL)
+				continue;
+
+			for (CellAndObjectIntersection *thisCoi = thisCell->getFirstCoiInCell(); thisCoi; thisCoi = thisCoi->getNextCoi())
+			{
+				PartitionData *thisMod = thisCoi->getModule();
+				if (ctx.markVisited(thisMod))
+					cache.m_candidates.push_back(thisMod);
+			}
+		}
+	}
+	cache.m_radiusStart.push_back(cache.m_candidates.size());
+
+	return &cache;
+}
 #endif
 
-	return closestObj;	// might be null...
+//-----------------------------------------------------------------------------
+Object *PartitionManager::queryClosestObject(
+	PartitionQueryContext &ctx,
+	const Object *obj, 
+	const Coord3D *pos, 
+	Real maxDist, 
+	DistanceCalculationType dc, 
+	PartitionFilter **filters, 
+	Real *closestDist,
+	Coord3D *closestDistVec
+)
+{
+	return doClosestObjectsQuery(ctx, obj, pos, maxDist, dc, filters, NULL, false, closestDist, closestDistVec);
+}
+
+//-----------------------------------------------------------------------------
+Int PartitionManager::queryObjectsInRange(
+	PartitionQueryContext &ctx,
+	const Object *obj, 
+	const Coord3D *pos, 
+	Real maxDist, 
+	DistanceCalculationType dc, 
+	PartitionFilter **filters
+)
+{
+	doClosestObjectsQuery(ctx, obj, pos, maxDist, dc, filters, NULL, true, NULL, NULL);
+	return (Int)ctx.getResults().size();
 }
 
 
@@ -3923,6 +4436,23 @@ Bool PartitionManager::findPositionAround( const Coord3D *center,
 
 }  // end findPositionAround
 
+//-----------------------------------------------------------------------------
+/**
+	Turn a PlayerMaskType into a mask of player indices, keeping only players that exist.
+	(a player's mask is just 1 << its index, so this is mostly a range check.)
+*/
+static UnsignedInt getPlayerIndexMask( PlayerMaskType playerMask )
+{
+	UnsignedInt playerIndexMask = 0;
+	for( Int currentIndex = ThePlayerList->getPlayerCount() - 1; currentIndex >=0; currentIndex-- )
+	{
+		const Player *currentPlayer = ThePlayerList->getNthPlayer( currentIndex );
+		if( BitTest( playerMask, currentPlayer->getPlayerMask() ) )
+			playerIndexMask |= (1 << currentIndex);
+	}
+	return playerIndexMask;
+}
+
 //-----------------------------------------------------------------------------
 // This is the main accessor of the shroud system.  At this level, allies are taken
 // into consideration as specified by the caller.  Look/Unlook are the ones sending Ally info, as that
@@ -3940,16 +4470,12 @@ void PartitionManager::doShroudReveal(Real centerX, Real centerY, Real radius, P
 
 	DiscreteCircle circle(cellCenterX, cellCenterY, cellRadius);
 
-	for( Int currentIndex = ThePlayerList->getPlayerCount() - 1; currentIndex >=0; currentIndex-- )
-	{
-		// Object's Look is the one who knows about allies.  Anyone can pask a player mask to me and all
-		// of those players will have an active looker applied to a bunch of cells
-		const Player *currentPlayer = ThePlayerList->getNthPlayer( currentIndex );
-		if( BitTest( playerMask, currentPlayer->getPlayerMask() ) )
-		{
-			circle.drawCircle(hLineAddLooker, (void*)currentIndex);
-		}
-	}
+	// Object's Look is the one who knows about allies.  Anyone can pask a player mask to me and all
+	// of those players will have an active looker applied to a bunch of cells.  Draw the circle once
+	// and hand each cell the whole set, rather than drawing it again for every player.
+	UnsignedInt playerIndexMask = getPlayerIndexMask( playerMask );
+	if( playerIndexMask != 0 )
+		circle.drawCircle(hLineAddLooker, (void*)(uintptr_t)playerIndexMask);
 }
 	
 //-----------------------------------------------------------------------------
@@ -4007,14 +4533,9 @@ void PartitionManager::undoShroudReveal(Real centerX, Real centerY, Real radius,
 
 	DiscreteCircle circle(cellCenterX, cellCenterY, cellRadius);
 
-	for( Int currentIndex = ThePlayerList->getPlayerCount() - 1; currentIndex >=0; currentIndex-- )
-	{
-		const Player *currentPlayer = ThePlayerList->getNthPlayer( currentIndex );
-		if( BitTest( playerMask, currentPlayer->getPlayerMask() ) )
-		{
-			circle.drawCircle(hLineRemoveLooker, (void*)currentIndex);
-		}
-	}
+	UnsignedInt playerIndexMask = getPlayerIndexMask( playerMask );
+	if( playerIndexMask != 0 )
+		circle.drawCircle(hLineRemoveLooker, (void*)(uintptr_t)playerIndexMask);
 }
 	
 //-----------------------------------------------------------------------------
@@ -4106,6 +4627,7 @@ void PartitionManager::doThreatAffect( Real centerX, Real centerY, Real radius,
 		if( BitTest( playerMask, currentPlayer->getPlayerMask() ) )
 		{
 			parms.playerIndex = currentIndex;
+			gatherValueMapUpdates(currentIndex, VOT_ThreatValue);
 			circle.drawCircle(hLineAddThreat, &parms);
 		}
 	}
@@ -4139,6 +4661,7 @@ void PartitionManager::undoThreatAffect( Real centerX, Real centerY, Real radius
 		if( BitTest( playerMask, currentPlayer->getPlayerMask() ) )
 		{
 			parms.playerIndex = currentIndex;
+			gatherValueMapUpdates(currentIndex, VOT_ThreatValue);
 			circle.drawCircle(hLineRemoveThreat, &parms);
 		}
 	}
@@ -4172,6 +4695,7 @@ void PartitionManager::doValueAffect( Real centerX, Real centerY, Real radius, U
 		if( BitTest( playerMask, currentPlayer->getPlayerMask() ) )
 		{
 			parms.playerIndex = currentIndex;
+			gatherValueMapUpdates(currentIndex, VOT_CashValue);
 			circle.drawCircle(hLineAddValue, &parms);
 		}
 	}
@@ -4205,6 +4729,7 @@ void PartitionManager::undoValueAffect( Real centerX, Real centerY, Real radius,
 		if( BitTest( playerMask, currentPlayer->getPlayerMask() ) )
 		{
 			parms.playerIndex = currentIndex;
+			gatherValueMapUpdates(currentIndex, VOT_CashValue);
 			circle.drawCircle(hLineRemoveValue, &parms);
 		}
 	}
@@ -4526,10 +5051,57 @@ Bool PartitionManager::isClearLineOfSightTerrain(const Object* obj, const Coord3
 	return true;
 
 #else
-	return TheTerrainLogic->isClearLineOfSight(pos, posOther);
+	Bool clear;
+	if (!findCachedLineOfSight(pos, posOther, clear))
+	{
+		clear = TheTerrainLogic->isClearLineOfSight(pos, posOther);
+		cacheLineOfSight(pos, posOther, clear);
+	}
+	return clear;
 #endif
 }
 
+//-----------------------------------------------------------------------------
+Int PartitionManager::getLineOfSightCacheSlot(const Coord3D& from, const Coord3D& to)
+{
+	UnsignedInt bits[6];
+	memcpy(&bits[0], &from, sizeof(Coord3D));
+	memcpy(&bits[3], &to, sizeof(Coord3D));
+
+	UnsignedInt hash = 0;
+	for (Int i = 0; i < 6; ++i)
+		hash = (hash ^ bits[i]) * 0x9E3779B1;
+
+	return (hash >> 16) & (LOS_CACHE_SIZE - 1);
+}
+
+//-----------------------------------------------------------------------------
+/** Look for the exact pair in the cache; the answer goes in clear if it's there. */
+Bool PartitionManager::findCachedLineOfSight(const Coord3D& from, const Coord3D& to, Bool& clear)
+{
+	++m_losQueries;
+
+	const LineOfSightCacheEntry &entry = m_losCache[getLineOfSightCacheSlot(from, to)];
+	if (entry.m_serial != m_losCacheSerial 
+			|| memcmp(&entry.m_from, &from, sizeof(Coord3D)) != 0
+			|| memcmp(&entry.m_to, &to, sizeof(Coord3D)) != 0)
+		return false;
+
+	++m_losCacheHits;
+	clear = entry.m_clear;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+void PartitionManager::cacheLineOfSight(const Coord3D& from, const Coord3D& to, Bool clear)
+{
+	LineOfSightCacheEntry &entry = m_losCache[getLineOfSightCacheSlot(from, to)];
+	entry.m_from = from;
+	entry.m_to = to;
+	entry.m_serial = m_losCacheSerial;
+	entry.m_clear = clear;
+}
+
 // ------------------------------------------------------------------------------------------------
 /** CRC */
 // ------------------------------------------------------------------------------------------------
@@ -4697,52 +5269,162 @@ Real PartitionManager::getGroundOrStructureHeight(Real posx, Real posy)
 }
 
 //-------------------------------------------------------------------------------------------------
-void PartitionManager::getMostValuableLocation( Int playerIndex, UnsignedInt whichPlayerTypes, ValueOrThreat valType, Coord3D *outLocation )
+/**
+	Return the cash or threat map summed over the players in playerMask, building it the first
+	time it's asked for.
+*/
+const PartitionManager::ValueMapCache *PartitionManager::getValueMapCache(PlayerMaskType playerMask, ValueOrThreat valType)
 {
-	if (!outLocation)
-		return;
+	++m_valueMapQueries;
 
-	PlayerMaskType playerMask = ThePlayerList->getPlayersWithRelationship(playerIndex, whichPlayerTypes);
-	if (playerMask == 0)
-		return;
+	UnsignedInt key = ((UnsignedInt)playerMask << 8) | (UnsignedInt)valType;
+	ValueMapCacheMap::iterator it = m_valueMapCaches.find(key);
+	if (it != m_valueMapCaches.end())
+	{
+		if (it->second.m_extremaStale)
+		{
+			++m_valueMapRescans;
+			findValueMapExtrema(it->second);
+		}
+		return &it->second;
+	}
 
-	Int cellCount = m_cellCountX * m_cellCountY;
-	
-	PlayerMaskType allPlayerMasks[MAX_PLAYER_COUNT] = { 0 };
+	PROFILE_ZONE("PartitionManager::buildValueMap");
+	++m_valueMapBuilds;
+
+	Int players[MAX_PLAYER_COUNT];
+	Int numPlayers = 0;
 	Int totalPlayerCount = ThePlayerList->getPlayerCount();
-	
-	Int i;
-	for (i = 0; i < totalPlayerCount; ++i) {
+	for (Int i = 0; i < totalPlayerCount; ++i) 
+	{
 		Player *player = ThePlayerList->getNthPlayer(i);
-		if (!player) {
-			continue;
-		}
+		if (player && BitTest(player->getPlayerMask(), playerMask))
+			players[numPlayers++] = i;
+	}
 
-		allPlayerMasks[i] = player->getPlayerMask();
+	ValueMapCache &cache = m_valueMapCaches[key];
+	cache.m_playerMask = playerMask;
+	cache.m_valType = valType;
+	cache.m_values.resize(m_totalCellCount);
+	for (Int cellIndex = 0; cellIndex < m_totalCellCount; ++cellIndex) 
+	{
+		PartitionCell &cell = m_cells[cellIndex];
+		UnsignedInt cellValue = 0;
+		for (Int p = 0; p < numPlayers; ++p) 
+		{
+			if (valType == VOT_CashValue)
+				cellValue += cell.getCashValue(players[p]);
+			else
+				cellValue += cell.getThreatValue(players[p]);
+		}
+		cache.m_values[cellIndex] = cellValue;
 	}
+	findValueMapExtrema(cache);
+
+	return &cache;
+}
 
-	Int greatestValueCell = -1;
+//-------------------------------------------------------------------------------------------------
+void PartitionManager::findValueMapExtrema(ValueMapCache &cache)
+{
+	cache.m_bestCell = -1;
+	cache.m_minValue = 0xffffffff;
+	cache.m_maxValue = 0;
+	cache.m_extremaStale = false;
+
+	// note that "best" is decided on the values as signed, which is how it's always been done
 	Int maxCellValue = -1;
-	for (i = 0; i < cellCount; ++i) {
-		Int cellValue = 0;
-
-		for (Int player = 0; player < MAX_PLAYER_COUNT; ++player) {
-			if (BitTest(allPlayerMasks[player], playerMask)) {
-				if (valType == VOT_CashValue) {
-					cellValue += m_cells[i].getCashValue(player);
-				} else {
-					cellValue += m_cells[i].getThreatValue(player);
-				}
-			}
+	Int numCells = cache.m_values.size();
+	for (Int cellIndex = 0; cellIndex < numCells; ++cellIndex) 
+	{
+		UnsignedInt cellValue = cache.m_values[cellIndex];
+		if ((Int)cellValue > maxCellValue) 
+		{
+			maxCellValue = (Int)cellValue;
+			cache.m_bestCell = cellIndex;
 		}
+		if (cellValue < cache.m_minValue)
+			cache.m_minValue = cellValue;
+		if (cellValue > cache.m_maxValue)
+			cache.m_maxValue = cellValue;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Collect the caches that include playerIndex, before its part of an affect is drawn. */
+void PartitionManager::gatherValueMapUpdates(Int playerIndex, ValueOrThreat valType)
+{
+	m_valueMapUpdates.clear();
+	if (m_valueMapCaches.empty())
+		return;
+
+	PlayerMaskType playerMask = ThePlayerList->getNthPlayer(playerIndex)->getPlayerMask();
+	for (ValueMapCacheMap::iterator it = m_valueMapCaches.begin(); it != m_valueMapCaches.end(); ++it)
+	{
+		if (it->second.m_valType == valType && BitTest(playerMask, it->second.m_playerMask))
+			m_valueMapUpdates.push_back(&it->second);
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+/**
+	Add amount to, or take it from, one cell of each gathered cache. The best cell, min and max
+	follow along where they can; if the cell holding one of them went the other way, the cache
+	is rescanned the next time it's asked for.
+*/
+void PartitionManager::updateValueMaps(Int cellIndex, UnsignedInt amount, Bool add)
+{
+	if (amount == 0)
+		return;
+
+	for (std::vector<ValueMapCache*>::iterator it = m_valueMapUpdates.begin(); it != m_valueMapUpdates.end(); ++it)
+	{
+		ValueMapCache &cache = **it;
+		UnsignedInt oldValue = cache.m_values[cellIndex];
+		UnsignedInt newValue = add ? oldValue + amount : oldValue - amount;
+		cache.m_values[cellIndex] = newValue;
+
+		if (cache.m_extremaStale)
+			continue;
 
-		if (cellValue > maxCellValue) {
-			maxCellValue = cellValue;
-			greatestValueCell = i;
+		if (newValue > cache.m_maxValue)
+			cache.m_maxValue = newValue;
+		else if (oldValue == cache.m_maxValue && newValue < oldValue)
+			cache.m_extremaStale = true;
+
+		if (newValue < cache.m_minValue)
+			cache.m_minValue = newValue;
+		else if (oldValue == cache.m_minValue && newValue > oldValue)
+			cache.m_extremaStale = true;
+
+		if (cellIndex == cache.m_bestCell)
+		{
+			if ((Int)newValue < (Int)oldValue)
+				cache.m_extremaStale = true;
+		}
+		else
+		{
+			Int bestValue = (cache.m_bestCell >= 0) ? (Int)cache.m_values[cache.m_bestCell] : -1;
+			if ((Int)newValue > bestValue || ((Int)newValue == bestValue && cellIndex < cache.m_bestCell))
+				cache.m_bestCell = cellIndex;
 		}
 	}
+}
 
-	if (greatestValueCell == -1 || maxCellValue == -1) {
+//-------------------------------------------------------------------------------------------------
+void PartitionManager::getMostValuableLocation( Int playerIndex, UnsignedInt whichPlayerTypes, ValueOrThreat valType, Coord3D *outLocation )
+{
+	if (!outLocation)
+		return;
+
+	PlayerMaskType playerMask = ThePlayerList->getPlayersWithRelationship(playerIndex, whichPlayerTypes);
+	if (playerMask == 0)
+		return;
+
+	const ValueMapCache *valueMap = getValueMapCache(playerMask, valType);
+	Int greatestValueCell = valueMap->m_bestCell;
+
+	if (greatestValueCell == -1) {
 		DEBUG_CRASH(("PartitionManager::getMostValuableLocation: jkmcd"));
 		return;
 	}
@@ -4764,26 +5446,19 @@ void PartitionManager::getNearestGroupWithValue( Int playerIndex, UnsignedInt wh
 	if (playerMask == 0)
 		return;
 	
-	PlayerMaskType allPlayerMasks[MAX_PLAYER_COUNT] = { 0 };
-	Int totalPlayerCount = ThePlayerList->getPlayerCount();
-	
-	Int i;
-	for (i = 0; i < totalPlayerCount; ++i) {
-		Player *player = ThePlayerList->getNthPlayer(i);
-		if (!player) {
-			continue;
-		}
-
-		allPlayerMasks[i] = player->getPlayerMask();
-	}
+	const ValueMapCache *valueMap = getValueMapCache(playerMask, valType);
 
 	CellValueProcParms parms;
 	parms.valueRequired = valueRequired;
 	parms.greaterThan = valueRequired;
-	parms.valueType = valType;
-	parms.allowedPlayersMasks = playerMask;
-	for (i = 0; i < MAX_PLAYER_COUNT; ++i) 
-		parms.allPlayersMask[i] = allPlayerMasks[i];
+	parms.cellValues = &valueMap->m_values[0];
+	parms.cellCountX = m_cellCountX;
+
+	// if no cell on the map passes, don't bother flooding the whole thing to find that out
+	if (parms.greaterThan && valueMap->m_maxValue <= (UnsignedInt)valueRequired)
+		return;
+	if (!parms.greaterThan && valueMap->m_minValue >= (UnsignedInt)valueRequired)
+		return;
 	
 	Int nearestGreat = iterateCellsBreadthFirst(sourceLocation, cellValueProc, &parms);
 	if (nearestGreat != -1) {
@@ -5240,6 +5915,12 @@ Bool PartitionFilterSameMapStatus::allow(Object* objOther)
 	return objOther->isOffMap() == m_obj->isOffMap();
 }
 
+//-----------------------------------------------------------------------------
+Bool PartitionFilterSameMapStatus::addToMask(PartitionFilterMask &mask) const
+{
+	return mask.addMapStatus(m_obj->isOffMap() ? PartitionFilterMask::MAP_STATUS_OFF_MAP : PartitionFilterMask::MAP_STATUS_ON_MAP);
+}
+
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
@@ -5506,16 +6187,7 @@ static int cellValueProc(PartitionCell* cell, void* userData)
 {
 	CellValueProcParms *parms = (CellValueProcParms*) userData;
 
-	UnsignedInt val = 0;
-	for (Int i = 0; i < MAX_PLAYER_COUNT; ++i) {
-		if (BitTest(parms->allowedPlayersMasks, parms->allPlayersMask[i])) {
-			if (parms->valueType == VOT_CashValue) {
-				val += cell->getCashValue(i);
-			} else {
-				val += cell->getThreatValue(i);
-			}
-		}
-	}
+	UnsignedInt val = parms->cellValues[cell->getCellY() * parms->cellCountX + cell->getCellX()];
 
 	if ((val > parms->valueRequired && parms->greaterThan) || 
 			(val < parms->valueRequired && !parms->greaterThan)) {
@@ -5526,36 +6198,44 @@ static int cellValueProc(PartitionCell* cell, void* userData)
 }
 
 // -----------------------------------------------------------------------------
-void hLineAddLooker(Int x1, Int x2, Int y, void *playerIndexVoid)
+void hLineAddLooker(Int x1, Int x2, Int y, void *playerIndexMaskVoid)
 {
 	if (y < 0 || y >= ThePartitionManager->m_cellCountY || x1 >= ThePartitionManager->m_cellCountX || x2 < 0)
 		return;
 
-	Int playerIndex = (Int)(uintptr_t)(playerIndexVoid);
+	UnsignedInt playerIndexMask = (UnsignedInt)(uintptr_t)(playerIndexMaskVoid);
 
-	PartitionCell* cell = &ThePartitionManager->m_cells[y * ThePartitionManager->m_cellCountX + x1];	// yes, this could be invalid. we'll skip the bad ones.
+	// clip the span to the map up front, rather than testing every cell
+	if (x1 < 0)
+		x1 = 0;
+	if (x2 >= ThePartitionManager->m_cellCountX)
+		x2 = ThePartitionManager->m_cellCountX - 1;
+
+	PartitionCell* cell = &ThePartitionManager->m_cells[y * ThePartitionManager->m_cellCountX + x1];
 	for (Int x = x1; x <= x2; ++x, ++cell)
 	{
-		if (x < 0 || x >= ThePartitionManager->m_cellCountX)
-			continue;
-		cell->addLooker(playerIndex);
+		cell->addLookers(playerIndexMask);
 	}
 }
 
 // -----------------------------------------------------------------------------
-void hLineRemoveLooker(Int x1, Int x2, Int y, void *playerIndexVoid)
+void hLineRemoveLooker(Int x1, Int x2, Int y, void *playerIndexMaskVoid)
 {
 	if (y < 0 || y >= ThePartitionManager->m_cellCountY || x1 >= ThePartitionManager->m_cellCountX || x2 < 0)
 		return;
 
-	Int playerIndex = (Int)(uintptr_t)(playerIndexVoid);
+	UnsignedInt playerIndexMask = (UnsignedInt)(uintptr_t)(playerIndexMaskVoid);
 
-	PartitionCell* cell = &ThePartitionManager->m_cells[y * ThePartitionManager->m_cellCountX + x1];	// yes, this could be invalid. we'll skip the bad ones.
+	// clip the span to the map up front, rather than testing every cell
+	if (x1 < 0)
+		x1 = 0;
+	if (x2 >= ThePartitionManager->m_cellCountX)
+		x2 = ThePartitionManager->m_cellCountX - 1;
+
+	PartitionCell* cell = &ThePartitionManager->m_cells[y * ThePartitionManager->m_cellCountX + x1];
 	for (Int x = x1; x <= x2; ++x, ++cell)
 	{
-		if (x < 0 || x >= ThePartitionManager->m_cellCountX)
-			continue;
-		cell->removeLooker(playerIndex);
+		cell->removeLookers(playerIndexMask);
 	}
 }
 
@@ -5617,7 +6297,9 @@ void hLineAddThreat(Int x1, Int x2, Int y, void *threatValueParms)
 		else if (mulVal > 1.0f)
 			mulVal = 1.0f;
 
-		cell->addThreatValue( parms->playerIndex, REAL_TO_UNSIGNEDINT(parms->threatOrValue * mulVal) );
+		UnsignedInt amount = REAL_TO_UNSIGNEDINT(parms->threatOrValue * mulVal);
+		cell->addThreatValue( parms->playerIndex, amount );
+		ThePartitionManager->updateValueMaps(cell - ThePartitionManager->m_cells, amount, TRUE);
 	}
 }
 
@@ -5645,7 +6327,9 @@ void hLineRemoveThreat(Int x1, Int x2, Int y, void *threatValueParms)
 		else if (mulVal > 1.0f)
 			mulVal = 1.0f;
 		
-		cell->removeThreatValue( parms->playerIndex, REAL_TO_UNSIGNEDINT(parms->threatOrValue * mulVal) );
+		UnsignedInt amount = REAL_TO_UNSIGNEDINT(parms->threatOrValue * mulVal);
+		cell->removeThreatValue( parms->playerIndex, amount );
+		ThePartitionManager->updateValueMaps(cell - ThePartitionManager->m_cells, amount, FALSE);
 	}
 }
 
@@ -5673,7 +6357,9 @@ void hLineAddValue(Int x1, Int x2, Int y, void *threatValueParms)
 		else if (mulVal > 1.0f)
 			mulVal = 1.0f;
 		
-		cell->addCashValue( parms->playerIndex, REAL_TO_UNSIGNEDINT(parms->threatOrValue * mulVal) );
+		UnsignedInt amount = REAL_TO_UNSIGNEDINT(parms->threatOrValue * mulVal);
+		cell->addCashValue( parms->playerIndex, amount );
+		ThePartitionManager->updateValueMaps(cell - ThePartitionManager->m_cells, amount, TRUE);
 	}
 }
 
@@ -5701,7 +6387,9 @@ void hLineRemoveValue(Int x1, Int x2, Int y, void *threatValueParms)
 		else if (mulVal > 1.0f)
 			mulVal = 1.0f;
 
-		cell->removeCashValue( parms->playerIndex, REAL_TO_UNSIGNEDINT(parms->threatOrValue * mulVal) );
+		UnsignedInt amount = REAL_TO_UNSIGNEDINT(parms->threatOrValue * mulVal);
+		cell->removeCashValue( parms->playerIndex, amount );
+		ThePartitionManager->updateValueMaps(cell - ThePartitionManager->m_cells, amount, FALSE);
 	}
 }
 
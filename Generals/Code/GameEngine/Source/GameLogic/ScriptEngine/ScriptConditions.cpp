@@ -450,64 +450,32 @@ Bool ScriptConditions::evaluatePlayerHasUnitTypeInArea(Condition *pCondition, Pa
 	if (!pPlayer) {
 		return false;
 	}
-	Player::PlayerTeamList::const_iterator it;
-	Bool anyChanges = false;
-
-
-	if (pCondition->getCustomData() == 0) anyChanges = true;
-
-	for (it = pPlayer->getPlayerTeams()->begin(); it != pPlayer->getPlayerTeams()->end(); ++it) {
-		if (anyChanges) break;
-		for (DLINK_ITERATOR<Team> iter = (*it)->iterate_TeamInstanceList(); !iter.done(); iter.advance()) {
-			if (anyChanges) break;
-			Team *team = iter.cur();
-			if (!team) {
-				continue;
-			}
-			if (team->didEnterOrExit()) {
-				anyChanges = true; 
-			}
-		}
-	}
-
-	if (TheScriptEngine->getFrameObjectCountChanged()+1 >= TheGameLogic->getFrame()) {
-		anyChanges = true; // Objects were added/deleted last frame, so count could have changed.  jba.
-	}
-
-	if (!anyChanges) {
-		if (pCondition->getCustomData()==-1) return false;
-		if (pCondition->getCustomData()==1) return true;
-	}
-
+	// Note - ScriptEngine only re-evaluates this when objects are created, destroyed, change teams
+	// or enter/exit trigger areas.
 	ObjectTypesTemp types;
 	objectTypesFromParam(pTypeParm, types.m_types);
 
+	// Only look at the objects inside the area, rather than everything the player owns.
 	Int count = 0;
-	for (it = pPlayer->getPlayerTeams()->begin(); it != pPlayer->getPlayerTeams()->end(); ++it) {
-		for (DLINK_ITERATOR<Team> iter = (*it)->iterate_TeamInstanceList(); !iter.done(); iter.advance()) {
-			Team *team = iter.cur();
-			if (!team) {
-				continue;
-			}
-			for (DLINK_ITERATOR<Object> iter = team->iterate_TeamMemberList(); !iter.done(); iter.advance()) {
-				Object *pObj = iter.cur();
-				if (!pObj) {
-					continue;
-				}
-
-				if (types.m_types->isInSet(pObj->getTemplate())) {
-					if (pObj->isInside(pTrig)) {
+	const ObjectIDVector &occupants = pTrig->getOccupants();
+	for (ObjectIDVector::const_iterator it = occupants.begin(); it != occupants.end(); ++it) {
+		Object *pObj = TheGameLogic->findObjectByID(*it);
+		if (!pObj || pObj->getControllingPlayer() != pPlayer) {
+			continue;
+		}
+		if (!pObj->isInside(pTrig)) {
+			DEBUG_CRASH(("Trigger area occupant isn't inside."));
+			continue;
+		}
 
-						//
-						// dead objects will not be considered, except crates ... they are "dead" cause
-						// they have no body and health, but are a class of object we want to
-						// trigger this stuff
-						//
-						if (!(pObj->isEffectivelyDead() || pObj->isKindOf(KINDOF_INERT)) || pObj->isKindOf( KINDOF_CRATE ) ) {
-							count++;
-						}
-					}
-				}
+		if (types.m_types->isInSet(pObj->getTemplate())) {
+			//
+			// dead objects will not be considered, except crates ... they are "dead" cause
+			// they have no body and health, but are a class of object we want to
+			// trigger this stuff
+			//
+			if (!(pObj->isEffectivelyDead() || pObj->isKindOf(KINDOF_INERT)) || pObj->isKindOf( KINDOF_CRATE ) ) {
+				count++;
 			}
 		}
 	}
@@ -522,10 +490,6 @@ Bool ScriptConditions::evaluatePlayerHasUnitTypeInArea(Condition *pCondition, Pa
 		case Parameter::GREATER :				comparison = (count > pCountParm->getInt()); break;
 		case Parameter::NOT_EQUAL :			comparison = (count != pCountParm->getInt()); break;
 	}
-	pCondition->setCustomData(-1); // false.
-	if (comparison) {
-		pCondition->setCustomData(1); // true.
-	}
 	return comparison;
 }  
 
@@ -545,53 +509,23 @@ Bool ScriptConditions::evaluatePlayerHasUnitKindInArea(Condition *pCondition, Pa
 		return false;
 	}
 
-	Player::PlayerTeamList::const_iterator it;
-	Bool anyChanges = false;
-	if (pCondition->getCustomData() == 0) anyChanges = true;
-
-
-	for (it = pPlayer->getPlayerTeams()->begin(); it != pPlayer->getPlayerTeams()->end(); ++it) {
-		if (anyChanges) break;
-		for (DLINK_ITERATOR<Team> iter = (*it)->iterate_TeamInstanceList(); !iter.done(); iter.advance()) {
-			if (anyChanges) break;
-			Team *team = iter.cur();
-			if (!team) {
-				continue;
-			}
-			if (team->didEnterOrExit()) {
-				anyChanges = true; 
-			}
-		}
-	}
-	if (TheScriptEngine->getFrameObjectCountChanged()+1 >= TheGameLogic->getFrame()) {
-		anyChanges = true; // Objects were added/deleted last frame, so count could have changed.  jba.
-	}
-	if (!anyChanges) {
-		if (pCondition->getCustomData()==-1) return false;
-		if (pCondition->getCustomData()==1) return true;
-
-	}
-
-
+	// Note - ScriptEngine only re-evaluates this when objects are created, destroyed, change teams
+	// or enter/exit trigger areas.
+	// Only look at the objects inside the area, rather than everything the player owns.
 	Int count = 0;
-	for (it = pPlayer->getPlayerTeams()->begin(); it != pPlayer->getPlayerTeams()->end(); ++it) {
-		for (DLINK_ITERATOR<Team> iter = (*it)->iterate_TeamInstanceList(); !iter.done(); iter.advance()) {
-			Team *team = iter.cur();
-			if (!team) {
-				continue;
-			}
-			for (DLINK_ITERATOR<Object> iter = team->iterate_TeamMemberList(); !iter.done(); iter.advance()) {
-				Object *pObj = iter.cur();
-				if (!pObj) {
-					continue;
-				}
-				if (pObj->isKindOf(kind)) {
-					if (pObj->isInside(pTrig)) {
-						if (!(pObj->isEffectivelyDead() || pObj->isKindOf(KINDOF_INERT))) {
-							count++;
-						}
-					}
-				}
+	const ObjectIDVector &occupants = pTrig->getOccupants();
+	for (ObjectIDVector::const_iterator it = occupants.begin(); it != occupants.end(); ++it) {
+		Object *pObj = TheGameLogic->findObjectByID(*it);
+		if (!pObj || pObj->getControllingPlayer() != pPlayer) {
+			continue;
+		}
+		if (!pObj->isInside(pTrig)) {
+			DEBUG_CRASH(("Trigger area occupant isn't inside."));
+			continue;
+		}
+		if (pObj->isKindOf(kind)) {
+			if (!(pObj->isEffectivelyDead() || pObj->isKindOf(KINDOF_INERT))) {
+				count++;
 			}
 		}
 	}
@@ -839,14 +773,7 @@ Bool ScriptConditions::evaluateTeamAttackedByPlayer(Parameter *pTeamParm, Parame
 //-------------------------------------------------------------------------------------------------
 Bool ScriptConditions::evaluateBuiltByPlayer(Condition *pCondition, Parameter* pTypeParm, Parameter* pPlayerParm)
 {
-	if (pCondition->getCustomData()!=0) {
-		// We have a cached value.
-		if (TheScriptEngine->getFrameObjectCountChanged()+1 < TheGameLogic->getFrame()) {
-			// object count hasn't changed recently.  Use cached value.
-			if (pCondition->getCustomData()==1) return true;
-			if (pCondition->getCustomData()==-1) return false;
-		}
-	}
+	// Note - ScriptEngine caches the result until the object counts change.
 	Player* pPlayer = playerFromParam(pPlayerParm);
 	if (!pPlayer) {
 		return false;
@@ -871,10 +798,6 @@ Bool ScriptConditions::evaluateBuiltByPlayer(Condition *pCondition, Parameter* p
 	}
 
 	Int sumOfObjs = rts::sum(counts);
-	pCondition->setCustomData(-1); // false.
-	if (sumOfObjs != 0) {
-		pCondition->setCustomData(1); // true.
-	}
 	return (sumOfObjs != 0);
 }
 
@@ -1705,15 +1628,7 @@ Bool ScriptConditions::evaluateMultiplayerPlayerDefeat(void)
 //-------------------------------------------------------------------------------------------------
 Bool ScriptConditions::evaluatePlayerUnitCondition(Condition *pCondition, Parameter *pPlayerParm, Parameter *pComparisonParm, Parameter *pCountParm, Parameter *pUnitTypeParm)
 {					
-	if (pCondition->getCustomData()!=0) {
-		// We have a cached value.
-		if (TheScriptEngine->getFrameObjectCountChanged()+1 < TheGameLogic->getFrame()) {
-			// object count hasn't changed recently.  Use cached value.
-			if (pCondition->getCustomData()==1) return true;
-			if (pCondition->getCustomData()==-1) return false;
-		}
-	}
-
+	// Note - ScriptEngine caches the result until the object counts change.
 	Player* pPlayer = playerFromParam(pPlayerParm);
 	if (!pPlayer) {
 		return false;
@@ -1746,10 +1661,6 @@ Bool ScriptConditions::evaluatePlayerUnitCondition(Condition *pCondition, Parame
 			DEBUG_CRASH(("ScriptConditions::evaluatePlayerUnitCondition: Invalid comparison type. (jkmcd)"));
 			break;
 	}
-	pCondition->setCustomData(-1); // false.
-	if (comparison) {
-		pCondition->setCustomData(1); // true.
-	}
 	return comparison;
 }
 
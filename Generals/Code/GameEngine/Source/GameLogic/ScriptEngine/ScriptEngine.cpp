@@ -31,6 +31,7 @@
 #include "Common/DataChunk.h"
 #include "Common/File.h"
 #include "Common/FileSystem.h"
+#include "Common/FrameProfiler.h"
 #include "Common/GameEngine.h"
 #include "Common/GameState.h"
 #include "Common/LatchRestore.h"
@@ -372,6 +373,11 @@ m_skirmishHumanPlayer(NULL),
 m_fade(FADE_NONE),
 m_freezeByScript(FALSE),
 m_frameObjectCountChanged(0),
+m_scriptEventSerial(0),
+m_conditionCacheResetSerial(0),
+m_conditionEvaluations(0),
+m_conditionEvaluationsSkipped(0),
+m_scriptIndexBuilt(false),
 //Added By Sadullah Nader
 //Initializations inserted
 m_closeWindowTimer(0),
@@ -394,6 +400,7 @@ m_ChooseVictimAlwaysUsesNormal(false)
 	st_LastCurrentFrame = st_CurrentFrame = 0;
 	// By default, difficulty should be normal.
 	setGlobalDifficulty(DIFFICULTY_NORMAL);
+	invalidateConditionCache();
 
 }  // end ScriptEngine
 
@@ -4552,6 +4559,11 @@ void ScriptEngine::reset( void )
 	m_numCounters = 1;
 	m_numAttackInfo = 1;
 	m_numFlags = 1;
+	m_counterIndex.clear();
+	m_flagIndex.clear();
+	m_scriptIndex.clear();
+	m_scriptGroupIndex.clear();
+	m_scriptIndexBuilt = false;
 	m_endGameTimer = -1;
 	m_closeWindowTimer = -1;
 
@@ -4565,6 +4577,26 @@ void ScriptEngine::reset( void )
 
 	m_shownMPLocalDefeatWindow = FALSE;
 
+#ifdef DEBUG_LOGGING
+	if (m_conditionEvaluations > 0) {
+		DEBUG_LOG(("Script conditions on %s: %d evaluated, %d (%.1f%%) answered from cache.\n", m_conditionStatsMapName.str(),
+			m_conditionEvaluations, m_conditionEvaluationsSkipped, 100.0f*m_conditionEvaluationsSkipped/m_conditionEvaluations));
+		for (Int type = 0; type < Condition::NUM_ITEMS; type++) {
+			if (m_conditionEvaluationsByType[type] > 0) {
+				DEBUG_LOG(("  %s: %d evaluated, %d answered from cache.\n", m_conditionTemplates[type].getName().str(),
+					m_conditionEvaluationsByType[type], m_conditionEvaluationsSkippedByType[type]));
+			}
+		}
+	}
+	for (Int type = 0; type < Condition::NUM_ITEMS; type++) {
+		m_conditionEvaluationsByType[type] = 0;
+		m_conditionEvaluationsSkippedByType[type] = 0;
+	}
+#endif
+	m_conditionEvaluations = 0;
+	m_conditionEvaluationsSkipped = 0;
+	invalidateConditionCache();
+
 	Int i;
 	for (i=0; i<MAX_COUNTERS; i++) {
 		m_counters[i].value = 0;
@@ -4662,6 +4694,8 @@ void ScriptEngine::reset( void )
 	
 	// Clear the named objects list.
  	m_namedObjects.clear();
+	m_namedObjectIndex.clear();
+	m_namedObjectPtrIndex.clear();
 
 	m_completedVideo.clear();
 	m_testingSpeech.clear();
@@ -4697,6 +4731,11 @@ void ScriptEngine::reset( void )
 void ScriptEngine::newMap( void )
 {
 	m_numCounters = 1;
+	m_counterIndex.clear();
+	m_flagIndex.clear();
+	m_scriptIndex.clear();
+	m_scriptGroupIndex.clear();
+	m_scriptIndexBuilt = false;
 	Int i;
 	for (i=0; i<MAX_COUNTERS; i++) {
 		m_counters[i].value = 0;
@@ -4710,6 +4749,10 @@ void ScriptEngine::newMap( void )
 	}
 	m_endGameTimer = -1;
 	m_closeWindowTimer = -1;
+	invalidateConditionCache();
+#ifdef DEBUG_LOGGING
+	m_conditionStatsMapName = TheGlobalData->m_mapName;
+#endif
 #ifdef SPECIAL_SCRIPT_PROFILING
 #ifdef DEBUG_LOGGING
 	m_numFrames=0;
@@ -4767,6 +4810,7 @@ DECLARE_PERF_TIMER(ScriptEngine)
 void ScriptEngine::update( void )
 {
 	USE_PERF_TIMER(ScriptEngine)
+	PROFILE_ZONE("ScriptEngine::update");
 #ifdef SPECIAL_SCRIPT_PROFILING
 #ifdef DEBUG_LOGGING
 	__int64 startTime64;
@@ -4827,6 +4871,12 @@ void ScriptEngine::update( void )
 	if (TheScriptConditions) {
 		TheScriptConditions->update();
 	}
+	// Objects created or destroyed last frame may not have settled into their teams and trigger 
+	// areas until this frame, so give unit count conditions one more look.
+	if (m_frameObjectCountChanged != 0 && m_frameObjectCountChanged+1 == TheGameLogic->getFrame()) {
+		notifyOfScriptEvent(SCRIPT_EVENT_OBJECT_COUNT);
+	}
+
 	// Update any countdown timers.
 	Int i;
 	// Note - counters start at 1.  0 means not assigned.
@@ -4835,6 +4885,10 @@ void ScriptEngine::update( void )
 			// If counter has any time left, decrement.  Counters go to -1 and stop.
 			if (m_counters[i].value >= 0) {
 				m_counters[i].value--;
+				m_counterSerials[i] = ++m_scriptEventSerial;
+				if (m_counters[i].value == 0) {
+					m_timerSerials[i] = m_counterSerials[i]; // Just expired.
+				}
 			}
 		}
 	}
@@ -4863,7 +4917,10 @@ void ScriptEngine::update( void )
 	ThePlayerList->updateTeamStates();
 
 	// Clear the UI Interaction flags.
-	m_uiInteractions.clear();
+	if (!m_uiInteractions.empty()) {
+		m_uiInteractions.clear();
+		notifyOfScriptEvent(SCRIPT_EVENT_UI_INTERACTION);
+	}
 
 	// update all sequential stuff.
 	evaluateAndProgressAllSequentialScripts();
@@ -5035,12 +5092,10 @@ void ScriptEngine::clearFlag(const AsciiString &name)
 	for (j=0; j<MAX_PLAYER_COUNT; j++) {
 		AsciiString modName;
 		modName.format("%s%d", name.str(), j);
-		// Note - flags start at 1.  0 means not assigned.
-		Int i;
-		for (i=1; i<m_numFlags; i++) {
-			if ((modName==m_flags[i].name)) {
-				m_flags[i].value = FALSE;
-			}
+		NameKeyIndexMap::const_iterator it = m_flagIndex.find(NAMEKEY(modName));
+		if (it != m_flagIndex.end()) {
+			m_flags[it->second].value = FALSE;
+			touchFlag(it->second);
 		}
 	}
 }  // end clearFlag
@@ -5178,6 +5233,7 @@ void ScriptEngine::doObjectTypeListMaintenance(const AsciiString& objectTypeList
 	} else {
 		currentObjectTypeVec->removeObjectType(objectType);
 	}
+	notifyOfScriptEvent(SCRIPT_EVENT_OBJECT_TYPES);
 
 	// Remove it. Its dead Jim.
 	if (currentObjectTypeVec->getListSize() == 0) {
@@ -5283,10 +5339,9 @@ Object * ScriptEngine::getUnitNamed(const AsciiString& unitName)
 		return m_conditionObject;
 	}
 
-	for (VecNamedRequestsIt it = m_namedObjects.begin(); it != m_namedObjects.end(); ++it) {
-		if (unitName == (it->first)) {
-			return it->second;
-		}
+	NameKeyIndexMap::const_iterator it = m_namedObjectIndex.find(NAMEKEY(unitName));
+	if (it != m_namedObjectIndex.end()) {
+		return m_namedObjects[it->second].second;
 	}
 	return NULL;
 }
@@ -5296,10 +5351,9 @@ Object * ScriptEngine::getUnitNamed(const AsciiString& unitName)
 //-------------------------------------------------------------------------------------------------
 Bool ScriptEngine::didUnitExist(const AsciiString& unitName)
 {
-	for (VecNamedRequestsIt it = m_namedObjects.begin(); it != m_namedObjects.end(); ++it) {
-		if (unitName == (it->first)) {
-			return (it->second == NULL);
-		}
+	NameKeyIndexMap::const_iterator it = m_namedObjectIndex.find(NAMEKEY(unitName));
+	if (it != m_namedObjectIndex.end()) {
+		return (m_namedObjects[it->second].second == NULL);
 	}
 	return false;
 }
@@ -5412,14 +5466,15 @@ Int ScriptEngine::allocateCounter( const AsciiString& name)
 {
 	Int i;
 	// Note - counters start at 1.  0 means not assigned.
-	for (i=1; i<m_numCounters; i++) {
-		if (name==m_counters[i].name) {
-			return i;
-		}
+	NameKeyType key = NAMEKEY(name);
+	NameKeyIndexMap::const_iterator it = m_counterIndex.find(key);
+	if (it != m_counterIndex.end()) {
+		return it->second;
 	}
 	DEBUG_ASSERTCRASH(m_numCounters<MAX_COUNTERS, ("Too many counters, failed to make '%s'.\n", name.str()));
 	if (m_numCounters < MAX_COUNTERS) {
 		m_counters[m_numCounters].name = name;
+		m_counterIndex[key] = m_numCounters;
 		i = m_numCounters;
 		m_numCounters++;
 		return(i);
@@ -5432,13 +5487,10 @@ Int ScriptEngine::allocateCounter( const AsciiString& name)
 //-------------------------------------------------------------------------------------------------
 const TCounter *ScriptEngine::getCounter(const AsciiString& counterName)
 {
-	Int i;
-	for (i=1; i<m_numCounters; i++)
+	NameKeyIndexMap::const_iterator it = m_counterIndex.find(NAMEKEY(counterName));
+	if (it != m_counterIndex.end())
 	{
-		if (counterName == m_counters[i].name)
-		{
-			return &(m_counters[i]);
-		}
+		return &(m_counters[it->second]);
 	}
 	return NULL;
 }
@@ -5550,14 +5602,15 @@ Int ScriptEngine::allocateFlag( const AsciiString& name)
 {
 	Int i;
 	// Note - flags start at 1.  0 means not assigned.
-	for (i=1; i<m_numFlags; i++) {
-		if ((name==m_flags[i].name)) {
-			return i;
-		}
+	NameKeyType key = NAMEKEY(name);
+	NameKeyIndexMap::const_iterator it = m_flagIndex.find(key);
+	if (it != m_flagIndex.end()) {
+		return it->second;
 	}
 	DEBUG_ASSERTCRASH(m_numFlags < MAX_FLAGS, ("Too many flags, failed to make '%s'..\n", name.str()));
 	if (m_numFlags < MAX_FLAGS) {
 		m_flags[m_numFlags].name = name;
+		m_flagIndex[key] = m_numFlags;
 		i = m_numFlags;
 		m_numFlags++;
 		return(i);
@@ -5570,16 +5623,12 @@ Int ScriptEngine::allocateFlag( const AsciiString& name)
 //-------------------------------------------------------------------------------------------------
 ScriptGroup  *ScriptEngine::findGroup(const AsciiString& name)
 {
-	Int i;
-	for (i=0; i<TheSidesList->getNumSides(); i++) {
-		ScriptList *pSL = TheSidesList->getSideInfo(i)->getScriptList();
-		if (pSL==NULL) continue;
-		ScriptGroup *pGroup;
-		for (pGroup = pSL->getScriptGroup(); pGroup; pGroup=pGroup->getNext()) {
-			if (pGroup->getName() == name) {
-				return pGroup;
-			}
-		}
+	if (!m_scriptIndexBuilt) {
+		buildScriptNameIndex();
+	}
+	ScriptGroupNameMap::const_iterator it = m_scriptGroupIndex.find(NAMEKEY(name));
+	if (it != m_scriptGroupIndex.end()) {
+		return it->second;
 	}
 	return 0; // Shouldn't ever happen.
 }
@@ -5589,26 +5638,41 @@ ScriptGroup  *ScriptEngine::findGroup(const AsciiString& name)
 //-------------------------------------------------------------------------------------------------
 Script  *ScriptEngine::findScript(const AsciiString& name)
 {
+	if (!m_scriptIndexBuilt) {
+		buildScriptNameIndex();
+	}
+	ScriptNameMap::const_iterator it = m_scriptIndex.find(NAMEKEY(name));
+	if (it != m_scriptIndex.end()) {
+		return it->second;
+	}
+	return 0; // Shouldn't ever happen.
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Indexes the scripts & groups in TheSidesList by name.  If names are duplicated, the first one
+		in side order wins, same as the old linear search. */
+//-------------------------------------------------------------------------------------------------
+void ScriptEngine::buildScriptNameIndex(void)
+{
+	m_scriptIndex.clear();
+	m_scriptGroupIndex.clear();
 	Int i;
 	for (i=0; i<TheSidesList->getNumSides(); i++) {
 		ScriptList *pSL = TheSidesList->getSideInfo(i)->getScriptList();
 		if (pSL==NULL) continue;
 		Script *pScr;
 		for (pScr = pSL->getScript(); pScr; pScr=pScr->getNext()) {
-			if ((name==pScr->getName())) {
-				return pScr;
-			}
+			m_scriptIndex.insert(ScriptNameMap::value_type(NAMEKEY(pScr->getName()), pScr));
 		}
 		ScriptGroup *pGroup;
 		for (pGroup = pSL->getScriptGroup(); pGroup; pGroup=pGroup->getNext()) {
+			m_scriptGroupIndex.insert(ScriptGroupNameMap::value_type(NAMEKEY(pGroup->getName()), pGroup));
 			for (pScr = pGroup->getScript(); pScr; pScr=pScr->getNext()) {
-				if ((name==pScr->getName())) {
-					return pScr;
-				}
+				m_scriptIndex.insert(ScriptNameMap::value_type(NAMEKEY(pScr->getName()), pScr));
 			}
 		}
 	}
-	return 0; // Shouldn't ever happen.
+	m_scriptIndexBuilt = true;
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -5648,6 +5712,7 @@ void ScriptEngine::setCounter( ScriptAction *pAction )
 	}
 	Int value = pAction->getParameter(1)->getInt();
 	m_counters[counterNdx].value = value;
+	touchCounter(counterNdx);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -5716,6 +5781,7 @@ void ScriptEngine::addCounter( ScriptAction *pAction )
 		pAction->getParameter(1)->friend_setInt(counterNdx);
 	}
 	m_counters[counterNdx].value += value;
+	touchCounter(counterNdx);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -5731,6 +5797,7 @@ void ScriptEngine::subCounter( ScriptAction *pAction )
 		pAction->getParameter(1)->friend_setInt(counterNdx);
 	}
 	m_counters[counterNdx].value -= value;
+	touchCounter(counterNdx);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -5775,6 +5842,7 @@ void ScriptEngine::setFlag( ScriptAction *pAction )
 	}
 	Bool value = pAction->getParameter(1)->getInt();
 	m_flags[flagNdx].value = value;
+	touchFlag(flagNdx);
 }
 
 
@@ -6037,6 +6105,7 @@ void ScriptEngine::setTimer( ScriptAction *pAction, Bool millisecondTimer, Bool
 		m_counters[counterNdx].value = value;
 	}
 	m_counters[counterNdx].isCountdownTimer = true;
+	touchCounter(counterNdx);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -6051,6 +6120,7 @@ void ScriptEngine::pauseTimer( ScriptAction *pAction )
 		pAction->getParameter(0)->friend_setInt(counterNdx);
 	}
 	m_counters[counterNdx].isCountdownTimer = false;
+	touchCounter(counterNdx);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -6066,6 +6136,7 @@ void ScriptEngine::restartTimer( ScriptAction *pAction )
 	}
 	if (m_counters[counterNdx].value > 0) {
 		m_counters[counterNdx].isCountdownTimer = true;
+		touchCounter(counterNdx);
 	}
 }
 
@@ -6091,6 +6162,7 @@ void ScriptEngine::adjustTimer( ScriptAction *pAction, Bool millisecondTimer, Bo
 			value = -value;
 		m_counters[counterNdx].value += value;
 	}
+	touchCounter(counterNdx);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -6335,6 +6407,31 @@ void ScriptEngine::executeScript( Script *pScript )
 /** Evaluates a condition */
 //-------------------------------------------------------------------------------------------------
 Bool ScriptEngine::evaluateCondition( Condition *pCondition )
+{
+	++m_conditionEvaluations;
+#ifdef DEBUG_LOGGING
+	++m_conditionEvaluationsByType[pCondition->getConditionType()];
+#endif
+	Int eventMask = getConditionEventMask(pCondition);
+	if (eventMask != 0 && isConditionCacheValid(pCondition, eventMask)) {
+		++m_conditionEvaluationsSkipped;
+#ifdef DEBUG_LOGGING
+		++m_conditionEvaluationsSkippedByType[pCondition->getConditionType()];
+#endif
+		return pCondition->getCachedValue();
+	}
+	Bool value = evaluateConditionUncached(pCondition);
+	if (eventMask != 0) {
+		// Any event fired after this point gets a higher serial, and invalidates the result.
+		pCondition->setCachedValue(value, m_scriptEventSerial);
+	}
+	return value;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Evaluates a condition, ignoring any cached result. */
+//-------------------------------------------------------------------------------------------------
+Bool ScriptEngine::evaluateConditionUncached( Condition *pCondition )
 {
 	switch (pCondition->getConditionType()) {
 		default: 
@@ -6347,6 +6444,119 @@ Bool ScriptEngine::evaluateCondition( Condition *pCondition )
 	}
 }
 
+//-------------------------------------------------------------------------------------------------
+/** Returns the script events a condition depends on, as a mask of (1<<ScriptEventType).  
+		0 means the condition depends on state we don't track, and has to be evaluated every time. */
+//-------------------------------------------------------------------------------------------------
+Int ScriptEngine::getConditionEventMask( Condition *pCondition )
+{
+	Int mask = pCondition->getEventMask();
+	if (mask != -1) {
+		return mask;
+	}
+
+	const Int objectCountMask = (1<<SCRIPT_EVENT_OBJECT_COUNT) | (1<<SCRIPT_EVENT_TEAM_MEMBERSHIP) | (1<<SCRIPT_EVENT_OBJECT_TYPES);
+	switch (pCondition->getConditionType()) {
+		default:																		mask = 0; break;
+		case Condition::COUNTER:										mask = (1<<SCRIPT_EVENT_COUNTER); break;
+		case Condition::TIMER_EXPIRED:							mask = (1<<SCRIPT_EVENT_TIMER); break;
+		case Condition::FLAG:												mask = (1<<SCRIPT_EVENT_FLAG) | (1<<SCRIPT_EVENT_UI_INTERACTION); break;
+		case Condition::PLAYER_HAS_CREDITS:					mask = (1<<SCRIPT_EVENT_CREDITS); break;
+		case Condition::PLAYER_ALL_DESTROYED:				mask = (1<<SCRIPT_EVENT_OBJECT_COUNT) | (1<<SCRIPT_EVENT_TEAM_MEMBERSHIP); break;
+		case Condition::BUILT_BY_PLAYER:						mask = objectCountMask; break;
+		case Condition::PLAYER_HAS_OBJECT_COMPARISON: mask = objectCountMask; break;
+		case Condition::PLAYER_HAS_COMPARISON_UNIT_TYPE_IN_TRIGGER_AREA:
+		case Condition::PLAYER_HAS_COMPARISON_UNIT_KIND_IN_TRIGGER_AREA:
+			mask = objectCountMask | (1<<SCRIPT_EVENT_AREA_OCCUPANCY); 
+			break;
+	}
+
+	// Parameters like <This Team> or [Skirmish]EnemyInnerPerimeter resolve against whoever is 
+	// running the script, so the same condition can give different answers without any event.
+	// <This Player> is always the side that owns the script, and <Local Player> never changes.
+	Int i;
+	for (i=0; mask != 0 && i<pCondition->getNumParameters(); i++) {
+		const AsciiString& str = pCondition->getParameter(i)->getString();
+		if (str == THIS_PLAYER || str == LOCAL_PLAYER) {
+			continue;
+		}
+		if (str.startsWith("<") || str.startsWith("[Skirmish]")) {
+			mask = 0;
+		}
+	}
+
+	pCondition->setEventMask(mask);
+	return mask;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Returns true if nothing pCondition depends on has changed since its result was cached. */
+//-------------------------------------------------------------------------------------------------
+Bool ScriptEngine::isConditionCacheValid( Condition *pCondition, Int eventMask )
+{
+	UnsignedInt serial = pCondition->getEvalSerial();
+	if (serial == 0 || serial < m_conditionCacheResetSerial) {
+		return false;
+	}
+
+	Int i;
+	for (i=0; i<SCRIPT_EVENT_COUNT; i++) {
+		if ((eventMask & (1<<i)) == 0) {
+			continue;
+		}
+		UnsignedInt eventSerial;
+		if (i == SCRIPT_EVENT_COUNTER || i == SCRIPT_EVENT_TIMER || i == SCRIPT_EVENT_FLAG) {
+			// Keyed events.  The index is allocated on first evaluation, so it is set by now.
+			Int ndx = pCondition->getParameter(0)->getInt();
+			if (ndx <= 0) {
+				return false;
+			}
+			if (i == SCRIPT_EVENT_FLAG) {
+				eventSerial = m_flagSerials[ndx];
+			} else if (i == SCRIPT_EVENT_TIMER) {
+				eventSerial = m_timerSerials[ndx];
+			} else {
+				eventSerial = m_counterSerials[ndx];
+			}
+		} else {
+			eventSerial = m_scriptEventSerials[i];
+		}
+		if (eventSerial > serial) {
+			return false;
+		}
+	}
+	return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Throws away all cached condition results. */
+//-------------------------------------------------------------------------------------------------
+void ScriptEngine::invalidateConditionCache( void )
+{
+	m_conditionCacheResetSerial = ++m_scriptEventSerial;
+	Int i;
+	for (i=0; i<SCRIPT_EVENT_COUNT; i++) {
+		m_scriptEventSerials[i] = m_conditionCacheResetSerial;
+	}
+	for (i=0; i<MAX_COUNTERS; i++) {
+		m_counterSerials[i] = m_conditionCacheResetSerial;
+		m_timerSerials[i] = m_conditionCacheResetSerial;
+	}
+	for (i=0; i<MAX_FLAGS; i++) {
+		m_flagSerials[i] = m_conditionCacheResetSerial;
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Returns the number of conditions evaluated since the last reset, and how many of those
+		were answered from the cache. */
+//-------------------------------------------------------------------------------------------------
+void ScriptEngine::getConditionEvaluationStats(UnsignedInt *evaluated, UnsignedInt *skipped) const
+{
+	*evaluated = m_conditionEvaluations;
+	*skipped = m_conditionEvaluationsSkipped;
+}
+
 //-------------------------------------------------------------------------------------------------
 /** Execute an action specified by pActionHead */
 //-------------------------------------------------------------------------------------------------
@@ -6379,35 +6589,97 @@ void ScriptEngine::addObjectToCache(Object* pNewObject)
 		return;
 	}
 
-	for (VecNamedRequestsIt it = m_namedObjects.begin(); it != m_namedObjects.end(); ++it) {
-		if (it->first == objName) {
-			if (it->second == NULL) {
-				AsciiString newNameForDead;
-				newNameForDead.format("Reassigning dead object's name '%s' to object (%d) of type '%s'\n", objName.str(), pNewObject->getID(), pNewObject->getTemplate()->getName().str());
-				TheScriptEngine->AppendDebugMessage(newNameForDead, FALSE);
-				DEBUG_LOG((newNameForDead.str()));
-				it->second = pNewObject;
-				return;
-			} else {
-				DEBUG_CRASH(("Attempting to assign the name '%s' to object (%d) of type '%s'," 
-										 " but object (%d) of type '%s' already has that name\n",
-										 objName.str(), pNewObject->getID(), pNewObject->getTemplate()->getName().str(), 
-										 it->second->getID(), it->second->getTemplate()->getName().str()));
-				return;
-			}
+	// The old linear search took whichever of the name match and the object match came first.
+	NameKeyType nameKey = NAMEKEY(objName);
+	NameKeyIndexMap::const_iterator nameIt = m_namedObjectIndex.find(nameKey);
+	ObjectIndexMap::const_iterator ptrIt = m_namedObjectPtrIndex.find(pNewObject);
+	Int nameNdx = (nameIt != m_namedObjectIndex.end()) ? nameIt->second : -1;
+	Int ptrNdx = (ptrIt != m_namedObjectPtrIndex.end()) ? ptrIt->second : -1;
+
+	if (nameNdx >= 0 && (ptrNdx < 0 || nameNdx <= ptrNdx)) {
+		NamedRequest &req = m_namedObjects[nameNdx];
+		if (req.second == NULL) {
+			AsciiString newNameForDead;
+			newNameForDead.format("Reassigning dead object's name '%s' to object (%d) of type '%s'\n", objName.str(), pNewObject->getID(), pNewObject->getTemplate()->getName().str());
+			TheScriptEngine->AppendDebugMessage(newNameForDead, FALSE);
+			DEBUG_LOG((newNameForDead.str()));
+			req.second = pNewObject;
+			m_namedObjectPtrIndex[pNewObject] = nameNdx;
+			return;
+		} else {
+			DEBUG_CRASH(("Attempting to assign the name '%s' to object (%d) of type '%s'," 
+									 " but object (%d) of type '%s' already has that name\n",
+									 objName.str(), pNewObject->getID(), pNewObject->getTemplate()->getName().str(), 
+									 req.second->getID(), req.second->getTemplate()->getName().str()));
+			return;
 		}
+	}
 
-		if (pNewObject == (it->second)) {
-			it->first = objName;
-			return;
+	if (ptrNdx >= 0) {
+		// Renamed.
+		NamedRequest &req = m_namedObjects[ptrNdx];
+		NameKeyType oldKey = NAMEKEY(req.first);
+		NameKeyIndexMap::iterator oldIt = m_namedObjectIndex.find(oldKey);
+		if (oldIt != m_namedObjectIndex.end() && oldIt->second == ptrNdx) {
+			// Lookups of the old name now find the next entry that still has it, if any.
+			m_namedObjectIndex.erase(oldIt);
+			for (Int i = ptrNdx + 1; i < (Int)m_namedObjects.size(); ++i) {
+				if (m_namedObjects[i].first == req.first) {
+					m_namedObjectIndex[oldKey] = i;
+					break;
+				}
+			}
 		}
+		req.first = objName;
+		// Any other entry with the new name comes after this one, so lookups should find this one now.
+		m_namedObjectIndex[nameKey] = ptrNdx;
+		return;
 	}
 
+	addNamedObjectEntry(objName, pNewObject);
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Appends an entry to the named object cache and indexes it. */
+//-------------------------------------------------------------------------------------------------
+void ScriptEngine::addNamedObjectEntry(const AsciiString& name, Object *obj)
+{
 	NamedRequest req;
-	req.first = objName;
-	req.second = pNewObject;
+	req.first = name;
+	req.second = obj;
 
+	Int ndx = m_namedObjects.size();
 	m_namedObjects.push_back(req);
+	// If a name is in the list twice, lookups find the first one.
+	m_namedObjectIndex.insert(NameKeyIndexMap::value_type(NAMEKEY(name), ndx));
+	if (obj) {
+		m_namedObjectPtrIndex.insert(ObjectIndexMap::value_type(obj, ndx));
+	}
+}
+
+//-------------------------------------------------------------------------------------------------
+/** Rebuilds the name lookups from m_namedObjects, m_counters and m_flags, after a load. */
+//-------------------------------------------------------------------------------------------------
+void ScriptEngine::rebuildNameIndexes(void)
+{
+	m_namedObjectIndex.clear();
+	m_namedObjectPtrIndex.clear();
+	Int i;
+	for (i=0; i<(Int)m_namedObjects.size(); i++) {
+		m_namedObjectIndex.insert(NameKeyIndexMap::value_type(NAMEKEY(m_namedObjects[i].first), i));
+		if (m_namedObjects[i].second) {
+			m_namedObjectPtrIndex.insert(ObjectIndexMap::value_type(m_namedObjects[i].second, i));
+		}
+	}
+
+	m_counterIndex.clear();
+	for (i=1; i<m_numCounters; i++) {
+		m_counterIndex.insert(NameKeyIndexMap::value_type(NAMEKEY(m_counters[i].name), i));
+	}
+	m_flagIndex.clear();
+	for (i=1; i<m_numFlags; i++) {
+		m_flagIndex.insert(NameKeyIndexMap::value_type(NAMEKEY(m_flags[i].name), i));
+	}
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -6415,11 +6687,10 @@ void ScriptEngine::addObjectToCache(Object* pNewObject)
 //-------------------------------------------------------------------------------------------------
 void ScriptEngine::removeObjectFromCache( Object* pDeadObject )
 {
-	for (VecNamedRequestsIt it = m_namedObjects.begin(); it != m_namedObjects.end(); ++it) {
-		if (pDeadObject == (it->second)) {
-			it->second = NULL;	// Don't remove it, cause we want to check whether we ever knew a name later
-			break;
-		}
+	ObjectIndexMap::iterator it = m_namedObjectPtrIndex.find(pDeadObject);
+	if (it != m_namedObjectPtrIndex.end()) {
+		m_namedObjects[it->second].second = NULL;	// Don't remove it, cause we want to check whether we ever knew a name later
+		m_namedObjectPtrIndex.erase(it);
 	}
 }
 
@@ -6448,26 +6719,25 @@ void ScriptEngine::transferObjectName( const AsciiString& unitName, Object *pNew
 
 	pNewObject->setName(unitName); // make sure it's named the name.
 
-	//Loop through the cached list and find the string entry. If found, change the object
-	//so it's pointing to the new one.
-	for( VecNamedRequestsIt it = m_namedObjects.begin(); it != m_namedObjects.end(); ++it )
+	//Find the string entry in the cache. If found, change the object so it's pointing to the new one.
+	NameKeyIndexMap::const_iterator ndxIt = m_namedObjectIndex.find( NAMEKEY( unitName ) );
+	if( ndxIt != m_namedObjectIndex.end() )
 	{
-		if( !unitName.compare( it->first ) )
+		NamedRequest &req = m_namedObjects[ ndxIt->second ];
+		Object* pOldObj = req.second;
+		if( pOldObj )
 		{
-			Object* pOldObj = it->second;
-			if( pOldObj )
-			{
-				// if you are transferring your name, you should also transfer any custom indicator color you have.
-				if (pOldObj->hasCustomIndicatorColor())
-					pNewObject->setCustomIndicatorColor(pOldObj->getIndicatorColor());
-				else
-					pNewObject->removeCustomIndicatorColor();
-			}
-
-			it->second = pNewObject;
+			// if you are transferring your name, you should also transfer any custom indicator color you have.
+			if (pOldObj->hasCustomIndicatorColor())
+				pNewObject->setCustomIndicatorColor(pOldObj->getIndicatorColor());
+			else
+				pNewObject->removeCustomIndicatorColor();
 
-			return;
+			m_namedObjectPtrIndex.erase( pOldObj );
 		}
+
+		req.second = pNewObject;
+		m_namedObjectPtrIndex[ pNewObject ] = ndxIt->second;
 	}
 
 }
@@ -6544,6 +6814,7 @@ void ScriptEngine::notifyOfAcquiredScience( Int playerIndex, ScienceType science
 void ScriptEngine::signalUIInteract(const AsciiString& hookName)
 {
 	m_uiInteractions.push_front(hookName);
+	notifyOfScriptEvent(SCRIPT_EVENT_UI_INTERACTION);
 #ifdef DEBUG_LOGGING
 	AppendDebugMessage(hookName, false); // don't bother in Release
 #endif
@@ -6995,6 +7266,8 @@ const ConditionTemplate * ScriptEngine::getConditionTemplate( Int ndx )
 void ScriptEngine::createNamedCache( void )
 {
 	m_namedObjects.clear();
+	m_namedObjectIndex.clear();
+	m_namedObjectPtrIndex.clear();
 
 	if( !TheGameLogic )
 	{
@@ -7004,10 +7277,7 @@ void ScriptEngine::createNamedCache( void )
 
 	while (pObj) {
 		if (!pObj->getName().isEmpty()) {
-			NamedRequest req;
-			req.first = pObj->getName();
-			req.second = pObj;
-			m_namedObjects.push_back(req);
+			addNamedObjectEntry(pObj->getName(), pObj);
 		}
 		pObj = pObj->getNextObject();
 	}
@@ -7085,6 +7355,7 @@ void ScriptEngine::removeAllSequentialScripts(Team *team)
 void ScriptEngine::notifyOfObjectCreationOrDestruction(void)
 {
 	m_frameObjectCountChanged = TheGameLogic->getFrame();
+	notifyOfScriptEvent(SCRIPT_EVENT_OBJECT_COUNT);
 }
 
 void ScriptEngine::notifyOfTeamDestruction(Team *teamDestroyed)
@@ -8305,6 +8576,9 @@ void ScriptEngine::xfer( Xfer *xfer )
 
 		}  // end for, i
 
+		// counters, flags and named objects are all loaded now
+		rebuildNameIndexes();
+
 	}  // end else, load
 
 	// first update
@@ -8594,6 +8868,9 @@ void ScriptEngine::xfer( Xfer *xfer )
 void ScriptEngine::loadPostProcess( void )
 {
 
+	// Cached condition results predate the load.
+	invalidateConditionCache();
+
 	// Now that we've loaded everything, go through and set them all back in sync with what we
 	// currently think they should be.
 	TheScriptActions->doEnableOrDisableObjectDifficultyBonuses(m_objectsShouldReceiveDifficultyBonus);
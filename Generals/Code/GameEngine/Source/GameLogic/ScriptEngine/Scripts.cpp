@@ -1507,7 +1507,10 @@ m_conditionType(CONDITION_FALSE),
 m_hasWarnings(false),
 m_customData(0),
 m_numParms(0),
-m_nextAndCondition(NULL)
+m_nextAndCondition(NULL),
+m_eventMask(-1),
+m_evalSerial(0),
+m_cachedValue(false)
 {
 	Int i;
 	for (i = 0; i < MAX_PARMS; i++) 
@@ -1518,7 +1521,10 @@ m_nextAndCondition(NULL)
 
 Condition::Condition(enum ConditionType type):
 m_conditionType(type),
-m_numParms(0)
+m_numParms(0),
+m_eventMask(-1),
+m_evalSerial(0),
+m_cachedValue(false)
 {
 	Int i;
 	for (i=0; i<MAX_PARMS; i++) {
@@ -1536,6 +1542,8 @@ void Condition::setConditionType(enum ConditionType type)
 		m_parms[i] = NULL;
 	}
 	m_conditionType = type;
+	m_eventMask = -1;
+	m_evalSerial = 0;
 	const ConditionTemplate *pTemplate = TheScriptEngine->getConditionTemplate(m_conditionType);
 	m_numParms = pTemplate->getNumParameters();
 	for (i=0; i<m_numParms; i++) {
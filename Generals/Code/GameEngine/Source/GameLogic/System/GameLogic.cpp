@@ -34,6 +34,7 @@
 #include "Common/BuildAssistant.h"
 #include "Common/CopyProtection.h"
 #include "Common/CRCDebug.h"
+#include "Common/FrameProfiler.h"
 #include "Common/GameAudio.h"
 #include "Common/GameEngine.h"
 #include "Common/GameState.h"
@@ -236,6 +237,7 @@ GameLogic::GameLogic( void )
 	m_height = 0;
 	m_objList = NULL;
 	m_curUpdateModule = NULL;
+	m_updateModuleStatsFirstFrame = 0;
 	m_nextObjID = INVALID_ID;
 	m_startNewGame = FALSE;
 	m_gameMode = GAME_NONE;
@@ -435,6 +437,8 @@ void GameLogic::reset( void )
 
 	m_frameObjectsChangedTriggerAreas = 0;
 
+	resetUpdateModuleStats();
+
 	TheGhostObjectManager->reset();
 	ThePartitionManager->reset();
 	TheTerrainLogic->reset();
@@ -2150,6 +2154,7 @@ void GameLogic::loadMapINI( AsciiString mapName )
 void GameLogic::processDestroyList( void )
 {
 	//USE_PERF_TIMER(processDestroyList)
+	PROFILE_ZONE("GameLogic::processDestroyList");
 
 	for( ObjectPointerListIterator iterator = m_objectsToDestroy.begin(); iterator != m_objectsToDestroy.end(); iterator++ )
 	{
@@ -2717,6 +2722,93 @@ void GameLogic::friend_awakenUpdateModule(Object* obj, UpdateModulePtr u, Unsign
 	}
 }
 
+// ------------------------------------------------------------------------------------------------
+/** Accumulate one update() call into the stats for its module class.  The module name key
+		is the class name (see MAKE_STANDARD_MODULE_MACRO), so every instance of a class shares
+		one entry. */
+// ------------------------------------------------------------------------------------------------
+void GameLogic::recordUpdateModuleStats(UpdateModulePtr u, Int64 elapsedNS, UnsignedInt sleepFrames)
+{
+	if (m_updateModuleStats.empty())
+		m_updateModuleStatsFirstFrame = m_frame;
+
+	UpdateModuleStats &stats = m_updateModuleStats[u->getModuleNameKey()];
+	++stats.m_calls;
+	stats.m_totalNS += elapsedNS;
+	if (elapsedNS > stats.m_peakNS)
+		stats.m_peakNS = elapsedNS;
+
+	if (sleepFrames >= UPDATE_SLEEP_FOREVER)
+	{
+		++stats.m_sleepForeverCalls;
+	}
+	else
+	{
+		++stats.m_sleepCalls;
+		stats.m_totalSleepFrames += sleepFrames;
+	}
+}
+
+// ------------------------------------------------------------------------------------------------
+// ------------------------------------------------------------------------------------------------
+void GameLogic::resetUpdateModuleStats( void )
+{
+	m_updateModuleStats.clear();
+	m_updateModuleStatsFirstFrame = m_frame;
+}
+
+// ------------------------------------------------------------------------------------------------
+/** Write the gathered update costs, most expensive module class first. */
+// ------------------------------------------------------------------------------------------------
+void GameLogic::dumpUpdateModuleStats( const char *filename )
+{
+	if (m_updateModuleStats.empty())
+		return;
+
+	FILE *fp = fopen(filename, "w");
+	if (fp == NULL)
+	{
+		DEBUG_LOG(("dumpUpdateModuleStats - couldn't open %s\n", filename));
+		return;
+	}
+
+	typedef std::pair<Int64, NameKeyType> CostKeyPair;
+	std::vector<CostKeyPair> sorted;
+	sorted.reserve(m_updateModuleStats.size());
+	for (UpdateModuleStatsMap::const_iterator it = m_updateModuleStats.begin(); it != m_updateModuleStats.end(); ++it)
+		sorted.push_back(CostKeyPair(it->second.m_totalNS, it->first));
+	std::sort(sorted.begin(), sorted.end(), std::greater<CostKeyPair>());
+
+	UnsignedInt numFrames = max((UnsignedInt)1, m_frame - m_updateModuleStatsFirstFrame);
+	Int64 grandTotalNS = 0;
+	for (std::vector<CostKeyPair>::const_iterator it = sorted.begin(); it != sorted.end(); ++it)
+		grandTotalNS += it->first;
+
+	fprintf(fp, "Update module costs for frames %u to %u (%u frames, %.3f ms total)\n\n",
+		m_updateModuleStatsFirstFrame, m_frame, numFrames, grandTotalNS / 1000000.0);
+	fprintf(fp, "%-40s %10s %10s %6s %10s %10s %10s %10s %10s\n",
+		"Module", "Calls", "Total ms", "%", "ms/frame", "Avg us", "Peak us", "Avg sleep", "Forever");
+
+	for (std::vector<CostKeyPair>::const_iterator it = sorted.begin(); it != sorted.end(); ++it)
+	{
+		const UpdateModuleStats &stats = m_updateModuleStats[it->second];
+		AsciiString name = TheNameKeyGenerator->keyToName(it->second);
+		fprintf(fp, "%-40s %10u %10.3f %6.2f %10.4f %10.2f %10.2f %10.2f %10u\n",
+			name.str(),
+			stats.m_calls,
+			stats.m_totalNS / 1000000.0,
+			grandTotalNS ? 100.0 * stats.m_totalNS / grandTotalNS : 0.0,
+			stats.m_totalNS / 1000000.0 / numFrames,
+			stats.m_calls ? stats.m_totalNS / 1000.0 / stats.m_calls : 0.0,
+			stats.m_peakNS / 1000.0,
+			stats.m_sleepCalls ? (double)stats.m_totalSleepFrames / stats.m_sleepCalls : 0.0,
+			stats.m_sleepForeverCalls);
+	}
+
+	fclose(fp);
+	DEBUG_LOG(("dumpUpdateModuleStats - wrote %d module classes to %s\n", sorted.size(), filename));
+}
+
 // ------------------------------------------------------------------------------------------------
 #ifdef DO_UNIT_TIMINGS
 	enum {TIME_FRAMES=100};
@@ -3046,6 +3138,9 @@ void GameLogic::update( void )
 {
 	USE_PERF_TIMER(GameLogic_update)
 
+	FrameProfiler::onFrame(m_frame);
+	PROFILE_ZONE("GameLogic::update");
+
 	LatchRestore<Bool> inUpdateLatch(m_isInUpdate, TRUE);
 #ifdef DO_UNIT_TIMINGS
 	unitTimings();
@@ -3110,6 +3205,7 @@ void GameLogic::update( void )
 	// Note - TerrainLogic update needs to happen after ScriptEngine update, but before object updates.  jba.
 	// This way changes in bridges are noted in the script engine before being cleared in TerrainLogic->update
 	{
+		PROFILE_ZONE("TerrainLogic::update");
 		TheTerrainLogic->UPDATE();
 	}
 
@@ -3128,6 +3224,7 @@ void GameLogic::update( void )
 
 	if (generateForSolo || generateForMP)
 	{
+		PROFILE_ZONE("GameLogic::getCRC");
 		m_CRC = getCRC( CRC_RECALC );
 		if (isMPGameOrReplay)
 		{
@@ -3158,6 +3255,7 @@ void GameLogic::update( void )
 
 	// process client commands
 	{
+		PROFILE_ZONE("GameLogic::processCommandList");
 		processCommandList( TheCommandList );
 	}
 
@@ -3170,8 +3268,10 @@ void GameLogic::update( void )
 			if (!dis.any() || dis.anyIntersectionWith(u->getDisabledTypesToProcess()))
 			{
 				USE_PERF_TIMER(GameLogic_update_normal)
+				FrameProfileZone moduleZone(FrameProfiler::isCapturing() ? FrameProfiler::getKeyName(u->getModuleNameKey()) : NULL);
 
 				m_curUpdateModule = u;
+				Int64 statsStartNS = TheGlobalData->m_updateModuleStats ? FrameProfiler::getTimeNS() : 0;
 
 				#ifdef DEBUG_LOGGING
 					UpdateSleepTime sleep = u->update();
@@ -3180,6 +3280,9 @@ void GameLogic::update( void )
 					u->update();
 				#endif
 
+				if (statsStartNS != 0)
+					recordUpdateModuleStats(u, FrameProfiler::getTimeNS() - statsStartNS, UPDATE_SLEEP_NONE);
+
 				m_curUpdateModule = NULL;
 			}
 		}
@@ -3187,6 +3290,7 @@ void GameLogic::update( void )
 #endif
 
 	{
+		PROFILE_ZONE("GameLogic::updateModules");
 		while (!m_sleepyUpdates.empty())
 		{
 			UpdateModulePtr u = peekSleepyUpdate();
@@ -3210,15 +3314,20 @@ void GameLogic::update( void )
 			if (!dis.any() || dis.anyIntersectionWith(u->getDisabledTypesToProcess()))
 			{
 				USE_PERF_TIMER(GameLogic_update_sleepy)
+				FrameProfileZone moduleZone(FrameProfiler::isCapturing() ? FrameProfiler::getKeyName(u->getModuleNameKey()) : NULL);
 
 				//DEBUG_LOG(("calling update %08lx (%d %d)... ",update,update->friend_getNextCallFrame(),update->friend_getNextCallPhase()));
 				m_curUpdateModule = u;
+				Int64 statsStartNS = TheGlobalData->m_updateModuleStats ? FrameProfiler::getTimeNS() : 0;
 
 				sleepLen = u->update();
 				DEBUG_ASSERTCRASH(sleepLen > 0, ("you may not return 0 from update"));
 				if (sleepLen < 1) 
 					sleepLen = UPDATE_SLEEP_NONE;
 
+				if (statsStartNS != 0)
+					recordUpdateModuleStats(u, FrameProfiler::getTimeNS() - statsStartNS, sleepLen);
+
 				m_curUpdateModule = NULL;
 
 			}
@@ -3233,6 +3342,7 @@ void GameLogic::update( void )
 
 	// update the Artificial Intelligence system
 	{
+		PROFILE_ZONE("AI::update");
 		TheAI->UPDATE();
 	}
 
@@ -3432,6 +3542,8 @@ void GameLogic::destroyObject( Object *obj )
 
 	// mark object as destroyed
 	obj->setStatus( OBJECT_STATUS_DESTROYED );
+	if (!obj->isKindOf(KINDOF_PROJECTILE) && !obj->isKindOf(KINDOF_INERT))
+		TheScriptEngine->notifyOfScriptEvent(ScriptEngine::SCRIPT_EVENT_OBJECT_COUNT);
 
 	// We desperately need to stop here, or else the destructor of the statemachine will try to do
 	// stopping logic, which uses virtual functions and deleted modules, which will crash us.
@@ -259,6 +259,9 @@ void GameLogic::clearGameData( Bool showScoreScreen )
 	if(TheStatsCollector)
 		TheStatsCollector->writeFileEnd();
 
+	if (TheGlobalData->m_updateModuleStats)
+		dumpUpdateModuleStats("UpdateModuleStats.txt");
+
 	TheScriptActions->closeWindows(FALSE); // Close victory or defeat windows.
 
 	Bool shellGame = FALSE;
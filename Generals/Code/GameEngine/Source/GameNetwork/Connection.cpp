@@ -31,6 +31,21 @@
 
 enum { MaxQuitFlushTime = 30000 }; // wait this many milliseconds at most to retry things before quitting
 
+/**
+ * Send rate and burst size in bytes for each send class.  A rate of 0 means the class is never
+ * held back.  File data gets a window's worth of burst so the wrapper window still fills up.
+ */
+static const struct {
+	Int rate;
+	Int burst;
+} SendClassLimits[CONNECTION_SEND_CLASS_COUNT] = {
+	{ 0, 0 },	// CONNECTION_SEND_FRAME
+	{ 0, 0 },	// CONNECTION_SEND_ACK
+	{ 0, 0 },	// CONNECTION_SEND_CONTROL
+	{ 1024, 2048 },	// CONNECTION_SEND_CHAT
+	{ 256 * 1024, CONNECTION_WRAPPER_WINDOW * MAX_PACKET_SIZE },	// CONNECTION_SEND_FILE
+};
+
 /**
  * The constructor.
  */
@@ -89,8 +104,23 @@ void Connection::init() {
 	m_lastTimeSent = 0;
 	m_frameGrouping = 1;
 	m_numRetries = 0;
+	m_lastNumRetries = 0;
+	m_numGapResends = 0;
+	m_numRedundantSends = 0;
 	m_retryMetricsTime = 0;
 
+	m_lastBucketRefill = timeGetTime();
+	for (Int i = 0; i < CONNECTION_SEND_CLASS_COUNT; ++i) {
+		m_sendBuckets[i].m_rate = SendClassLimits[i].rate;
+		m_sendBuckets[i].m_burst = SendClassLimits[i].burst;
+		m_sendBuckets[i].m_tokens = SendClassLimits[i].burst;
+	}
+	resetSendClassMetrics();
+	for (Int i = 0; i < CONNECTION_SEND_CLASS_COUNT; ++i) {
+		m_totalAcksReceived[i] = 0;
+		m_totalAckLatency[i] = 0.0f;
+	}
+
 	for (Int i = 0; i < CONNECTION_LATENCY_HISTORY_LENGTH; ++i) {
 		m_latencies[i] = 0;
 	}
@@ -143,60 +173,39 @@ User * Connection::getUser() {
  * The relay mostly has to do with the packet router.
  */
 void Connection::sendNetCommandMsg(NetCommandMsg *msg, UnsignedByte relay) {
-	static NetPacket *packet = NULL;
+	if (m_isQuitting)
+		return;
 
-	// this is done so we don't have to allocate and delete a packet every time we send a message.
-	if (packet == NULL) {
-		packet = newInstance(NetPacket);
+	NetCommandList *wrappedCommands = splitNetCommandMsg(msg);
+	sendNetCommandMsg(msg, relay, wrappedCommands);
+	if (wrappedCommands != NULL) {
+		wrappedCommands->deleteInstance();
+		wrappedCommands = NULL;
 	}
+}
 
-
+/**
+ * Add this network command to the send queue for this connection, using wrapper commands that
+ * have already been made for it by splitNetCommandMsg.  If wrappedCommands is NULL the command
+ * fit in a single packet and is queued as is.  The same wrapper commands can be passed to any
+ * number of connections, so a command going to several players only gets split up once.
+ */
+void Connection::sendNetCommandMsg(NetCommandMsg *msg, UnsignedByte relay, NetCommandList *wrappedCommands) {
 	if (m_isQuitting)
 		return;
 
 	if (m_netCommandList != NULL) {
-		// check to see if this command will fit in a packet.  If not, we need to split it up.
-		// we are splitting up the command here so that the retry logic will not try to 
-		// resend the ENTIRE command (i.e. multiple packets work of data) and only do the retry
-		// one wrapper command at a time.
-		packet->reset();
-
-		NetCommandRef *tempref = NEW_NETCOMMANDREF(msg);
-
-		Bool msgFits = packet->addCommand(tempref);
-		tempref->deleteInstance(); // delete the temporary reference.
-		tempref = NULL;
-
-		if (!msgFits) {
-			NetCommandRef *origref = NEW_NETCOMMANDREF(msg);
-			origref->setRelay(relay);
-			// the message doesn't fit in a single packet, need to split it up.
-			NetPacketList packetList = NetPacket::ConstructBigCommandPacketList(origref);
-			NetPacketListIter tempPacketPtr = packetList.begin();
-
-			while (tempPacketPtr != packetList.end()) {
-				NetPacket *tempPacket = (*tempPacketPtr);
-
-				NetCommandList *list = tempPacket->getCommandList();
-				NetCommandRef *ref1 = list->getFirstMessage();
-				while (ref1 != NULL) {
-					NetCommandRef *ref2 = m_netCommandList->addMessage(ref1->getCommand());
+		if (wrappedCommands != NULL) {
+			NetCommandRef *ref1 = wrappedCommands->getFirstMessage();
+			while (ref1 != NULL) {
+				NetCommandRef *ref2 = m_netCommandList->addMessage(ref1->getCommand());
+				if (ref2 != NULL) {
 					ref2->setRelay(relay);
-
-					ref1 = ref1->getNext();
+					ref2->setSendClass(ref1->getSendClass());
 				}
 
-				tempPacket->deleteInstance();
-				tempPacket = NULL;
-				++tempPacketPtr;
-
-				list->deleteInstance();
-				list = NULL;
+				ref1 = ref1->getNext();
 			}
-
-			origref->deleteInstance();
-			origref = NULL;
-
 			return;
 		}
 
@@ -221,6 +230,76 @@ void Connection::sendNetCommandMsg(NetCommandMsg *msg, UnsignedByte relay) {
 	}
 }
 
+/**
+ * Check to see if this command will fit in a packet.  If not, split it up into wrapper commands
+ * and return them, otherwise return NULL.
+ * We are splitting up the command here so that the retry logic will not try to
+ * resend the ENTIRE command (i.e. multiple packets work of data) and only do the retry
+ * one wrapper command at a time.
+ * The caller owns the returned list.
+ */
+NetCommandList * Connection::splitNetCommandMsg(NetCommandMsg *msg) {
+	static NetPacket *packet = NULL;
+
+	// this is done so we don't have to allocate and delete a packet every time we send a message.
+	if (packet == NULL) {
+		packet = newInstance(NetPacket);
+	}
+
+	packet->reset();
+
+	NetCommandRef *tempref = NEW_NETCOMMANDREF(msg);
+
+	Bool msgFits = packet->addCommand(tempref);
+	tempref->deleteInstance(); // delete the temporary reference.
+	tempref = NULL;
+
+	if (msgFits) {
+		return NULL;
+	}
+
+	NetCommandList *wrappedCommands = newInstance(NetCommandList);
+	wrappedCommands->init();
+
+	// the wrappers go out in the send class of the command they carry, so a big game command
+	// isn't held back with the map transfers.
+	ConnectionSendClass sendClass = getSendClass(msg);
+
+	// The relay packed in with the wrapped data isn't used by the receiver, each wrapper
+	// carries its own.
+	NetCommandRef *origref = NEW_NETCOMMANDREF(msg);
+	origref->setRelay(0xff);
+	// the message doesn't fit in a single packet, need to split it up.
+	NetPacketList packetList = NetPacket::ConstructBigCommandPacketList(origref);
+	NetPacketListIter tempPacketPtr = packetList.begin();
+
+	while (tempPacketPtr != packetList.end()) {
+		NetPacket *tempPacket = (*tempPacketPtr);
+
+		NetCommandList *list = tempPacket->getCommandList();
+		NetCommandRef *ref1 = list->getFirstMessage();
+		while (ref1 != NULL) {
+			NetCommandRef *ref2 = wrappedCommands->addMessage(ref1->getCommand());
+			if (ref2 != NULL) {
+				ref2->setSendClass(sendClass);
+			}
+			ref1 = ref1->getNext();
+		}
+
+		tempPacket->deleteInstance();
+		tempPacket = NULL;
+		++tempPacketPtr;
+
+		list->deleteInstance();
+		list = NULL;
+	}
+
+	origref->deleteInstance();
+	origref = NULL;
+
+	return wrappedCommands;
+}
+
 void Connection::clearCommandsExceptFrom( Int playerIndex )
 {
 	NetCommandRef *tmp = m_netCommandList->getFirstMessage();
@@ -277,28 +356,101 @@ UnsignedInt Connection::doSend() {
 		return 0;
 	}
 	
-	// iterate through all the messages and put them into a packet(s).
+	refillSendBuckets(curtime);
+
+	// Big commands (map transfers, mostly) are split into a wrapper command per packet.  Only let
+	// a window of them wait for acks at once, so a big file doesn't flood the link and get itself
+	// dropped; the next ones go out as the earlier ones are acked.
+	Int wrapperWindow = CONNECTION_WRAPPER_WINDOW;
 	NetCommandRef *msg = m_netCommandList->getFirstMessage();
+	while (msg != NULL) {
+		if ((msg->getCommand()->getNetCommandType() == NETCOMMANDTYPE_WRAPPER) && (msg->getTimeLastSent() != -1)) {
+			--wrapperWindow;
+		}
+		msg = msg->getNext();
+	}
 
-	while ((msg != NULL) && couldQueue) {
-		NetPacket *packet = newInstance(NetPacket);
-		packet->init();
-		packet->setAddress(m_user->GetIPAddr(), m_user->GetPort());
+	// Fill packets a class at a time, most urgent first, so frame commands are never stuck behind
+	// chat or file data.  Each class that has a send rate stops when its bucket runs dry, and we
+	// only use our share of the transport's send slots so one busy connection can't starve the rest.
+	NetPacket *packet = NULL;
+	TransportMessage *slot = NULL;
 
-		Bool notDone = TRUE;
+	Bool useSendClasses = TRUE;
+#if defined(_DEBUG) || defined(_INTERNAL)
+	if (TheGlobalData->m_noSendClasses) {
+		// everything in one pass in list order, and nothing held back.
+		useSendClasses = FALSE;
+	}
+#endif
+	Int numPasses = useSendClasses ? CONNECTION_SEND_CLASS_COUNT : 1;
 
-		// add the command messages until either we run out of messages or the packet is full.
-		while ((msg != NULL) && notDone) {
+	for (Int pass = 0; (pass < numPasses) && couldQueue; ++pass) {
+		msg = m_netCommandList->getFirstMessage();
+		while (msg != NULL) {
 			NetCommandRef *next = msg->getNext(); // Need this since msg could be deleted
 
 			time_t timeLastSent = msg->getTimeLastSent();
+			Bool isNewWrapper = (timeLastSent == -1) && (msg->getCommand()->getNetCommandType() == NETCOMMANDTYPE_WRAPPER);
+			ConnectionSendClass sendClass = getSendClass(msg);
+			ConnectionSendBucket &bucket = m_sendBuckets[sendClass];
+
+			if (((sendClass == pass) || !useSendClasses) &&
+					(((curtime - timeLastSent) > m_retryTime) || (timeLastSent == -1)) && (!isNewWrapper || (wrapperWindow > 0))) {
+				if (useSendClasses && (bucket.m_rate > 0) && (bucket.m_tokens <= 0)) {
+					// this class has used up its share for now, the rest waits for the next send.
+					++m_sendsDeferred[sendClass];
+					break;
+				}
 
-			if (((curtime - timeLastSent) > m_retryTime) || (timeLastSent == -1)) {
-				notDone = packet->addCommand(msg);
-				if (notDone) {
+				Int lengthBefore = (slot != NULL) ? packet->getLength() : 0;
+				Bool added = (slot != NULL) && packet->addCommand(msg);
+				if (!added) {
+					// start a new packet.
+					if (slot != NULL) {
+						queuePacket(packet, slot, curtime);
+						slot = NULL;
+					}
+					if (useSendClasses && (numpackets >= CONNECTION_MAX_PACKETS_PER_SEND)) {
+						++m_sendsDeferred[sendClass];
+						couldQueue = FALSE;
+						break;
+					}
+					// build the packet right in the transport's send queue, so it doesn't have to be copied there afterwards.
+					slot = m_transport->getFreeSendSlot();
+					if (slot == NULL) {
+						DEBUG_LOG(("didn't finish sending all commands in connection\n"));
+						++m_sendsDeferred[sendClass];
+						couldQueue = FALSE;
+						break;
+					}
+					if (packet == NULL) {
+						packet = newInstance(NetPacket);
+					}
+					packet->reset(slot->data);
+					packet->setAddress(m_user->GetIPAddr(), m_user->GetPort());
+					++numpackets;
+
+					lengthBefore = packet->getLength();
+					added = packet->addCommand(msg);
+				}
+
+				if (added) {
 					// the msg command was added to the packet.
+					Int length = packet->getLength() - lengthBefore;
+					bucket.m_tokens -= length;
+					++m_commandsSent[sendClass];
+					m_bytesSent[sendClass] += length;
+
+					if (isNewWrapper) {
+						--wrapperWindow;
+					}
 					if (CommandRequiresAck(msg->getCommand())) {
-						if (timeLastSent != -1) {
+						if (msg->isGapResend()) {
+							// not a timeout, so it doesn't count towards the link being lossy.
+							msg->setGapResend(FALSE);
+							++m_numGapResends;
+						} else if (timeLastSent != -1) {
 							++m_numRetries;
 						}
 						doRetryMetrics();
@@ -311,26 +463,127 @@ UnsignedInt Connection::doSend() {
 			}
 			msg = next;
 		}
+	}
 
-		if (msg != NULL) {
-			DEBUG_LOG(("didn't finish sending all commands in connection\n"));
+	if (slot != NULL) {
+		if (couldQueue && isLossy()) {
+			addRedundantCommands(packet, curtime);
 		}
+		queuePacket(packet, slot, curtime);
+	}
 
-		++numpackets;
+	if (packet != NULL) {
+		packet->deleteInstance(); // delete the packet now that we're done with it.
+	}
+
+	return numpackets;
+}
+
+/**
+ * Hand the slot a packet was built in back to the transport object for transmission.
+ */
+void Connection::queuePacket(NetPacket *packet, TransportMessage *slot, time_t curtime) {
+	if (packet->getNumCommands() == 0) {
+		return;
+	}
+	m_transport->queueSendSlot(slot, packet->getAddr(), packet->getPort(), packet->getLength());
+	m_lastTimeSent = curtime;
+}
+
+/**
+ * Which send class a queued command goes out in.  Wrappers we split up ourselves have the class of
+ * the command they carry recorded on the ref.
+ */
+ConnectionSendClass Connection::getSendClass(NetCommandRef *ref) {
+	if (ref->getSendClass() >= 0) {
+		return (ConnectionSendClass)ref->getSendClass();
+	}
+	return getSendClass(ref->getCommand());
+}
 
-		/// @todo Make the act of giving the transport object a packet to send more efficient.  Make the transport take a NetPacket object rather than the raw data, thus avoiding an extra memcpy.
-		if (packet->getNumCommands() > 0) {
-			// If the packet actually has any information to give, give it to the transport object
-			// for transmission.
-			couldQueue = m_transport->queueSend(packet->getAddr(), packet->getPort(), packet->getData(), packet->getLength());
-			m_lastTimeSent = curtime;
+/**
+ * Which send class a command goes out in.  Lower classes are packed first.
+ */
+ConnectionSendClass Connection::getSendClass(NetCommandMsg *msg) {
+	switch (msg->getNetCommandType()) {
+		case NETCOMMANDTYPE_WRAPPER:
+			// a wrapper without a recorded class is one we're relaying as the packet router.  File
+			// transfers are always sent direct, so that's a game command.
+		case NETCOMMANDTYPE_FRAMEINFO:
+		case NETCOMMANDTYPE_GAMECOMMAND:
+		case NETCOMMANDTYPE_PLAYERLEAVE:
+		case NETCOMMANDTYPE_RUNAHEAD:
+		case NETCOMMANDTYPE_DESTROYPLAYER:
+		case NETCOMMANDTYPE_FRAMERESENDREQUEST:
+		case NETCOMMANDTYPE_DISCONNECTFRAME:
+			return CONNECTION_SEND_FRAME;
+		case NETCOMMANDTYPE_ACKBOTH:
+		case NETCOMMANDTYPE_ACKSTAGE1:
+		case NETCOMMANDTYPE_ACKSTAGE2:
+			return CONNECTION_SEND_ACK;
+		case NETCOMMANDTYPE_CHAT:
+		case NETCOMMANDTYPE_DISCONNECTCHAT:
+			return CONNECTION_SEND_CHAT;
+		case NETCOMMANDTYPE_FILE:
+		case NETCOMMANDTYPE_FILEANNOUNCE:
+		case NETCOMMANDTYPE_FILEPROGRESS:
+			return CONNECTION_SEND_FILE;
+		default:
+			return CONNECTION_SEND_CONTROL;
+	}
+}
+
+/**
+ * Top up the token buckets for the time since the last send.  Classes without a rate aren't limited.
+ */
+void Connection::refillSendBuckets(time_t curtime) {
+	time_t elapsed = curtime - m_lastBucketRefill;
+	if (elapsed <= 0) {
+		return;
+	}
+	m_lastBucketRefill = curtime;
+
+	for (Int i = 0; i < CONNECTION_SEND_CLASS_COUNT; ++i) {
+		ConnectionSendBucket &bucket = m_sendBuckets[i];
+		if (bucket.m_rate > 0) {
+			bucket.m_tokens = min(bucket.m_tokens + (Int)((bucket.m_rate * elapsed) / 1000), bucket.m_burst);
 		}
-		if (packet != NULL) {
-			packet->deleteInstance(); // delete the packet now that we're done with it.
+	}
+}
+
+/**
+ * Fill out the rest of a packet that is going out anyway with another copy of frame commands
+ * that were sent recently and haven't been acked yet.  If the first packet was lost, the copy
+ * gets there without waiting for the retry, and before the frame stalls waiting for it.  The
+ * copies don't count as a send, so the retry still goes out on time if they're all lost too.
+ */
+void Connection::addRedundantCommands(NetPacket *packet, time_t curtime) {
+	NetCommandRef *msg = m_netCommandList->getFirstMessage();
+	while (msg != NULL) {
+		NetCommandType type = msg->getCommand()->getNetCommandType();
+		time_t timeLastSent = msg->getTimeLastSent();
+		if (((type == NETCOMMANDTYPE_GAMECOMMAND) || (type == NETCOMMANDTYPE_FRAMEINFO)) &&
+				(timeLastSent != -1) && (timeLastSent != curtime) && (msg->getRedundantSends() < CONNECTION_REDUNDANT_SENDS)) {
+			if (!packet->addCommand(msg)) {
+				return;
+			}
+			msg->setRedundantSends(msg->getRedundantSends() + 1);
+			++m_numRedundantSends;
 		}
+		msg = msg->getNext();
 	}
+}
 
-	return numpackets;
+/**
+ * Returns true if we've had to retry anything on this connection recently.
+ */
+Bool Connection::isLossy() {
+#if defined(_DEBUG) || defined(_INTERNAL)
+	if (TheGlobalData->m_noEarlyResends) {
+		return FALSE;
+	}
+#endif
+	return (m_numRetries + m_lastNumRetries) > 0;
 }
 
 NetCommandRef * Connection::processAck(NetAckStage1CommandMsg *msg) {
@@ -360,13 +613,8 @@ NetCommandRef * Connection::processAck(NetCommandMsg *msg) {
  * Take that message off the list of commands to send.
  */
 NetCommandRef * Connection::processAck(UnsignedShort commandID, UnsignedByte originalPlayerID) {
-	NetCommandRef *temp = m_netCommandList->getFirstMessage();
-	while ((temp != NULL) && ((temp->getCommand()->getID() != commandID) || (temp->getCommand()->getPlayerID() != originalPlayerID))) {
-
-		// cycle through the commands till we find the one we need to remove.
-		// Need to check for both the command ID and the player ID.
-		temp = temp->getNext();
-	}
+	// Need to check for both the command ID and the player ID.
+	NetCommandRef *temp = m_netCommandList->findMessage(commandID, originalPlayerID);
 	if (temp == NULL) {
 		return NULL;
 	}
@@ -384,6 +632,36 @@ NetCommandRef * Connection::processAck(UnsignedShort commandID, UnsignedByte ori
 	m_averageLatency += lat / CONNECTION_LATENCY_HISTORY_LENGTH;
 	m_latencies[index] = lat;
 
+	ConnectionSendClass sendClass = getSendClass(temp);
+	m_ackLatencyTotal[sendClass] += lat;
+	++m_acksReceived[sendClass];
+	m_totalAckLatency[sendClass] += lat;
+	++m_totalAcksReceived[sendClass];
+
+	// The acks for one player's commands come back sorted by command ID, so a command from the
+	// same player with a lower ID, sent before this one and still not acked, was most likely lost.
+	// Resend it now instead of waiting out the retry time.  Acks for different players' commands
+	// can come back in any order, so they don't tell us anything about each other.
+	NetCommandMsg *ackedMsg = temp->getCommand();
+	time_t ackedTimeSent = temp->getTimeLastSent();
+	time_t curtime = timeGetTime();
+	NetCommandRef *ref = m_netCommandList->getFirstMessage();
+#if defined(_DEBUG) || defined(_INTERNAL)
+	if (TheGlobalData->m_noEarlyResends) {
+		ref = NULL;
+	}
+#endif
+	while (ref != NULL) {
+		NetCommandMsg *refMsg = ref->getCommand();
+		time_t timeLastSent = ref->getTimeLastSent();
+		if ((refMsg->getPlayerID() == ackedMsg->getPlayerID()) && ((Short)(ackedMsg->getID() - refMsg->getID()) > 0) &&
+				(timeLastSent != -1) && (timeLastSent < ackedTimeSent) && ((curtime - timeLastSent) <= m_retryTime)) {
+			ref->setTimeLastSent(curtime - m_retryTime - 1);
+			ref->setGapResend(TRUE);
+		}
+		ref = ref->getNext();
+	}
+
 #if defined(_DEBUG) || defined(_INTERNAL)
 	if (doDebug == TRUE) {
 		DEBUG_LOG(("Connection::processAck - disconnect frame command %d found, removing from command list.\n", commandID));
@@ -406,12 +684,46 @@ void Connection::doRetryMetrics() {
 		m_retryMetricsTime = curTime;
 		++numSeconds;
 //		DEBUG_LOG(("Retries in the last 10 seconds = %d, average latency = %fms\n", m_numRetries, m_averageLatency));
+		if ((m_numRetries > 0) || (m_numGapResends > 0) || (m_numRedundantSends > 0)) {
+			DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("Connection::doRetryMetrics - last 10 seconds: %d retries, %d early resends for ack gaps, %d redundant frame commands\n",
+				m_numRetries, m_numGapResends, m_numRedundantSends));
+		}
+		m_lastNumRetries = m_numRetries;
 		m_numRetries = 0;
+		m_numGapResends = 0;
+		m_numRedundantSends = 0;
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+		static const char *sendClassNames[CONNECTION_SEND_CLASS_COUNT] = { "frame", "ack", "control", "chat", "file" };
+		for (Int i = 0; i < CONNECTION_SEND_CLASS_COUNT; ++i) {
+			if ((m_commandsSent[i] > 0) || (m_sendsDeferred[i] > 0)) {
+				DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("Connection::doRetryMetrics - %s: %d commands, %d bytes, held back %d times, average ack latency %gms\n",
+					sendClassNames[i], m_commandsSent[i], m_bytesSent[i], m_sendsDeferred[i],
+					(m_acksReceived[i] > 0) ? (m_ackLatencyTotal[i] / m_acksReceived[i]) : 0.0f));
+			}
+		}
+#endif
+		resetSendClassMetrics();
 //		m_retryTime = m_averageLatency * 1.5;
 	}
 }
 
+void Connection::resetSendClassMetrics() {
+	for (Int i = 0; i < CONNECTION_SEND_CLASS_COUNT; ++i) {
+		m_commandsSent[i] = 0;
+		m_bytesSent[i] = 0;
+		m_sendsDeferred[i] = 0;
+		m_acksReceived[i] = 0;
+		m_ackLatencyTotal[i] = 0.0f;
+	}
+}
+
 #if defined(_DEBUG) || (_INTERNAL)
+void Connection::getAckLatencyTotals(Int sendClass, Int &acks, Real &latency) {
+	acks = m_totalAcksReceived[sendClass];
+	latency = m_totalAckLatency[sendClass];
+}
+
 void Connection::debugPrintCommands() {
 	NetCommandRef *ref = m_netCommandList->getFirstMessage();
 	while (ref != NULL) {
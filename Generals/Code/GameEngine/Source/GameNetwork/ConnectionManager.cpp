@@ -31,6 +31,7 @@
 #include "Common/CRCDebug.h"
 #include "Common/Debug.h"
 #include "Common/File.h"
+#include "Common/FrameProfiler.h"
 #include "Common/GameAudio.h"
 #include "Common/LocalFileSystem.h"
 #include "Common/Player.h"
@@ -194,6 +195,10 @@ void ConnectionManager::init()
 	}
 	m_smallestPacketArrivalCushion = -1;
 
+	m_lastRunAheadMetricsTime = 0;
+	m_keepAliveIndex = 0;
+	m_keepAliveStartTime = 0;
+
 	m_frameMetrics.init();
 
 	TheDisconnectMenu = NEW DisconnectMenu;
@@ -308,6 +313,9 @@ void ConnectionManager::attachTransport(Transport *transport) {
 		m_transport = NULL;
 	}
 	m_transport = transport;
+#if defined(_DEBUG) || defined(_INTERNAL)
+	m_transport->openCaptureFile();
+#endif
 }
 
 /**
@@ -694,28 +702,25 @@ void ConnectionManager::processFile(NetFileCommandMsg *msg)
 	UnsignedByte *buf = msg->getFileData();
 	Int len = msg->getFileLength();
 
-	// uncompress Targas
-#ifdef COMPRESS_TARGAS
+	// the sender compresses anything that gets smaller, so undo that before writing it out
 	Bool deleteBuf = FALSE;
-	if (msg->getFilename().endsWith(".tga") && CompressionManager::isDataCompressed(buf, len))
+	if (msg->isCompressed())
 	{
 		Int uncompLen = CompressionManager::getUncompressedSize(buf, len);
-		UnsignedByte *uncompBuffer = NEW UnsignedByte[uncompLen];
-		Int actualLen = CompressionManager::decompressData(buf, len, uncompBuffer, uncompLen);
-		if (actualLen == uncompLen)
+		UnsignedByte *uncompBuffer = (uncompLen > 0) ? NEW UnsignedByte[uncompLen] : NULL;
+		Int actualLen = uncompBuffer ? CompressionManager::decompressData(buf, len, uncompBuffer, uncompLen) : 0;
+		if (uncompLen <= 0 || actualLen != uncompLen)
 		{
-			DEBUG_LOG(("Uncompressed Targa after map transfer\n"));
-			deleteBuf = TRUE;
-			buf = uncompBuffer;
-			len = uncompLen;
-		}
-		else
-		{
-			DEBUG_LOG(("Failed to uncompress Targa after map transfer\n"));
-			delete[] uncompBuffer; // failed to decompress, so just use the source
+			// don't write out a broken file, the transfer will time out instead
+			DEBUG_LOG(("Failed to uncompress '%s' after map transfer\n", msg->getRealFilename().str()));
+			delete[] uncompBuffer;
+			return;
 		}
+		DEBUG_LOG(("Uncompressed '%s' from %d to %d bytes after map transfer\n", msg->getRealFilename().str(), len, uncompLen));
+		deleteBuf = TRUE;
+		buf = uncompBuffer;
+		len = uncompLen;
 	}
-#endif // COMPRESS_TARGAS
 
 	File *fp = TheFileSystem->openFile(msg->getRealFilename().str(), File::CREATE | File::BINARY | File::WRITE);
 	if (fp)
@@ -752,13 +757,11 @@ void ConnectionManager::processFile(NetFileCommandMsg *msg)
 	processFileProgress(progressMsg);
 	progressMsg->detach();
 
-#ifdef COMPRESS_TARGAS
 	if (deleteBuf)
 	{
 		delete[] buf;
 		buf = NULL;
 	}
-#endif // COMPRESS_TARGAS
 }
 
 void ConnectionManager::processFileAnnounce(NetFileAnnounceCommandMsg *msg) 
@@ -1118,14 +1121,25 @@ void ConnectionManager::sendRemoteCommand(NetCommandRef *msg) {
 		}
 	}
 
+	// Split big commands up once here instead of once for every player we relay to.
+	NetCommandList *wrappedCommands = NULL;
+	if ((relay & ~(1 << m_localSlot)) != 0) {
+		wrappedCommands = Connection::splitNetCommandMsg(msg->getCommand());
+	}
+
 	for (Int i = 0; i < MAX_SLOTS; ++i) {
 		if ((relay & (1 << i)) && ((m_connections[i] != NULL) && (m_connections[i]->isQuitting() == FALSE))) {
 			DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("ConnectionManager::sendRemoteCommand - relaying command %d to player %d\n", msg->getCommand()->getID(), i));
-			m_connections[i]->sendNetCommandMsg(msg->getCommand(), 1 << i);
+			m_connections[i]->sendNetCommandMsg(msg->getCommand(), 1 << i, wrappedCommands);
 			actualRelay = actualRelay | (1 << i);
 		}
 	}
 
+	if (wrappedCommands != NULL) {
+		wrappedCommands->deleteInstance();
+		wrappedCommands = NULL;
+	}
+
 	if ((actualRelay != 0) && (CommandRequiresAck(msg->getCommand()) == TRUE)) {
 		NetCommandRef *ref = m_relayedCommands->addMessage(msg->getCommand());
 		if (ref != NULL) {
@@ -1161,6 +1175,7 @@ void ConnectionManager::update(Bool isInGame) {
 // 4. blow something up
 // 5. bust some cap
 //
+	PROFILE_ZONE("ConnectionManager::update");
 
 	if ((m_localAddr == 0) || (m_localPort == 0)) {
 		// we don't have a local address or port yet, this is bad.
@@ -1211,13 +1226,12 @@ void ConnectionManager::update(Bool isInGame) {
 }
 
 void ConnectionManager::updateRunAhead(Int oldRunAhead, Int frameRate, Bool didSelfSlug, Int nextExecutionFrame) {
-	static time_t lasttimesent = 0;
 	time_t curTime = timeGetTime();
 
-	if ((lasttimesent == 0) || ((curTime - lasttimesent) > TheGlobalData->m_networkRunAheadMetricsTime)) {
+	if ((m_lastRunAheadMetricsTime == 0) || ((curTime - m_lastRunAheadMetricsTime) > TheGlobalData->m_networkRunAheadMetricsTime)) {
 		if (m_localSlot == m_packetRouterSlot) {
 			// We are the packet router, time to compute a new run ahead for this game.
-			m_latencyAverages[m_localSlot] = m_frameMetrics.getAverageLatency();
+			m_latencyAverages[m_localSlot] = getRunAheadLatency();
 
 			// since we are now using the display frame rate rather than the logic frame rate to get our average FPS,
 			// it doesn't make sense to send the desired logic frame rate if we "slugged" ourself.
@@ -1280,6 +1294,13 @@ void ConnectionManager::updateRunAhead(Int oldRunAhead, Int frameRate, Bool didS
 
 			msg->setRunAhead(newRunAhead);
 			msg->setFrameRate(minFps);
+			for (Int i = 0; i < MAX_SLOTS; ++i) {
+				if (isPlayerConnected(i)) {
+					DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("ConnectionManager::updateRunAhead - player %d reported latency %f, fps %d\n", i, m_latencyAverages[i], m_fpsAverages[i]));
+				}
+			}
+			DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("ConnectionManager::updateRunAhead - chose run ahead %d, frame rate %d, min cushion %d, stall target %d%%\n",
+				newRunAhead, minFps, m_frameMetrics.getMinimumCushion(), TheGlobalData->m_networkRunAheadStallTarget));
 			//DEBUG_LOG(("ConnectionManager::updateRunAhead - new run ahead = %d, new frame rate = %d, execution frame %d\n", newRunAhead, minFps, msg->getExecutionFrame()));
 			sendLocalCommand(msg, 0xff ^ (1 << minFpsPlayer)); // Send the packet to everyone but the lowest FPS player.
 
@@ -1333,7 +1354,9 @@ void ConnectionManager::updateRunAhead(Int oldRunAhead, Int frameRate, Bool didS
 			if (DoesCommandRequireACommandID(msg->getNetCommandType())) {
 				msg->setID(GenerateNextCommandID());
 			}
-			msg->setAverageLatency(m_frameMetrics.getAverageLatency());
+			// This goes out as the "average" latency, but it's whatever the packet router should
+			// plan for, which with a stall target is the percentile rather than the mean.
+			msg->setAverageLatency(getRunAheadLatency());
 
 			// see above for explanation.
 //			if (didSelfSlug) {
@@ -1349,10 +1372,28 @@ void ConnectionManager::updateRunAhead(Int oldRunAhead, Int frameRate, Bool didS
 			m_connections[m_packetRouterSlot]->sendNetCommandMsg(msg, 1 << m_packetRouterSlot);
 			msg->detach();
 		}
-		lasttimesent = curTime;
+		m_lastRunAheadMetricsTime = curTime;
 	}
 }
 
+/**
+ * With a stall target of N%, run ahead is planned around the latency that only N% of our round
+ * trips go over, so one jittery connection gets enough run ahead to cover its spikes.  Never less
+ * than the average, so a steady connection gets the same run ahead it always did.
+ */
+Real ConnectionManager::getRunAheadLatency() {
+	Real latency = m_frameMetrics.getAverageLatency();
+	Int target = TheGlobalData->m_networkRunAheadStallTarget;
+	if ((target > 0) && (target < 100)) {
+		Real percentileLatency = m_frameMetrics.getLatencyPercentile(100 - target);
+		DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("ConnectionManager::getRunAheadLatency - average %f, p50 %f, p95 %f, p99 %f, using p%d %f\n",
+			latency, m_frameMetrics.getLatencyPercentile(50), m_frameMetrics.getLatencyPercentile(95), m_frameMetrics.getLatencyPercentile(99),
+			100 - target, percentileLatency));
+		latency = max(latency, percentileLatency);
+	}
+	return latency;
+}
+
 Real ConnectionManager::getMaximumLatency() {
 	// This works for 2 player games because the latency for the packet router is always 0.
 	Real lat1 = 0.0;
@@ -1444,6 +1485,9 @@ void ConnectionManager::initTransport() {
 	m_transport = new Transport;
 	m_transport->reset();
 	m_transport->init(m_localAddr, m_localPort);
+#if defined(_DEBUG) || defined(_INTERNAL)
+	m_transport->openCaptureFile();
+#endif
 }
 
 /**
@@ -1489,14 +1533,19 @@ void ConnectionManager::sendLocalCommand(NetCommandMsg *msg, UnsignedByte relay
 	// Send the packet to everyone else
 	if (m_localSlot == m_packetRouterSlot) {
 		// I am the packet router, I need to send this packet to everyone individually.
+		NetCommandList *wrappedCommands = Connection::splitNetCommandMsg(msg);
 		for (Int i = 0; i < MAX_SLOTS; ++i) {
 			// Send it to all open connections.
 			if (((m_connections[i] != NULL) && (m_connections[i]->isQuitting() == FALSE)) && (relay & (1 << i))) {
 				// Set the relay mask to only go to this player so he knows not to relay it to anyone else.
 				UnsignedByte temprelay = 1 << i;
-				m_connections[i]->sendNetCommandMsg(msg, temprelay); // This will create a new copy of netmsg for this connection.
+				m_connections[i]->sendNetCommandMsg(msg, temprelay, wrappedCommands); // This will create a new copy of netmsg for this connection.
 			}
 		}
+		if (wrappedCommands != NULL) {
+			wrappedCommands->deleteInstance();
+			wrappedCommands = NULL;
+		}
 	} else {
 		// Send the command to everyone else via the packet router.
 		UnsignedByte temprelay = relay & ~(1 << m_localSlot);	// Tell the packet router to relay the message to everyone but myself.
@@ -1531,15 +1580,20 @@ void ConnectionManager::sendLocalCommandDirect(NetCommandMsg *msg, UnsignedByte
 		}
 	}
 
+	NetCommandList *wrappedCommands = Connection::splitNetCommandMsg(msg);
 	for (Int i = 0; i < MAX_SLOTS; ++i) {
 		if ((relay & (1 << i)) != 0) {
 			if ((m_connections[i] != NULL) && (m_connections[i]->isQuitting() == FALSE)) {
 				UnsignedByte temprelay = 1 << i;
-				m_connections[i]->sendNetCommandMsg(msg, temprelay);
+				m_connections[i]->sendNetCommandMsg(msg, temprelay, wrappedCommands);
 				DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("ConnectionManager::sendLocalCommandDirect - Sending direct command %d of type %s to player %d\n", msg->getID(), GetAsciiNetCommandType(msg->getNetCommandType()).str(), i));
 			}
 		}
 	}
+	if (wrappedCommands != NULL) {
+		wrappedCommands->deleteInstance();
+		wrappedCommands = NULL;
+	}
 
 	msg->detach();
 }
@@ -1662,35 +1716,32 @@ void ConnectionManager::determineRouterFallbackPlan() {
 */
 
 void ConnectionManager::doKeepAlive() {
-	static Int nextIndex = 0;
-	static time_t startTime = 0;
-
 	time_t curTime = timeGetTime();
 
-	if (startTime == 0) {
-		startTime = curTime;
+	if (m_keepAliveStartTime == 0) {
+		m_keepAliveStartTime = curTime;
 		return;
 	}
 
-	time_t numSeconds = (curTime - startTime) / 1000;
+	time_t numSeconds = (curTime - m_keepAliveStartTime) / 1000;
 
-	while ((nextIndex <= numSeconds) && (nextIndex < MAX_SLOTS)) {
-//		DEBUG_LOG(("ConnectionManager::doKeepAlive - trying to send keep alive message to player %d\n", nextIndex));
-		if (m_connections[nextIndex] != NULL) {
+	while ((m_keepAliveIndex <= numSeconds) && (m_keepAliveIndex < MAX_SLOTS)) {
+//		DEBUG_LOG(("ConnectionManager::doKeepAlive - trying to send keep alive message to player %d\n", m_keepAliveIndex));
+		if (m_connections[m_keepAliveIndex] != NULL) {
 			NetKeepAliveCommandMsg *msg = newInstance(NetKeepAliveCommandMsg);
 			msg->setPlayerID(m_localSlot);
 			if (DoesCommandRequireACommandID(msg->getNetCommandType()) == TRUE) {
 				msg->setID(GenerateNextCommandID());
 			}
-//			DEBUG_LOG(("ConnectionManager::doKeepAlive - sending keep alive message to player %d\n", nextIndex));
-			sendLocalCommandDirect(msg, 1 << nextIndex);
+//			DEBUG_LOG(("ConnectionManager::doKeepAlive - sending keep alive message to player %d\n", m_keepAliveIndex));
+			sendLocalCommandDirect(msg, 1 << m_keepAliveIndex);
 			msg->detach();
 		}
-		++nextIndex;
+		++m_keepAliveIndex;
 	}
-	if (nextIndex == MAX_SLOTS) {
-		nextIndex = 0;
-		startTime = curTime;
+	if (m_keepAliveIndex == MAX_SLOTS) {
+		m_keepAliveIndex = 0;
+		m_keepAliveStartTime = curTime;
 	}
 }
 
@@ -1915,6 +1966,18 @@ void ConnectionManager::parseUserList(const GameInfo *game)
 	TheMemoryPoolFactory->debugSetInitFillerIndex(m_localSlot);
 #endif
 
+#if defined(_DEBUG) || defined(_INTERNAL)
+	if (m_transport != NULL) {
+		UnsignedByte playerMask = 0;
+		for (i = 0; i < MAX_SLOTS; ++i) {
+			if (m_frameData[i] != NULL) {
+				playerMask |= 1 << i;
+			}
+		}
+		m_transport->captureUsers(m_localSlot, playerMask);
+	}
+#endif
+
 	/*
 	if ( numUsers < 2 || m_localSlot == -1 )
 	{
@@ -2075,6 +2138,17 @@ Real ConnectionManager::getUnknownPacketsPerSecond( void )
 	  return 0.0;
 }
 
+/**
+ * Return the number of send and receive calls made on the socket per second averaged over the last 30 sec.
+ */
+Real ConnectionManager::getSocketCallsPerSecond( void )
+{
+	if (m_transport)
+		return m_transport->getSocketCallsPerSecond();
+	else
+	  return 0.0;
+}
+
 /**
  * Return the smallest packet arrival cushion since this was last called.
  */
@@ -2170,35 +2244,25 @@ void ConnectionManager::sendFile(AsciiString path, UnsignedByte playerMask, Unsi
 	Int len = theFile->size();
 	char *buf = theFile->readEntireAndClose();
 
-	// compress Targas
-#ifdef COMPRESS_TARGAS
-	char *compressedBuf = NULL;
-	Int compressedLen = path.endsWith(".tga")?CompressionManager::getMaxCompressedSize(len, CompressionManager::getPreferredCompression()):0;
-	Int compressedSize = 0;
-	if (compressedLen)
-		compressedSize = CompressionManager::compressData(CompressionManager::getPreferredCompression(),
-		buf, len, compressedBuf, compressedLen);
-
-	if (compressedBuf && !compressedSize)
-	{
-		delete[] compressedBuf;
-		compressedBuf = NULL;
-	}
-#endif // COMPRESS_TARGAS
+	// Every chunk of the file costs a packet to each player, so compress it if that makes it any
+	// smaller.  Maps that are already compressed on disk won't shrink, and are sent as they are.
+	CompressionType compType = CompressionManager::getPreferredCompression();
+	Int compressedLen = CompressionManager::getMaxCompressedSize(len, compType);
+	char *compressedBuf = NEW char[compressedLen];
+	Int compressedSize = CompressionManager::compressData(compType, buf, len, compressedBuf, compressedLen);
 
 	NetFileCommandMsg *fileMsg = newInstance(NetFileCommandMsg);
 	fileMsg->setPlayerID(m_localSlot);
 	fileMsg->setID(commandID);
 	fileMsg->setRealFilename(path);
-#ifdef COMPRESS_TARGAS
-	if (compressedBuf)
+	if (compressedSize > 0 && compressedSize < len)
 	{
 		DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("Compressed '%s' from %d to %d (%g%%) before transfer\n", path.str(), len, compressedSize,
 			(Real)compressedSize/(Real)len*100.0f));
 		fileMsg->setFileData((unsigned char *)compressedBuf, compressedSize);
+		fileMsg->setCompressed(TRUE);
 	}
 	else
-#endif // COMPRESS_TARGAS
 	{
 		fileMsg->setFileData((unsigned char *)buf, len);
 	}
@@ -2208,13 +2272,8 @@ void ConnectionManager::sendFile(AsciiString path, UnsignedByte playerMask, Unsi
 
 	delete[] buf;
 	buf = NULL;
-#ifdef COMPRESS_TARGAS
-	if (compressedBuf)
-	{
-		delete[] compressedBuf;
-		compressedBuf = NULL;
-	}
-#endif // COMPRESS_TARGAS
+	delete[] compressedBuf;
+	compressedBuf = NULL;
 
 	DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("Sending file: '%s', len %d, to %X\n", path.str(), len, playerMask));
 
@@ -2336,6 +2395,23 @@ void ConnectionManager::debugPrintConnectionCommands() {
 	}
 	DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("ConnectionManager::debugPrintConnectionCommands - end commands\n"));
 }
+
+/**
+ * Acks and summed send to ack milliseconds for one send class, over all our connections.
+ */
+void ConnectionManager::getAckLatencyTotals(Int sendClass, Int &acks, Real &latency) {
+	acks = 0;
+	latency = 0.0f;
+	for (Int i = 0; i < MAX_SLOTS; ++i) {
+		if (m_connections[i] != NULL) {
+			Int connectionAcks;
+			Real connectionLatency;
+			m_connections[i]->getAckLatencyTotals(sendClass, connectionAcks, connectionLatency);
+			acks += connectionAcks;
+			latency += connectionLatency;
+		}
+	}
+}
 #endif
 
 void ConnectionManager::notifyOthersOfCurrentFrame(Int frame) {
@@ -145,3 +145,23 @@ Real FrameMetrics::getAverageLatency() {
 Int FrameMetrics::getMinimumCushion() {
 	return m_minimumCushion;
 }
+
+/**
+ * Averages hide jitter; a connection that is usually fast but spikes now and then
+ * shows up in the high percentiles instead.
+ */
+Real FrameMetrics::getLatencyPercentile(Int percent) {
+	return getPercentile(m_latencyList, TheGlobalData->m_networkLatencyHistoryLength, percent);
+}
+
+Real FrameMetrics::getPercentile(const Real *list, Int length, Int percent) {
+	if (length <= 0) {
+		return 0.0f;
+	}
+
+	// the lists are only a few hundred entries and this is done a couple of times a second
+	std::vector<Real> sorted(list, list + length);
+	Int index = min(max(((length - 1) * percent) / 100, 0), length - 1);
+	std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+	return sorted[index];
+}
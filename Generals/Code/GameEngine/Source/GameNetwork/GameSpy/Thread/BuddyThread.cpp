@@ -34,6 +34,7 @@
 #include "GameNetwork/GameSpy/BuddyThread.h"
 #include "GameNetwork/GameSpy/PeerThread.h"
 #include "GameNetwork/GameSpy/PersistentStorageThread.h"
+#include "GameNetwork/GameSpy/ThreadQueue.h"
 #include "GameNetwork/GameSpy/ThreadUtils.h"
 
 #include "Common/StackDump.h"
@@ -49,8 +50,8 @@
 
 //-------------------------------------------------------------------------
 
-typedef std::queue<BuddyRequest> RequestQueue;
-typedef std::queue<BuddyResponse> ResponseQueue;
+typedef GameSpyThreadQueue<BuddyRequest> RequestQueue;
+typedef GameSpyThreadQueue<BuddyResponse> ResponseQueue;
 class BuddyThreadClass;
 
 class GameSpyBuddyMessageQueue : public GameSpyBuddyMessageQueueInterface
@@ -75,8 +76,6 @@ public:
 	BuddyThreadClass* getThread( void );
 
 private:
-	MutexClass m_requestMutex;
-	MutexClass m_responseMutex;
 	RequestQueue m_requests;
 	ResponseQueue m_responses;
 	BuddyThreadClass *m_thread;
@@ -212,46 +211,22 @@ Bool GameSpyBuddyMessageQueue::isConnecting( void )
 
 void GameSpyBuddyMessageQueue::addRequest( const BuddyRequest& req )
 {
-	MutexClass::LockClass m(m_requestMutex);
-	if (m.Failed())
-		return;
-
 	m_requests.push(req);
 }
 
 Bool GameSpyBuddyMessageQueue::getRequest( BuddyRequest& req )
 {
-	MutexClass::LockClass m(m_requestMutex, 0);
-	if (m.Failed())
-		return false;
-
-	if (m_requests.empty())
-		return false;
-	req = m_requests.front();
-	m_requests.pop();
-	return true;
+	return m_requests.pop(req);
 }
 
 void GameSpyBuddyMessageQueue::addResponse( const BuddyResponse& resp )
 {
-	MutexClass::LockClass m(m_responseMutex);
-	if (m.Failed())
-		return;
-
 	m_responses.push(resp);
 }
 
 Bool GameSpyBuddyMessageQueue::getResponse( BuddyResponse& resp )
 {
-	MutexClass::LockClass m(m_responseMutex, 0);
-	if (m.Failed())
-		return false;
-
-	if (m_responses.empty())
-		return false;
-	resp = m_responses.front();
-	m_responses.pop();
-	return true;
+	return m_responses.pop(resp);
 }
 
 BuddyThreadClass* GameSpyBuddyMessageQueue::getThread( void )
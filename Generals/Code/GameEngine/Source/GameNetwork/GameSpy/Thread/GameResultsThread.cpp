@@ -31,6 +31,7 @@
 // #include <winsock.h>	// This one has to be here. Prevents collisions with winsock2.h
 
 #include "GameNetwork/GameSpy/GameResultsThread.h"
+#include "GameNetwork/GameSpy/ThreadQueue.h"
 #include "mutex.h"
 #include "thread.h"
 
@@ -41,8 +42,8 @@
 
 static const Int NumWorkerThreads = 1;
 
-typedef std::queue<GameResultsRequest> RequestQueue;
-typedef std::queue<GameResultsResponse> ResponseQueue;
+typedef GameSpyThreadQueue<GameResultsRequest> RequestQueue;
+typedef GameSpyThreadQueue<GameResultsResponse> ResponseQueue;
 class GameResultsThreadClass;
 
 class GameResultsQueue : public GameResultsInterface
@@ -68,12 +69,10 @@ public:
 	virtual Bool areGameResultsBeingSent( void );
 
 private:
-	MutexClass m_requestMutex;
-	MutexClass m_responseMutex;
 	RequestQueue m_requests;
 	ResponseQueue m_responses;
-	Int m_requestCount;
-	Int m_responseCount;
+	std::atomic<Int> m_requestCount;		///< bumped on the game thread
+	std::atomic<Int> m_responseCount;		///< bumped on the worker threads
 
 	GameResultsThreadClass *m_workerThreads[NumWorkerThreads];
 };
@@ -154,54 +153,28 @@ Bool GameResultsQueue::areThreadsRunning( void )
 
 void GameResultsQueue::addRequest( const GameResultsRequest& req )
 {
-	MutexClass::LockClass m(m_requestMutex);
-
 	++m_requestCount;
 	m_requests.push(req);
 }
 
 Bool GameResultsQueue::getRequest( GameResultsRequest& req )
 {
-	MutexClass::LockClass m(m_requestMutex, 0);
-	if (m.Failed())
-		return false;
-
-	if (m_requests.empty())
-		return false;
-	req = m_requests.front();
-	m_requests.pop();
-	return true;
+	return m_requests.pop(req);
 }
 
 void GameResultsQueue::addResponse( const GameResultsResponse& resp )
 {
-	{
-		MutexClass::LockClass m(m_responseMutex);
-
-		++m_responseCount;
-		m_responses.push(resp);
-	}
+	++m_responseCount;
+	m_responses.push(resp);
 }
 
 Bool GameResultsQueue::getResponse( GameResultsResponse& resp )
 {
-	MutexClass::LockClass m(m_responseMutex, 0);
-	if (m.Failed())
-		return false;
-
-	if (m_responses.empty())
-		return false;
-	resp = m_responses.front();
-	m_responses.pop();
-	return true;
+	return m_responses.pop(resp);
 }
 
 Bool GameResultsQueue::areGameResultsBeingSent( void )
 {
-	MutexClass::LockClass m(m_requestMutex, 0);
-	if (m.Failed())
-		return true;
-
 	return m_requestCount > 0;
 }
 
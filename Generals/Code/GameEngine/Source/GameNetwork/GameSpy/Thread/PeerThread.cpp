@@ -40,6 +40,7 @@
 #include "GameNetwork/GameSpy/PeerDefs.h"
 #include "GameNetwork/GameSpy/PeerThread.h"
 #include "GameNetwork/GameSpy/PersistentStorageThread.h"
+#include "GameNetwork/GameSpy/ThreadQueue.h"
 #include "GameNetwork/GameSpy/ThreadUtils.h"
 
 #include "strtok_r.h"
@@ -138,8 +139,8 @@ enum
 
 //-------------------------------------------------------------------------
 
-typedef std::queue<PeerRequest> RequestQueue;
-typedef std::queue<PeerResponse> ResponseQueue;
+typedef GameSpyThreadQueue<PeerRequest> RequestQueue;
+typedef GameSpyThreadQueue<PeerResponse> ResponseQueue;
 class PeerThreadClass;
 
 class GameSpyPeerMessageQueue : public GameSpyPeerMessageQueueInterface
@@ -165,8 +166,6 @@ public:
 	PeerThreadClass* getThread( void );
 
 private:
-	MutexClass m_requestMutex;
-	MutexClass m_responseMutex;
 	RequestQueue m_requests;
 	ResponseQueue m_responses;
 	PeerThreadClass *m_thread;
@@ -603,25 +602,13 @@ Bool GameSpyPeerMessageQueue::isConnecting( void )
 
 void GameSpyPeerMessageQueue::addRequest( const PeerRequest& req )
 {
-	MutexClass::LockClass m(m_requestMutex);
-	if (m.Failed())
-		return;
-
 	m_requests.push(req);
 }
 
 //PeerRequest GameSpyPeerMessageQueue::getRequest( void )
 Bool GameSpyPeerMessageQueue::getRequest( PeerRequest& req )
 {
-	MutexClass::LockClass m(m_requestMutex, 0);
-	if (m.Failed())
-		return false;
-
-	if (m_requests.empty())
-		return false;
-	req = m_requests.front();
-	m_requests.pop();
-	return true;
+	return m_requests.pop(req);
 }
 
 void GameSpyPeerMessageQueue::addResponse( const PeerResponse& resp )
@@ -629,25 +616,13 @@ void GameSpyPeerMessageQueue::addResponse( const PeerResponse& resp )
 	if (resp.nick == "(END)")
 		return;
 
-	MutexClass::LockClass m(m_responseMutex);
-	if (m.Failed())
-		return;
-
 	m_responses.push(resp);
 }
 
 //PeerResponse GameSpyPeerMessageQueue::getResponse( void )
 Bool GameSpyPeerMessageQueue::getResponse( PeerResponse& resp )
 {
-	MutexClass::LockClass m(m_responseMutex, 0);
-	if (m.Failed())
-		return false;
-
-	if (m_responses.empty())
-		return false;
-	resp = m_responses.front();
-	m_responses.pop();
-	return true;
+	return m_responses.pop(resp);
 }
 
 PeerThreadClass* GameSpyPeerMessageQueue::getThread( void )
@@ -34,6 +34,7 @@
 #include "Common/UserPreferences.h"
 #include "Common/PlayerTemplate.h"
 #include "GameNetwork/GameSpy/PersistentStorageThread.h"
+#include "GameNetwork/GameSpy/ThreadQueue.h"
 
 #include "mutex.h"
 #include "thread.h"
@@ -366,8 +367,8 @@ PSPlayerStats::PSPlayerStats( const PSPlayerStats& other )
 
 //-------------------------------------------------------------------------
 
-typedef std::queue<PSRequest> RequestQueue;
-typedef std::queue<PSResponse> ResponseQueue;
+typedef GameSpyThreadQueue<PSRequest> RequestQueue;
+typedef GameSpyThreadQueue<PSResponse> ResponseQueue;
 class PSThreadClass;
 
 class GameSpyPSMessageQueue : public GameSpyPSMessageQueueInterface
@@ -402,8 +403,6 @@ public:
 	void setPassword(std::string password) { m_password = password; }
 
 private:
-	MutexClass m_requestMutex;
-	MutexClass m_responseMutex;
 	RequestQueue m_requests;
 	ResponseQueue m_responses;
 	PSThreadClass *m_thread;
@@ -498,46 +497,22 @@ Bool GameSpyPSMessageQueue::isThreadRunning( void )
 
 void GameSpyPSMessageQueue::addRequest( const PSRequest& req )
 {
-	MutexClass::LockClass m(m_requestMutex);
-	if (m.Failed())
-		return;
-
 	m_requests.push(req);
 }
 
 Bool GameSpyPSMessageQueue::getRequest( PSRequest& req )
 {
-	MutexClass::LockClass m(m_requestMutex, 0);
-	if (m.Failed())
-		return false;
-
-	if (m_requests.empty())
-		return false;
-	req = m_requests.front();
-	m_requests.pop();
-	return true;
+	return m_requests.pop(req);
 }
 
 void GameSpyPSMessageQueue::addResponse( const PSResponse& resp )
 {
-	MutexClass::LockClass m(m_responseMutex);
-	if (m.Failed())
-		return;
-
 	m_responses.push(resp);
 }
 
 Bool GameSpyPSMessageQueue::getResponse( PSResponse& resp )
 {
-	MutexClass::LockClass m(m_responseMutex, 0);
-	if (m.Failed())
-		return false;
-
-	if (m_responses.empty())
-		return false;
-	resp = m_responses.front();
-	m_responses.pop();
-	return true;
+	return m_responses.pop(resp);
 }
 
 PSThreadClass* GameSpyPSMessageQueue::getThread( void )
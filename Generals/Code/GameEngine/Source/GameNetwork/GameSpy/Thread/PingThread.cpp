@@ -22,15 +22,16 @@
 //																																						//
 ////////////////////////////////////////////////////////////////////////////////
 
+
 // FILE: PingThread.cpp //////////////////////////////////////////////////////
 // Ping thread
 // Author: Matthew D. Campbell, August 2002
 
 #include "PreRTS.h"	// This must go first in EVERY cpp file int the GameEngine
 
-// #include <winsock.h>	// This one has to be here. Prevents collisions with windsock2.h
-
+#include "GameNetwork/udp.h"	// for the socket headers
 #include "GameNetwork/GameSpy/PingThread.h"
+#include "GameNetwork/GameSpy/ThreadQueue.h"
 #include "mutex.h"
 #include "thread.h"
 
@@ -39,10 +40,8 @@
 
 //-------------------------------------------------------------------------
 
-static const Int NumWorkerThreads = 10;
-
-typedef std::queue<PingRequest> RequestQueue;
-typedef std::queue<PingResponse> ResponseQueue;
+typedef GameSpyThreadQueue<PingRequest> RequestQueue;
+typedef GameSpyThreadQueue<PingResponse> ResponseQueue;
 class PingThreadClass;
 
 class Pinger : public PingerInterface
@@ -67,17 +66,15 @@ public:
 	virtual AsciiString getPingString( Int timeout );
 
 private:
-	MutexClass m_requestMutex;
-	MutexClass m_responseMutex;
 	MutexClass m_pingMapMutex;
 	RequestQueue m_requests;
 	ResponseQueue m_responses;
-	Int m_requestCount;
-	Int m_responseCount;
+	std::atomic<Int> m_requestCount;		///< bumped on the game thread
+	std::atomic<Int> m_responseCount;		///< bumped on the worker threads
 
 	std::map<std::string, Int> m_pingMap;
 
-	PingThreadClass *m_workerThreads[NumWorkerThreads];
+	PingThreadClass *m_thread;
 };
 
 PingerInterface* PingerInterface::createNewPingerInterface( void )
@@ -89,27 +86,70 @@ PingerInterface *ThePinger;
 
 //-------------------------------------------------------------------------
 
+// One host being pinged, from its request until every repetition has come back or timed out.
+struct PingHost
+{
+	PingRequest request;
+	UnsignedInt IP;				// network order
+	Int outstanding;			// probes sent but not yet answered or timed out
+	Int totalPing;
+	Int goodReps;
+};
+
+// A probe waiting for its echo.
+struct PingProbe
+{
+	Int hostIndex;
+	UnsignedInt sendTime;
+};
+
+// Timeouts are kept in a min-heap, so the nearest one is always on top.  Entries for probes that
+// were answered are left in the heap and skipped when they come off it.
+struct PingTimeout
+{
+	UnsignedInt deadline;
+	UnsignedShort sequence;
+
+	Bool operator>( const PingTimeout& other ) const { return (Int)(deadline - other.deadline) > 0; }
+};
+
+typedef std::priority_queue< PingTimeout, std::vector<PingTimeout>, std::greater<PingTimeout> > PingTimeoutHeap;
+
 class PingThreadClass : public ThreadClass
 {
 
 public:
-	PingThreadClass() : ThreadClass() {}
+	PingThreadClass() : ThreadClass(), m_socket(-1), m_rawSocket(false), m_identifier(0), m_nextSequence(0) {}
 
 	void Thread_Function();
 
 private:
-	// Int doPing( UnsignedInt IP, Int timeout );
+	Bool openSocket( void );
+	void closeSocket( void );
+
+	UnsignedInt resolve( const std::string& hostname );
+	void startHost( const PingRequest& req );
+	void sendProbe( Int hostIndex );
+	void readReplies( Int waitMs );
+	void expireProbes( void );
+	void finishHosts( void );
+
+	Int m_socket;
+	Bool m_rawSocket;					// raw sockets hand us the IP header as well
+	UnsignedShort m_identifier;
+	UnsignedShort m_nextSequence;
+
+	std::vector<PingHost> m_hosts;
+	std::map<UnsignedShort, PingProbe> m_probes;	// by sequence number
+	PingTimeoutHeap m_timeouts;
+	std::map<std::string, UnsignedInt> m_resolvedHosts;	// lookups block, so only do each one once
 };
 
 
 //-------------------------------------------------------------------------
 
-Pinger::Pinger() : m_requestCount(0), m_responseCount(0)
+Pinger::Pinger() : m_requestCount(0), m_responseCount(0), m_thread(NULL)
 {
-	for (Int i=0; i<NumWorkerThreads; ++i)
-	{
-		m_workerThreads[i] = NULL;
-	}
 }
 
 Pinger::~Pinger()
@@ -120,57 +160,33 @@ Pinger::~Pinger()
 void Pinger::startThreads( void )
 {
 	endThreads();
-	for (Int i=0; i<NumWorkerThreads; ++i)
-	{
-		m_workerThreads[i] = NEW PingThreadClass;
-		m_workerThreads[i]->Execute();
-	}
+	m_thread = NEW PingThreadClass;
+	m_thread->Execute();
 }
 
 void Pinger::endThreads( void )
 {
-	for (Int i=0; i<NumWorkerThreads; ++i)
+	if (m_thread)
 	{
-		if (m_workerThreads[i])
-		{
-			delete m_workerThreads[i];
-			m_workerThreads[i] = NULL;
-		}
+		delete m_thread;
+		m_thread = NULL;
 	}
 }
 
 Bool Pinger::areThreadsRunning( void )
 {
-	for (Int i=0; i<NumWorkerThreads; ++i)
-	{
-		if (m_workerThreads[i])
-		{
-			if (m_workerThreads[i]->Is_Running())
-				return true;
-		}
-	}
-	return false;
+	return (m_thread) ? m_thread->Is_Running() : false;
 }
 
 void Pinger::addRequest( const PingRequest& req )
 {
-	MutexClass::LockClass m(m_requestMutex);
-
 	++m_requestCount;
 	m_requests.push(req);
 }
 
 Bool Pinger::getRequest( PingRequest& req )
 {
-	MutexClass::LockClass m(m_requestMutex, 0);
-	if (m.Failed())
-		return false;
-
-	if (m_requests.empty())
-		return false;
-	req = m_requests.front();
-	m_requests.pop();
-	return true;
+	return m_requests.pop(req);
 }
 
 void Pinger::addResponse( const PingResponse& resp )
@@ -180,25 +196,14 @@ void Pinger::addResponse( const PingResponse& resp )
 
 		m_pingMap[resp.hostname] = resp.avgPing;
 	}
-	{
-		MutexClass::LockClass m(m_responseMutex);
 
-		++m_responseCount;
-		m_responses.push(resp);
-	}
+	++m_responseCount;
+	m_responses.push(resp);
 }
 
 Bool Pinger::getResponse( PingResponse& resp )
 {
-	MutexClass::LockClass m(m_responseMutex, 0);
-	if (m.Failed())
-		return false;
-
-	if (m_responses.empty())
-		return false;
-	resp = m_responses.front();
-	m_responses.pop();
-	return true;
+	return m_responses.pop(resp);
 }
 
 Bool Pinger::arePingsInProgress( void )
@@ -245,334 +250,278 @@ AsciiString Pinger::getPingString( Int timeout )
 
 //-------------------------------------------------------------------------
 
-void PingThreadClass::Thread_Function()
+#define ICMP_ECHO_REPLY		0
+#define ICMP_ECHO_REQUEST	8
+#define ICMP_HEADER_SIZE	8
+#define PING_DATA_SIZE		32
+#define PING_POLL_MS			10
+
+static UnsignedShort icmpChecksum( const UnsignedByte *data, Int len )
 {
-#if 0
-	try {
-	// _set_se_translator( DumpExceptionInfo ); // Hook that allows stack trace.
-	PingRequest req;
+	UnsignedInt sum = 0;
+	for (Int i=0; i+1<len; i+=2)
+		sum += (data[i] << 8) | data[i+1];
+	if (len & 1)
+		sum += data[len-1] << 8;
+	while (sum >> 16)
+		sum = (sum & 0xffff) + (sum >> 16);
+	return (UnsignedShort)~sum;
+}
 
-	WSADATA wsaData;
+Bool PingThreadClass::openSocket( void )
+{
+#ifdef __linux__
+	// unprivileged ICMP sockets, where the system allows them
+	m_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_ICMP);
+	m_rawSocket = false;
+	if (m_socket >= 0)
+		return true;
+#endif
 
-	// Fire up winsock (prob already done, but doesn't matter)
-	// WORD wVersionRequested = MAKEWORD(1, 1);
-	// WSAStartup( wVersionRequested, &wsaData );
+	m_socket = socket(AF_INET, SOCK_RAW, IPPROTO_ICMP);
+	m_rawSocket = true;
+	if (m_socket >= 0)
+		return true;
 
-	while ( running )
-	{
-		// deal with requests
-		if (ThePinger->getRequest(req))
-		{
-			// resolve the hostname
-			const char *hostnameBuffer = req.hostname.c_str();
-			UnsignedInt IP = 0xFFFFFFFF;
-			if (isdigit(hostnameBuffer[0]))
-			{
-				IP = inet_addr(hostnameBuffer);
-				in_addr hostNode;
-				hostNode.s_addr = IP;
-				DEBUG_LOG(("pinging %s - IP = %s\n", hostnameBuffer, inet_ntoa(hostNode) ));
-			}
-			else
-			{
-				hostent *hostStruct;
-				in_addr *hostNode;
-				hostStruct = gethostbyname(hostnameBuffer);
-				if (hostStruct == NULL)
-				{
-					DEBUG_LOG(("pinging %s - host lookup failed\n", hostnameBuffer));
-					
-					// Even though this failed to resolve IP, still need to send a
-					//   callback.
-					IP = 0xFFFFFFFF;   // flag for IP resolve failed
-				}
-				hostNode = (in_addr *) hostStruct->h_addr;
-				IP = hostNode->s_addr;
-				DEBUG_LOG(("pinging %s IP = %s\n", hostnameBuffer, inet_ntoa(*hostNode) ));
-			}
-
-			// do ping
-			Int totalPing = 0;
-			Int goodReps = 0;
-			Int reps = req.repetitions;
-			while (reps-- && running && IP != 0xFFFFFFFF)
-			{
-				Int ping = doPing(IP, req.timeout);
-				if (ping >= 0)
-				{
-					totalPing += ping;
-					++goodReps;
-				}
-
-				// end our timeslice
-				Switch_Thread();
-			}
-			if (!goodReps)
-				totalPing = -1;
-			else
-				totalPing = totalPing / goodReps;
-
-			PingResponse resp;
-			resp.hostname = req.hostname;
-			resp.avgPing = totalPing;
-			resp.repetitions = goodReps;
-			ThePinger->addResponse(resp);
-		}
+	DEBUG_LOG(("PingThreadClass - couldn't open an ICMP socket, pings will all time out\n"));
+	m_socket = -1;
+	return false;
+}
+
+void PingThreadClass::closeSocket( void )
+{
+	if (m_socket >= 0)
+		closesocket(m_socket);
+	m_socket = -1;
+}
+
+UnsignedInt PingThreadClass::resolve( const std::string& hostname )
+{
+	std::map<std::string, UnsignedInt>::const_iterator it = m_resolvedHosts.find(hostname);
+	if (it != m_resolvedHosts.end())
+		return it->second;
 
-		// end our timeslice
-		Switch_Thread();
+	const char *hostnameBuffer = hostname.c_str();
+	UnsignedInt IP = 0xFFFFFFFF;	// flag for IP resolve failed
+	if (isdigit(hostnameBuffer[0]))
+	{
+		IP = inet_addr(hostnameBuffer);
+	}
+	else
+	{
+		hostent *hostStruct = gethostbyname(hostnameBuffer);
+		if (hostStruct != NULL)
+			IP = ((in_addr *)hostStruct->h_addr)->s_addr;
 	}
 
-	// WSACleanup();
-	} catch ( ... ) {
-		DEBUG_CRASH(("Exception in ping thread!"));
+	in_addr hostNode;
+	hostNode.s_addr = IP;
+	DEBUG_LOG(("pinging %s - IP = %s\n", hostnameBuffer, (IP == 0xFFFFFFFF) ? "lookup failed" : inet_ntoa(hostNode)));
+
+	m_resolvedHosts[hostname] = IP;
+	return IP;
+}
+
+void PingThreadClass::startHost( const PingRequest& req )
+{
+	PingHost host;
+	host.request = req;
+	host.IP = resolve(req.hostname);
+	host.outstanding = 0;
+	host.totalPing = 0;
+	host.goodReps = 0;
+	m_hosts.push_back(host);
+
+	// every repetition goes out right away; a host that couldn't be resolved just finishes with no replies.
+	Int hostIndex = m_hosts.size() - 1;
+	if (host.IP != 0xFFFFFFFF && m_socket >= 0)
+	{
+		for (Int i=0; i<req.repetitions; ++i)
+			sendProbe(hostIndex);
 	}
-#endif
 }
 
-//-------------------------------------------------------------------------
-//-------------------------------------------------------------------------
-//-------------------------------------------------------------------------
-//-------------------------------------------------------------------------
-//-------------------------------------------------------------------------
-//-------------------------------------------------------------------------
-#if 0
-HANDLE WINAPI IcmpCreateFile(VOID); /* INVALID_HANDLE_VALUE on error */
-BOOL WINAPI IcmpCloseHandle(HANDLE IcmpHandle); /* FALSE on error */
-
-/* Note 2: For the most part, you can refer to RFC 791 for detials
- * on how to fill in values for the IP option information structure. 
- */
-typedef struct ip_option_information
+void PingThreadClass::sendProbe( Int hostIndex )
 {
-   UnsignedByte Ttl;         /* Time To Live (used for traceroute) */
-   UnsignedByte Tos;         /* Type Of Service (usually 0) */
-   UnsignedByte Flags;       /* IP header flags (usually 0) */
-   UnsignedByte OptionsSize; /* Size of options data (usually 0, max 40) */
-   UnsignedByte FAR *OptionsData;   /* Options data buffer */
+	PingHost& host = m_hosts[hostIndex];
+	UnsignedShort sequence = m_nextSequence++;
+
+	UnsignedByte packet[ICMP_HEADER_SIZE + PING_DATA_SIZE];
+	packet[0] = ICMP_ECHO_REQUEST;
+	packet[1] = 0;
+	packet[2] = packet[3] = 0;
+	packet[4] = m_identifier >> 8;
+	packet[5] = m_identifier & 0xff;
+	packet[6] = sequence >> 8;
+	packet[7] = sequence & 0xff;
+	for (Int i=0; i<PING_DATA_SIZE; ++i)
+		packet[ICMP_HEADER_SIZE + i] = ' ' + i;
+	UnsignedShort checksum = icmpChecksum(packet, sizeof(packet));
+	packet[2] = checksum >> 8;
+	packet[3] = checksum & 0xff;
+
+	sockaddr_in to;
+	memset(&to, 0, sizeof(to));
+	to.sin_family = AF_INET;
+	to.sin_addr.s_addr = host.IP;
+
+	PingProbe probe;
+	probe.hostIndex = hostIndex;
+	probe.sendTime = timeGetTime();
+
+	// if the send fails, the probe just times out like any other lost ping
+	sendto(m_socket, (const char *)packet, sizeof(packet), 0, (sockaddr *)&to, sizeof(to));
+
+	m_probes[sequence] = probe;
+	++host.outstanding;
+
+	PingTimeout timeout;
+	timeout.deadline = probe.sendTime + host.request.timeout;
+	timeout.sequence = sequence;
+	m_timeouts.push(timeout);
+}
+
+void PingThreadClass::readReplies( Int waitMs )
+{
+	if (m_socket < 0)
+	{
+		Sleep_Ms(waitMs);
+		return;
+	}
+
+	for (;;)
+	{
+		fd_set readSet;
+		FD_ZERO(&readSet);
+		FD_SET(m_socket, &readSet);
+		timeval tv;
+		tv.tv_sec = 0;
+		tv.tv_usec = waitMs * 1000;
+		if (select(m_socket + 1, &readSet, NULL, NULL, &tv) <= 0)
+			return;
+		waitMs = 0;	// only wait for the first one
+
+		UnsignedByte buffer[1500];
+		sockaddr_in from;
+		socklen_t fromLen = sizeof(from);
+		Int len = recvfrom(m_socket, (char *)buffer, sizeof(buffer), 0, (sockaddr *)&from, &fromLen);
+		UnsignedInt now = timeGetTime();
+		if (len <= 0)
+			return;
+
+		UnsignedByte *icmp = buffer;
+		if (m_rawSocket)
+		{
+			Int ipHeaderLen = (buffer[0] & 0x0f) * 4;
+			icmp += ipHeaderLen;
+			len -= ipHeaderLen;
+		}
+		if (len < ICMP_HEADER_SIZE || icmp[0] != ICMP_ECHO_REPLY)
+			continue;
+
+		// ICMP sockets fill in their own identifier, so only raw ones can check it.
+		UnsignedShort identifier = (icmp[4] << 8) | icmp[5];
+		if (m_rawSocket && identifier != m_identifier)
+			continue;
+
+		UnsignedShort sequence = (icmp[6] << 8) | icmp[7];
+		std::map<UnsignedShort, PingProbe>::iterator it = m_probes.find(sequence);
+		if (it == m_probes.end())
+			continue;
+
+		PingHost& host = m_hosts[it->second.hostIndex];
+		if (from.sin_addr.s_addr != host.IP)
+			continue;
+
+		Int ping = now - it->second.sendTime;
+		if (ping > host.request.timeout)
+			ping = host.request.timeout;
+		host.totalPing += ping;
+		++host.goodReps;
+		--host.outstanding;
+		m_probes.erase(it);
+	}
 }
-IPINFO, *PIPINFO, FAR *LPIPINFO;
 
+void PingThreadClass::expireProbes( void )
+{
+	UnsignedInt now = timeGetTime();
+	while (!m_timeouts.empty() && (Int)(now - m_timeouts.top().deadline) >= 0)
+	{
+		std::map<UnsignedShort, PingProbe>::iterator it = m_probes.find(m_timeouts.top().sequence);
+		m_timeouts.pop();
+		if (it == m_probes.end())
+			continue;	// already answered
+
+		--m_hosts[it->second.hostIndex].outstanding;
+		m_probes.erase(it);
+	}
+}
 
-/* Note 1: The Reply Buffer will have an array of ICMP_ECHO_REPLY
- * structures, followed by options and the data in ICMP echo reply
- * datagram received. You must have room for at least one ICMP
- * echo reply structure, plus 8 bytes for an ICMP header. 
- */
-typedef struct icmp_echo_reply
+// Hand back every host that's done, without waiting on the slower ones.
+void PingThreadClass::finishHosts( void )
 {
-   UnsignedInt Address;     /* source address */
-   ////////UnsignedInt Status;      /* IP status value (see below) */
-   UnsignedInt RTTime;      /* Round Trip Time in milliseconds */
-   UnsignedShort DataSize;   /* reply data size */
-   UnsignedShort Reserved;   /* */
-   void FAR *Data;     /* reply data buffer */
-   struct ip_option_information Options; /* reply options */
+	Bool allDone = true;
+	for (Int i=0; i<m_hosts.size(); ++i)
+	{
+		PingHost& host = m_hosts[i];
+		if (host.outstanding > 0)
+		{
+			allDone = false;
+			continue;
+		}
+		if (host.request.repetitions < 0)
+			continue;	// already reported
+
+		PingResponse resp;
+		resp.hostname = host.request.hostname;
+		resp.avgPing = (host.goodReps) ? host.totalPing / host.goodReps : -1;
+		resp.repetitions = host.goodReps;
+		ThePinger->addResponse(resp);
+
+		host.request.repetitions = -1;
+	}
+
+	// host indices are only held by outstanding probes, so once there are none the list can start over,
+	// and anything left in the heap is for probes that were answered.
+	if (allDone)
+	{
+		m_hosts.clear();
+		m_timeouts = PingTimeoutHeap();
+	}
 }
-ICMPECHO, *PICMPECHO, FAR *LPICMPECHO;
-
-
-DWORD WINAPI IcmpSendEcho(
-   HANDLE IcmpHandle,   /* handle returned from IcmpCreateFile() */
-   UnsignedInt DestAddress,  /* destination IP address (in network order) */
-   LPVOID RequestData,  /* pointer to buffer to send */
-   WORD RequestSize,    /* length of data in buffer */
-   LPIPINFO RequestOptns,   /* see Note 2 */
-   LPVOID ReplyBuffer,  /* see Note 1 */
-   DWORD ReplySize,     /* length of reply (must allow at least 1 reply) */
-   DWORD Timeout       /* time in milliseconds to wait for reply */
-);
-
-
-#define IP_STATUS_BASE 11000
-#define IP_SUCCESS 0
-#define IP_BUF_TOO_SMALL (IP_STATUS_BASE + 1)
-#define IP_DEST_NET_UNREACHABLE (IP_STATUS_BASE + 2)
-#define IP_DEST_HOST_UNREACHABLE (IP_STATUS_BASE + 3)
-#define IP_DEST_PROT_UNREACHABLE (IP_STATUS_BASE + 4)
-#define IP_DEST_PORT_UNREACHABLE (IP_STATUS_BASE + 5)
-#define IP_NO_RESOURCES (IP_STATUS_BASE + 6)
-#define IP_BAD_OPTION (IP_STATUS_BASE + 7)
-#define IP_HW_ERROR (IP_STATUS_BASE + 8)
-#define IP_PACKET_TOO_BIG (IP_STATUS_BASE + 9)
-#define IP_REQ_TIMED_OUT (IP_STATUS_BASE + 10)
-#define IP_BAD_REQ (IP_STATUS_BASE + 11)
-#define IP_BAD_ROUTE (IP_STATUS_BASE + 12)
-#define IP_TTL_EXPIRED_TRANSIT (IP_STATUS_BASE + 13)
-#define IP_TTL_EXPIRED_REASSEM (IP_STATUS_BASE + 14)
-#define IP_PARAM_PROBLEM (IP_STATUS_BASE + 15)
-#define IP_SOURCE_QUENCH (IP_STATUS_BASE + 16)
-#define IP_OPTION_TOO_BIG (IP_STATUS_BASE + 17)
-#define IP_BAD_DESTINATION (IP_STATUS_BASE + 18)
-#define IP_ADDR_DELETED (IP_STATUS_BASE + 19)
-#define IP_SPEC_MTU_CHANGE (IP_STATUS_BASE + 20)
-#define IP_MTU_CHANGE (IP_STATUS_BASE + 21)
-#define IP_UNLOAD (IP_STATUS_BASE + 22)
-#define IP_GENERAL_FAILURE (IP_STATUS_BASE + 50)
-#define MAX_IP_STATUS IP_GENERAL_FAILURE
-#define IP_PENDING (IP_STATUS_BASE + 255)
-
-
-#define BUFSIZE     8192
-#define DEFAULT_LEN 32
-#define LOOPLIMIT   4
-#define DEFAULT_TTL 64
-
-Int PingThreadClass::doPing(UnsignedInt IP, Int timeout)
+
+void PingThreadClass::Thread_Function()
 {
-   /*
-    * Initialize default settings 
-    */
-
-   IPINFO stIPInfo, *lpstIPInfo;
-   HANDLE hICMP, hICMP_DLL;
-   int i, j, nDataLen, nLoopLimit, nTimeOut, nTTL, nTOS;
-   DWORD dwReplyCount;
-   ///////IN_ADDR stDestAddr;
-   BOOL fRet, fDontStop;
-   ///BOOL fTraceRoute;
-
-   nDataLen = DEFAULT_LEN;
-   nLoopLimit = LOOPLIMIT;
-   nTimeOut = timeout;
-   fDontStop = FALSE;
-   lpstIPInfo = NULL;
-   nTTL = DEFAULT_TTL;
-   nTOS = 0;
-
-   Int pingTime = -1;  // in case of error
-
-   char achReqData[BUFSIZE];
-   char achRepData[sizeof(ICMPECHO) + BUFSIZE];
-
-
-   HANDLE ( WINAPI *lpfnIcmpCreateFile )( VOID ) = 0;
-   BOOL ( WINAPI *lpfnIcmpCloseHandle )( HANDLE ) = 0;
-   DWORD (WINAPI *lpfnIcmpSendEcho)(HANDLE, DWORD, LPVOID, WORD, LPVOID,
-                                    LPVOID, DWORD, DWORD) = 0;
-
-
-   /*
-    *  Load the ICMP.DLL
-    */
-   hICMP_DLL = LoadLibrary("ICMP.DLL");
-   if (hICMP_DLL == 0)
-   {
-      DEBUG_LOG(("LoadLibrary() failed: Unable to locate ICMP.DLL!\n"));
-      goto cleanup;
-   }
-
-   /*
-    * Get pointers to ICMP.DLL functions
-    */
-   lpfnIcmpCreateFile = (void * (__stdcall *)(void))GetProcAddress( (HINSTANCE)hICMP_DLL, "IcmpCreateFile");
-   lpfnIcmpCloseHandle = (int (__stdcall *)(void *))GetProcAddress( (HINSTANCE)hICMP_DLL, "IcmpCloseHandle");
-   lpfnIcmpSendEcho = (unsigned long (__stdcall *)(void *, unsigned long, void *, unsigned short,
-                       void *, void *, unsigned long, unsigned long))GetProcAddress( (HINSTANCE)hICMP_DLL, "IcmpSendEcho" );
-
-   if ((!lpfnIcmpCreateFile) ||
-         (!lpfnIcmpCloseHandle) ||
-         (!lpfnIcmpSendEcho))
-   {
-      DEBUG_LOG(("GetProcAddr() failed for at least one function.\n"));
-      goto cleanup;
-   }
-
-
-   /*
-    * IcmpCreateFile() - Open the ping service
-    */
-   hICMP = (HANDLE) lpfnIcmpCreateFile();
-   if (hICMP == INVALID_HANDLE_VALUE)
-   {
-      DEBUG_LOG(("IcmpCreateFile() failed"));
-      goto cleanup;
-   }
-
-   /*
-    * Init data buffer printable ASCII 
-    *  32 (space) through 126 (tilde)
-    */
-   for (j = 0, i = 32; j < nDataLen; j++, i++)
-   {
-      if (i >= 126)
-         i = 32;
-      achReqData[j] = i;
-   }
-
-   /*
-   * Init IPInfo structure
-   */
-   lpstIPInfo = &stIPInfo;
-   stIPInfo.Ttl = nTTL;
-   stIPInfo.Tos = nTOS;
-   stIPInfo.Flags = 0;
-   stIPInfo.OptionsSize = 0;
-   stIPInfo.OptionsData = NULL;
-
-
-
-   /*
-    * IcmpSendEcho() - Send the ICMP Echo Request
-    *                   and read the Reply
-    */
-   dwReplyCount = lpfnIcmpSendEcho(
-                     hICMP,
-                     IP,
-                     achReqData,
-                     nDataLen,
-                     lpstIPInfo,
-                     achRepData,
-                     sizeof(achRepData),
-                     nTimeOut);
-   if (dwReplyCount != 0)
-   {
-      //////////IN_ADDR stDestAddr;
-      DWORD dwStatus;
-
-      pingTime = (*(UnsignedInt *) & (achRepData[8]));
-
-      // I've seen the ping time bigger than the timeout by a little
-      //   bit.  How lame.
-      if (pingTime > timeout)
-         pingTime = timeout;
-
-      dwStatus = *(DWORD *) & (achRepData[4]);
-      if (dwStatus != IP_SUCCESS)
-      {
-         DEBUG_LOG(("ICMPERR: %d\n", dwStatus));
-      }
-
-   }
-   else
-   {
-      DEBUG_LOG(("IcmpSendEcho() failed: %d\n", dwReplyCount));
-      // Ok we didn't get a packet, just say everything's OK
-      //  and the time was -1
-      pingTime = -1;
-      goto cleanup;
-   }
-
-
-   /*
-    * IcmpCloseHandle - Close the ICMP handle
-    */
-   fRet = lpfnIcmpCloseHandle(hICMP);
-   if (fRet == FALSE)
-   {
-      DEBUG_LOG(("Error closing ICMP handle\n"));
-   }
-
-   // Say what you will about goto's but it's handy for stuff like this
-cleanup:
-
-   // Shut down...
-   if (hICMP_DLL)
-      FreeLibrary((HINSTANCE)hICMP_DLL);
-
-   return pingTime;
+	try {
+	// _set_se_translator( DumpExceptionInfo ); // Hook that allows stack trace.
+
+	openSocket();
+	m_identifier = (UnsignedShort)timeGetTime();
+	m_nextSequence = 0;
+
+	PingRequest req;
+	while ( running )
+	{
+		// start on everything that's been asked for
+		while (ThePinger->getRequest(req))
+			startHost(req);
+
+		// wait for echoes until the next probe is due to time out, but not so long that new requests sit around
+		Int waitMs = PING_POLL_MS;
+		if (!m_timeouts.empty())
+			waitMs = min(waitMs, max(0, (Int)(m_timeouts.top().deadline - timeGetTime())));
+		readReplies(waitMs);
+
+		expireProbes();
+		finishHosts();
+	}
+
+	closeSocket();
+	} catch ( ... ) {
+		DEBUG_CRASH(("Exception in ping thread!"));
+	}
 }
-#endif
 
 
 //-------------------------------------------------------------------------
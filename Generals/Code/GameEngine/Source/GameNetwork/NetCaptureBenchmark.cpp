@@ -0,0 +1,437 @@
+/*
+**	Command & Conquer Generals(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+/** NetCaptureBenchmark.cpp */
+
+#include "PreRTS.h"	// This must go first in EVERY cpp file int the GameEngine
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+
+#include "Common/FrameProfiler.h"
+#include "GameClient/DisconnectMenu.h"
+#include "GameLogic/GameLogic.h"
+#include "GameNetwork/NetCaptureBenchmark.h"
+#include "GameNetwork/ConnectionManager.h"
+#include "GameNetwork/GameInfo.h"
+#include "GameNetwork/NetCommandList.h"
+#include "GameNetwork/NetCommandWrapperList.h"
+#include "GameNetwork/NetPacket.h"
+#include "GameNetwork/NetworkUtil.h"
+#include "GameNetwork/Transport.h"
+
+/**
+ * A Transport with the capture where its socket would be.
+ */
+class CaptureTransport : public Transport
+{
+public:
+	CaptureTransport(NetCaptureBenchmark *benchmark)
+	{
+		m_benchmark = benchmark;
+	}
+
+	virtual Bool doRecv( void )
+	{
+		m_benchmark->receive(this);
+		return TRUE;
+	}
+
+	virtual Bool doSend( void )
+	{
+		for (Int i = 0; i < MAX_MESSAGES; ++i) {
+			if (m_outBuffer[i].length != 0) {
+				m_benchmark->send(&m_outBuffer[i], m_outBuffer[i].length + sizeof(TransportMessageHeader));
+				m_outBuffer[i].length = 0;
+			}
+		}
+		return TRUE;
+	}
+
+private:
+	NetCaptureBenchmark *m_benchmark;
+};
+
+NetCaptureBenchmark::NetCaptureBenchmark()
+{
+	m_data = NULL;
+	m_dataLength = 0;
+	m_offset = 0;
+
+	m_conMgr = NULL;
+	m_localSlot = -1;
+	m_frame = 0;
+	m_sentWrappers = NULL;
+	memset(m_sentIDs, 0, sizeof(m_sentIDs));
+
+	m_datagramsSent = 0;
+	m_datagramsReceived = 0;
+	m_datagramsBad = 0;
+	m_bytes = 0;
+	m_localCommands = 0;
+	m_framesRun = 0;
+	m_packetsBuilt = 0;
+	m_bytesBuilt = 0;
+	m_updates = 0;
+
+	m_updateNS = 0;
+	m_longestUpdateNS = 0;
+	m_localNS = 0;
+	m_frameNS = 0;
+}
+
+NetCaptureBenchmark::~NetCaptureBenchmark()
+{
+	// the ConnectionManager deletes its CaptureTransport, so this has to happen while we're still here.
+	if (m_conMgr != NULL) {
+		delete m_conMgr;
+		m_conMgr = NULL;
+	}
+
+	if (m_sentWrappers != NULL) {
+		m_sentWrappers->reset();
+		m_sentWrappers->deleteInstance();
+		m_sentWrappers = NULL;
+	}
+
+	delete[] m_data;
+	m_data = NULL;
+}
+
+/**
+ * Read the whole capture file into memory and check that it's one we know how to read.
+ */
+Bool NetCaptureBenchmark::load(const char *filename)
+{
+	FILE *fp = fopen(filename, "rb");
+	if (fp == NULL) {
+		DEBUG_LOG(("NetCaptureBenchmark::load - couldn't open %s\n", filename));
+		return FALSE;
+	}
+
+	fseek(fp, 0, SEEK_END);
+	m_dataLength = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+
+	m_data = NEW UnsignedByte[m_dataLength > 0 ? m_dataLength : 1];
+	Bool ok = (m_dataLength >= (Int)sizeof(NetCaptureFileHeader)) && (fread(m_data, m_dataLength, 1, fp) == 1);
+	fclose(fp);
+
+	if (ok) {
+		const NetCaptureFileHeader *header = (const NetCaptureFileHeader *)m_data;
+		ok = (header->magic == NET_CAPTURE_MAGIC) && (header->version == NET_CAPTURE_VERSION);
+	}
+
+	if (!ok) {
+		DEBUG_LOG(("NetCaptureBenchmark::load - %s is not a network capture\n", filename));
+	}
+	m_offset = sizeof(NetCaptureFileHeader);
+	return ok;
+}
+
+/**
+ * Run the capture through the network code and log the results.
+ */
+Bool NetCaptureBenchmark::run(const char *filename)
+{
+	if (!load(filename)) {
+		return FALSE;
+	}
+
+	m_sentWrappers = newInstance(NetCommandWrapperList);
+	m_sentWrappers->init();
+
+	Int64 startNS = FrameProfiler::getTimeNS();
+
+	const NetCaptureRecord *record = getRecord();
+	while (record != NULL) {
+		if (record->direction == NET_CAPTURE_USERS) {
+			if ((m_conMgr == NULL) && (record->length == sizeof(NetCaptureUsers))) {
+				start((const NetCaptureUsers *)(record + 1));
+			}
+			m_offset += sizeof(NetCaptureRecord) + record->length;
+		} else if (m_conMgr == NULL) {
+			// the game hadn't started yet, so there's no ConnectionManager to give it to.
+			m_offset += sizeof(NetCaptureRecord) + record->length;
+		} else if (record->direction == NET_CAPTURE_SENT) {
+			processSent(record);
+			m_offset += sizeof(NetCaptureRecord) + record->length;
+		} else {
+			// receive() takes this and the ones after it out of the capture.
+			update();
+		}
+		record = getRecord();
+	}
+
+	if (m_conMgr == NULL) {
+		DEBUG_LOG(("NetCaptureBenchmark::run - %s has no game in it\n", filename));
+		return FALSE;
+	}
+
+	// one more for whatever the last datagrams made us send.
+	update();
+
+	logResults(FrameProfiler::getTimeNS() - startNS);
+
+	TheGameLogic->friend_setFrame(0);
+	return TRUE;
+}
+
+/**
+ * The record at m_offset, or NULL at the end of the capture.
+ */
+const NetCaptureRecord * NetCaptureBenchmark::getRecord()
+{
+	if (m_offset + (Int)sizeof(NetCaptureRecord) > m_dataLength) {
+		return NULL;
+	}
+
+	const NetCaptureRecord *record = (const NetCaptureRecord *)(m_data + m_offset);
+	if (m_offset + (Int)sizeof(NetCaptureRecord) + record->length > m_dataLength) {
+		DEBUG_LOG(("NetCaptureBenchmark::getRecord - capture is truncated\n"));
+		m_offset = m_dataLength;
+		return NULL;
+	}
+	return record;
+}
+
+/**
+ * Copy a captured datagram into msg and check it, the same as a datagram off the socket.
+ */
+Bool NetCaptureBenchmark::unpackRecord(const NetCaptureRecord *record, TransportMessage *msg)
+{
+	m_bytes += record->length;
+	if (record->length > sizeof(TransportMessageHeader) + MAX_MESSAGE_LEN) {
+		++m_datagramsBad;
+		msg->length = 0;
+		return FALSE;
+	}
+
+	memcpy(msg, record + 1, record->length);
+	if (!Transport::unpackDatagram(msg, record->length)) {
+		++m_datagramsBad;
+		msg->length = 0;
+		return FALSE;
+	}
+	msg->addr = record->addr;
+	msg->port = record->port;
+	return TRUE;
+}
+
+/**
+ * Set up the ConnectionManager the way a network game start does, see Network::init and
+ * Network::parseUserList.  The addresses don't matter, nothing is really sent anywhere.
+ */
+void NetCaptureBenchmark::start(const NetCaptureUsers *users)
+{
+	SkirmishGameInfo game;
+	game.init();
+	game.enterGame();
+	for (Int i = 0; i < MAX_SLOTS; ++i) {
+		if ((users->playerMask & (1 << i)) != 0) {
+			UnicodeString name;
+			name.format(L"Player %d", i);
+
+			GameSlot slot;
+			slot.setState(SLOT_PLAYER, name, REPLAY_ADDR + i);
+			slot.setPort(REPLAY_PORT);
+			game.setSlot(i, slot);
+		}
+	}
+	m_localSlot = users->localSlot;
+	game.setLocalIP(REPLAY_ADDR + m_localSlot);
+
+	// ConnectionManager makes a disconnect menu, and TheDisconnectMenu only has room for one.
+	if (TheDisconnectMenu != NULL) {
+		delete TheDisconnectMenu;
+		TheDisconnectMenu = NULL;
+	}
+
+	m_conMgr = NEW ConnectionManager;
+	m_conMgr->init();
+	m_conMgr->setLocalAddress(REPLAY_ADDR + m_localSlot, REPLAY_PORT);
+	m_conMgr->attachTransport(NEW CaptureTransport(this));
+	m_conMgr->parseUserList(&game);
+
+	// the run ahead only changes how long sends are held back for, and we don't hold them back.
+	Int runAhead = min(max(30, MIN_RUNAHEAD), MAX_FRAMES_AHEAD/2);
+	m_conMgr->destroyGameMessages();
+	m_conMgr->zeroFrames(1, runAhead - 1);
+	m_conMgr->setFrameGrouping(0);
+
+	// the game starts on frame 1 and frame 0 is thrown away, as in Network::processCommand.
+	m_frame = 1;
+	TheGameLogic->friend_setFrame(m_frame);
+	NetCommandList *list = m_conMgr->getFrameCommandList(0);
+	list->deleteInstance();
+}
+
+/**
+ * Something the game sent.  Every command of the local player's that we haven't seen yet goes to
+ * the ConnectionManager, which sends it again and keeps it for its frame.
+ */
+void NetCaptureBenchmark::processSent(const NetCaptureRecord *record)
+{
+	TransportMessage msg;
+	if (!unpackRecord(record, &msg)) {
+		return;
+	}
+	++m_datagramsSent;
+
+	Int64 startNS = FrameProfiler::getTimeNS();
+	NetPacket *packet = newInstance(NetPacket)(&msg);
+	NetCommandList *cmdList = packet->getCommandList();
+
+	NetCommandRef *ref = cmdList->getFirstMessage();
+	while (ref != NULL) {
+		if (ref->getCommand()->getNetCommandType() == NETCOMMANDTYPE_WRAPPER) {
+			m_sentWrappers->processWrapper(ref);
+		} else {
+			sendLocalCommand(ref->getCommand());
+		}
+		ref = ref->getNext();
+	}
+
+	packet->deleteInstance();
+	packet = NULL;
+
+	cmdList->deleteInstance();
+	cmdList = NULL;
+
+	cmdList = m_sentWrappers->getReadyCommands();
+	ref = cmdList->getFirstMessage();
+	while (ref != NULL) {
+		sendLocalCommand(ref->getCommand());
+		ref = ref->getNext();
+	}
+
+	cmdList->deleteInstance();
+	cmdList = NULL;
+	m_localNS += FrameProfiler::getTimeNS() - startNS;
+}
+
+/**
+ * The packet router sends each command once per player, and anything that isn't acked in time
+ * gets sent again, so only the first copy of each goes through.
+ */
+void NetCaptureBenchmark::sendLocalCommand(NetCommandMsg *msg)
+{
+	if ((msg->getPlayerID() != m_localSlot) || !IsCommandSynchronized(msg->getNetCommandType())) {
+		return;
+	}
+
+	UnsignedShort id = msg->getID();
+	if ((m_sentIDs[id / 8] & (1 << (id % 8))) != 0) {
+		return;
+	}
+	m_sentIDs[id / 8] |= 1 << (id % 8);
+
+	// IDs wrap around, so forget the one that's half way round from this.
+	UnsignedShort oldID = id + 0x8000;
+	m_sentIDs[oldID / 8] &= ~(1 << (oldID % 8));
+
+	// the frame info is what ConnectionManager::processFrameTick sends, everything else is from sendLocalCommand.
+	if (msg->getNetCommandType() == NETCOMMANDTYPE_FRAMEINFO) {
+		m_conMgr->sendLocalCommand(msg, 0xff & ~(1 << m_localSlot));
+	} else {
+		m_conMgr->sendLocalCommand(msg);
+	}
+	++m_localCommands;
+}
+
+/**
+ * One ConnectionManager::update, then run every frame that's ready the way Network does.
+ */
+void NetCaptureBenchmark::update()
+{
+	Int64 startNS = FrameProfiler::getTimeNS();
+	m_conMgr->update(FALSE);
+	Int64 updateNS = FrameProfiler::getTimeNS() - startNS;
+	m_updateNS += updateNS;
+	if (updateNS > m_longestUpdateNS) {
+		m_longestUpdateNS = updateNS;
+	}
+	++m_updates;
+
+	startNS = FrameProfiler::getTimeNS();
+	while (m_conMgr->allCommandsReady(m_frame)) {
+		m_conMgr->handleAllCommandsReady();
+		NetCommandList *list = m_conMgr->getFrameCommandList(m_frame);
+		list->deleteInstance();
+
+		++m_framesRun;
+		++m_frame;
+		TheGameLogic->friend_setFrame(m_frame);
+	}
+	m_frameNS += FrameProfiler::getTimeNS() - startNS;
+}
+
+/**
+ * Everything the game received from here up to the next thing it sent, or as much of it as there's
+ * room for, the same as Transport::doRecv off the socket.
+ */
+void NetCaptureBenchmark::receive(Transport *transport)
+{
+	Int slot = 0;
+	const NetCaptureRecord *record = getRecord();
+	while ((record != NULL) && (record->direction == NET_CAPTURE_RECEIVED)) {
+		while ((slot < MAX_MESSAGES) && (transport->m_inBuffer[slot].length != 0)) {
+			++slot;
+		}
+		if (slot == MAX_MESSAGES) {
+			break;
+		}
+
+		if (unpackRecord(record, &transport->m_inBuffer[slot])) {
+			++m_datagramsReceived;
+		}
+		m_offset += sizeof(NetCaptureRecord) + record->length;
+		record = getRecord();
+	}
+}
+
+void NetCaptureBenchmark::send(TransportMessage *msg, Int len)
+{
+	++m_packetsBuilt;
+	m_bytesBuilt += len;
+}
+
+void NetCaptureBenchmark::logResults(Int64 totalNS)
+{
+	Real seconds = totalNS / 1000000000.0f;
+	Int datagrams = m_datagramsSent + m_datagramsReceived;
+
+	DEBUG_LOG(("NetCaptureBenchmark - %d datagrams (%d sent, %d received, %d bad), %d bytes, local player %d\n",
+		datagrams, m_datagramsSent, m_datagramsReceived, m_datagramsBad, m_bytes, m_localSlot));
+	DEBUG_LOG(("NetCaptureBenchmark - %d local commands, %d frames run, %d packets (%d bytes) sent by the replay\n",
+		m_localCommands, m_framesRun, m_packetsBuilt, m_bytesBuilt));
+	DEBUG_LOG(("NetCaptureBenchmark - %d updates, %.3fms in ConnectionManager::update (%.1fus each, longest %.1fus)\n",
+		m_updates, m_updateNS / 1000000.0f, m_updates > 0 ? (m_updateNS / 1000.0f) / m_updates : 0.0f, m_longestUpdateNS / 1000.0f));
+	DEBUG_LOG(("NetCaptureBenchmark - local commands %.3fms, frames %.3fms, total %.3fms\n",
+		m_localNS / 1000000.0f, m_frameNS / 1000000.0f, totalNS / 1000000.0f));
+	if (seconds > 0.0f) {
+		DEBUG_LOG(("NetCaptureBenchmark - %.0f datagrams per second\n", datagrams / seconds));
+	}
+}
+
+#endif // defined(_DEBUG) || defined(_INTERNAL)
@@ -35,6 +35,7 @@ NetCommandList::NetCommandList() {
 	m_first = NULL;
 	m_last = NULL;
 	m_lastMessageInserted = NULL;
+	m_length = 0;
 }
 
 /**
@@ -77,6 +78,26 @@ NetCommandRef *NetCommandList::getFirstMessage() {
  * Remove the given message from this list.
  */
 void NetCommandList::removeMessage(NetCommandRef *msg) {
+	NetCommandMsg *cmdMsg = msg->getCommand();
+	if (DoesCommandRequireACommandID(cmdMsg->getNetCommandType())) {
+		NetCommandRefMap::iterator it = m_commandIndex.find(getCommandKey(cmdMsg->getID(), cmdMsg->getPlayerID()));
+		if ((it != m_commandIndex.end()) && (it->second == msg)) {
+			m_commandIndex.erase(it);
+		}
+	}
+
+	UnsignedInt sectionKey = getSectionKey(cmdMsg);
+	NetCommandSectionMap::iterator tail = m_sectionTails.find(sectionKey);
+	if ((tail != m_sectionTails.end()) && (tail->second == msg)) {
+		// The node before this one becomes the end of the section, unless this was the only node in it.
+		NetCommandRef *prev = msg->getPrev();
+		if ((prev != NULL) && (getSectionKey(prev->getCommand()) == sectionKey)) {
+			tail->second = prev;
+		} else {
+			m_sectionTails.erase(tail);
+		}
+	}
+
 	if (m_lastMessageInserted == msg) {
 		m_lastMessageInserted = msg->getNext();
 	}
@@ -97,6 +118,7 @@ void NetCommandList::removeMessage(NetCommandRef *msg) {
 
 	msg->setNext(NULL);
 	msg->setPrev(NULL);
+	--m_length;
 }
 
 /**
@@ -120,254 +142,175 @@ void NetCommandList::reset() {
 	}
 	m_last = NULL;
 	m_lastMessageInserted = NULL;
+	m_length = 0;
+	m_commandIndex.clear();
+	m_sectionTails.clear();
 }
 
 /**
- * Insert sorts msg.  Assumes that all the previous message inserts were done using this function.
- * The message is sorted in based first on command type, then player id, and then command id.
+ * Commands that require a command id are unique by player id and command id.
  */
-NetCommandRef * NetCommandList::addMessage(NetCommandMsg *cmdMsg) {
-	if (cmdMsg == NULL) {
-		DEBUG_ASSERTCRASH(cmdMsg != NULL, ("NetCommandList::addMessage - command message was NULL"));
-		return NULL;
-	}
-
-//	UnsignedInt id = cmdMsg->getID();
+UnsignedInt NetCommandList::getCommandKey(UnsignedShort commandID, UnsignedByte playerID) {
+	return ((UnsignedInt)playerID << 16) | commandID;
+}
 
-	NetCommandRef *msg = NEW_NETCOMMANDREF(cmdMsg);
+/**
+ * Sorts the same way the sections are ordered in the list, first by command type and then by player id.
+ */
+UnsignedInt NetCommandList::getSectionKey(NetCommandMsg *msg) {
+	// NETCOMMANDTYPE_UNKNOWN is -1, so shift the types up by one to keep them in order.
+	return ((UnsignedInt)(msg->getNetCommandType() + 1) << 8) | (msg->getPlayerID() & 0xff);
+}
 
-	if (m_first == NULL) {
-		// this is the first node, so we don't have to worry about ordering it.
-		m_first = msg;
-		m_last = msg;
-		m_lastMessageInserted = msg;
-		return msg;
-	}
+/**
+ * Find the node the given message should be inserted after.  Returns NULL if it goes at the head of the list.
+ * Within a section the message goes before any nodes with the same sort number.
+ */
+NetCommandRef * NetCommandList::findInsertPosition(NetCommandMsg *msg) {
+	UnsignedInt sectionKey = getSectionKey(msg);
+	Int sortNumber = msg->getSortNumber();
 
 	if (m_lastMessageInserted != NULL) {
 		// Messages that are inserted in order should just be put in one right after the other.
 		// So saving the placement of the last message inserted can give us a huge boost in
 		// efficiency.
 		NetCommandRef *theNext = m_lastMessageInserted->getNext();
-		if ((m_lastMessageInserted->getCommand()->getNetCommandType() == msg->getCommand()->getNetCommandType()) &&
-			(m_lastMessageInserted->getCommand()->getPlayerID() == msg->getCommand()->getPlayerID()) &&
-			(m_lastMessageInserted->getCommand()->getID() < msg->getCommand()->getID()) &&
-			((theNext == NULL) || ((theNext->getCommand()->getNetCommandType() > msg->getCommand()->getNetCommandType()) ||
-			 (theNext->getCommand()->getPlayerID() > msg->getCommand()->getPlayerID()) ||
-			 (theNext->getCommand()->getID() > msg->getCommand()->getID())))) {
-
-			// Make sure this command isn't already in the list.
-			if (isEqualCommandMsg(m_lastMessageInserted->getCommand(), msg->getCommand())) {
-
-				// This command is already in the list, don't duplicate it.
-				msg->deleteInstance();
-				msg = NULL;
-				return NULL;
-			}
-
-			if (theNext == NULL) {
-				// this means that m_lastMessageInserted == m_last, so m_last should point to the msg that is being inserted.
-				msg->setNext(m_lastMessageInserted->getNext());
-				msg->setPrev(m_lastMessageInserted);
-				m_lastMessageInserted->setNext(msg);
-				m_lastMessageInserted = msg;
-				m_last = msg;
-			} else {
-				msg->setNext(m_lastMessageInserted->getNext());
-				msg->setPrev(m_lastMessageInserted);
-				m_lastMessageInserted->setNext(msg);
-				msg->getNext()->setPrev(msg);
-				m_lastMessageInserted = msg;
-			}
-			return msg;
+		if ((getSectionKey(m_lastMessageInserted->getCommand()) == sectionKey) &&
+				(m_lastMessageInserted->getCommand()->getSortNumber() < sortNumber) &&
+				((theNext == NULL) || (getSectionKey(theNext->getCommand()) != sectionKey) || (theNext->getCommand()->getSortNumber() >= sortNumber))) {
+			return m_lastMessageInserted;
 		}
 	}
-	
-	if (msg->getCommand()->getNetCommandType() > m_last->getCommand()->getNetCommandType()) {
-		// easy optimization for a command that goes at the end of the list
-		// since they are likely to be added in order.
 
-		// Make sure this command isn't already in the list.
-		if (isEqualCommandMsg(m_last->getCommand(), msg->getCommand())) {
-
-			// This command is already in the list, don't duplicate it.
-			msg->deleteInstance();
-			msg = NULL;
-			return NULL;
+	NetCommandSectionMap::iterator it = m_sectionTails.lower_bound(sectionKey);
+	if ((it != m_sectionTails.end()) && (it->first == sectionKey)) {
+		// Walk back from the end of the section to the last node that sorts before this one.
+		// Commands almost always arrive in order, so this usually stops right away.
+		NetCommandRef *prev = it->second;
+		while ((prev != NULL) && (getSectionKey(prev->getCommand()) == sectionKey) && (prev->getCommand()->getSortNumber() >= sortNumber)) {
+			prev = prev->getPrev();
 		}
+		return prev;
+	}
 
-		msg->setPrev(m_last);
-		msg->setNext(NULL);
-		m_last->setNext(msg);
-		m_last = msg;
-		m_lastMessageInserted = msg;
-		return msg;
+	// This is a new section, it goes right after the section before it.
+	if (it == m_sectionTails.begin()) {
+		return NULL;
 	}
-	
-	if (msg->getCommand()->getNetCommandType() < m_first->getCommand()->getNetCommandType()) {
-		// Make sure this command isn't already in the list.
-		if (isEqualCommandMsg(m_first->getCommand(), msg->getCommand())) {
-
-			// This command is already in the list, don't duplicate it.
-			msg->deleteInstance();
-			msg = NULL;
-			return NULL;
-		}
+	--it;
+	return it->second;
+}
 
-		// The command goes at the head of the list.
-		msg->setNext(m_first);
-		msg->setPrev(NULL);
-		m_first->setPrev(msg);
+/**
+ * Link msg into the list right after prev, or at the head if prev is NULL.
+ */
+void NetCommandList::insertAfter(NetCommandRef *msg, NetCommandRef *prev) {
+	NetCommandRef *next = (prev != NULL) ? prev->getNext() : m_first;
+
+	msg->setPrev(prev);
+	msg->setNext(next);
+	if (prev != NULL) {
+		prev->setNext(msg);
+	} else {
 		m_first = msg;
-		m_lastMessageInserted = msg;
-		return msg;
-	}
-	
-	
-	// Find the start of the command type we're looking for.
-	NetCommandRef *tempmsg = m_first;
-	while ((tempmsg != NULL) && (msg->getCommand()->getNetCommandType() > tempmsg->getCommand()->getNetCommandType())) {
-		tempmsg = tempmsg->getNext();
 	}
-
-	if (tempmsg == NULL) {
-		// Make sure this command isn't already in the list.
-		if (isEqualCommandMsg(m_last->getCommand(), msg->getCommand())) {
-
-			// This command is already in the list, don't duplicate it.
-			msg->deleteInstance();
-			msg = NULL;
-			return NULL;
-		}
-
-		// message goes at the end of the list.
-		msg->setPrev(m_last);
-		msg->setNext(NULL);
-		m_last->setNext(msg);
+	if (next != NULL) {
+		next->setPrev(msg);
+	} else {
 		m_last = msg;
-		m_lastMessageInserted = msg;
-		return msg;
 	}
 
-	// Now find the player position.  munkee.
-	while ((tempmsg != NULL) && (msg->getCommand()->getNetCommandType() == tempmsg->getCommand()->getNetCommandType()) && (msg->getCommand()->getPlayerID() > tempmsg->getCommand()->getPlayerID())) {
-		tempmsg = tempmsg->getNext();
-	}
-
-	if (tempmsg == NULL) {
-		// Make sure this command isn't already in the list.
-		if (isEqualCommandMsg(m_last->getCommand(), msg->getCommand())) {
-
-			// This command is already in the list, don't duplicate it.
-			msg->deleteInstance();
-			msg = NULL;
-			return NULL;
-		}
+	m_lastMessageInserted = msg;
+	++m_length;
 
-		// message goes at the end of the list.
-		msg->setPrev(m_last);
-		msg->setNext(NULL);
-		m_last->setNext(msg);
-		m_last = msg;
-		m_lastMessageInserted = msg;
-		return msg;
+	NetCommandMsg *cmdMsg = msg->getCommand();
+	if (DoesCommandRequireACommandID(cmdMsg->getNetCommandType())) {
+		m_commandIndex[getCommandKey(cmdMsg->getID(), cmdMsg->getPlayerID())] = msg;
 	}
 
-	// Find the position within the player's section based on the command ID.
-	// If the command type doesn't require a command ID, sort by whatever it should be sorted by.
-	while ((tempmsg != NULL) && (msg->getCommand()->getNetCommandType() == tempmsg->getCommand()->getNetCommandType()) && (msg->getCommand()->getPlayerID() == tempmsg->getCommand()->getPlayerID()) && (msg->getCommand()->getSortNumber() > tempmsg->getCommand()->getSortNumber())) {
-		tempmsg = tempmsg->getNext();
+	// If msg went in after the end of its section, or started a new one, it's the new end.
+	UnsignedInt sectionKey = getSectionKey(cmdMsg);
+	NetCommandSectionMap::iterator tail = m_sectionTails.find(sectionKey);
+	if (tail == m_sectionTails.end()) {
+		m_sectionTails[sectionKey] = msg;
+	} else if (tail->second == prev) {
+		tail->second = msg;
 	}
+}
 
-	if (tempmsg == NULL) {
-		// Make sure this command isn't already in the list.
-		if (isEqualCommandMsg(m_last->getCommand(), msg->getCommand())) {
-
-			// This command is already in the list, don't duplicate it.
-			msg->deleteInstance();
-			msg = NULL;
-			return NULL;
-		}
-
-		// This message goes at the end of the list.
-		msg->setPrev(m_last);
-		msg->setNext(NULL);
-		m_last->setNext(msg);
-		m_last = msg;
-		m_lastMessageInserted = msg;
-		return msg;
+/**
+ * Insert sorts msg.  Assumes that all the previous message inserts were done using this function.
+ * The message is sorted in based first on command type, then player id, and then command id.
+ * Returns NULL without adding anything if the command is already in the list.
+ */
+NetCommandRef * NetCommandList::addMessage(NetCommandMsg *cmdMsg) {
+	if (cmdMsg == NULL) {
+		DEBUG_ASSERTCRASH(cmdMsg != NULL, ("NetCommandList::addMessage - command message was NULL"));
+		return NULL;
 	}
 
-	if (tempmsg == m_first) {
-		// Make sure this command isn't already in the list.
-		if (isEqualCommandMsg(m_first->getCommand(), msg->getCommand())) {
-
-			// This command is already in the list, don't duplicate it.
-			msg->deleteInstance();
+	// Make sure this command isn't already in the list.
+	if (DoesCommandRequireACommandID(cmdMsg->getNetCommandType())) {
+		if (m_commandIndex.find(getCommandKey(cmdMsg->getID(), cmdMsg->getPlayerID())) != m_commandIndex.end()) {
 			return NULL;
 		}
-
-		// This message goes at the head of the list.
-		msg->setNext(m_first);
-		msg->setPrev(NULL);
-		m_first->setPrev(msg);
-		m_first = msg;
-		m_lastMessageInserted = msg;
-		return msg;
 	}
 
-	// Make sure this command isn't already in the list.
-		if (isEqualCommandMsg(tempmsg->getCommand(), msg->getCommand())) {
+	NetCommandRef *prev = findInsertPosition(cmdMsg);
 
-		// This command is already in the list, don't duplicate it.
-		msg->deleteInstance();
-		msg = NULL;
-		return NULL;
+	if (!DoesCommandRequireACommandID(cmdMsg->getNetCommandType())) {
+		// Any duplicate would have the same sort number, so it has to be right after prev.
+		UnsignedInt sectionKey = getSectionKey(cmdMsg);
+		Int sortNumber = cmdMsg->getSortNumber();
+		NetCommandRef *next = (prev != NULL) ? prev->getNext() : m_first;
+		while ((next != NULL) && (getSectionKey(next->getCommand()) == sectionKey) && (next->getCommand()->getSortNumber() == sortNumber)) {
+			if (isEqualCommandMsg(next->getCommand(), cmdMsg)) {
+				return NULL;
+			}
+			next = next->getNext();
+		}
 	}
 
-	// Insert message before tempmsg.
-	msg->setNext(tempmsg);
-	msg->setPrev(tempmsg->getPrev());
-	msg->getPrev()->setNext(msg);
-	tempmsg->setPrev(msg);
-	m_lastMessageInserted = msg;
-
+	NetCommandRef *msg = NEW_NETCOMMANDREF(cmdMsg);
+	insertAfter(msg, prev);
 	return msg;
 }
 
 Int NetCommandList::length() {
-	Int retval = 0;
-	NetCommandRef *temp = m_first;
-	while (temp != NULL) {
-		++retval;
-		temp = temp->getNext();
-	}
-	return retval;
+	return m_length;
 }
 
 /**
- * This is really inefficient, but we can probably get away with it because
- * there shouldn't be too many messages for any given frame.
+ * Commands that require a command id are looked up in the index, anything else only has to be
+ * searched for in its own section.
  */
 NetCommandRef * NetCommandList::findMessage(NetCommandMsg *msg) {
-	NetCommandRef *retval = m_first;
-	while ((retval != NULL) && (isEqualCommandMsg(retval->getCommand(), msg) == FALSE)) {
-		retval = retval->getNext();
+	if (DoesCommandRequireACommandID(msg->getNetCommandType())) {
+		return findMessage(msg->getID(), msg->getPlayerID());
+	}
+
+	UnsignedInt sectionKey = getSectionKey(msg);
+	NetCommandSectionMap::iterator tail = m_sectionTails.find(sectionKey);
+	if (tail == m_sectionTails.end()) {
+		return NULL;
 	}
-	return retval;
+
+	NetCommandRef *retval = tail->second;
+	while ((retval != NULL) && (getSectionKey(retval->getCommand()) == sectionKey)) {
+		if (isEqualCommandMsg(retval->getCommand(), msg)) {
+			return retval;
+		}
+		retval = retval->getPrev();
+	}
+	return NULL;
 }
 
 NetCommandRef * NetCommandList::findMessage(UnsignedShort commandID, UnsignedByte playerID) {
-	NetCommandRef *retval = m_first;
-	while (retval != NULL) {
-		if (DoesCommandRequireACommandID(retval->getCommand()->getNetCommandType())) {
-			if ((retval->getCommand()->getID() == commandID) && (retval->getCommand()->getPlayerID() == playerID)) {
-				return retval;
-			}
-		}
-		retval = retval->getNext();
+	NetCommandRefMap::iterator it = m_commandIndex.find(getCommandKey(commandID, playerID));
+	if (it == m_commandIndex.end()) {
+		return NULL;
 	}
-	return retval;
+	return it->second;
 }
 
 Bool NetCommandList::isEqualCommandMsg(NetCommandMsg *msg1, NetCommandMsg *msg2) {
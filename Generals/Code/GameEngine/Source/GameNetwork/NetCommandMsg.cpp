@@ -216,6 +216,20 @@ void NetGameCommandMsg::setGameMessageType(GameMessage::Type type) {
 	m_type = type;
 }
 
+/**
+ * Returns the type of game message
+ */
+GameMessage::Type NetGameCommandMsg::getGameMessageType() {
+	return m_type;
+}
+
+/**
+ * Returns the first of the arguments, in the order they were added.
+ */
+GameMessageArgument *NetGameCommandMsg::getArgumentList() {
+	return m_argList;
+}
+
 AsciiString NetGameCommandMsg::getContentsAsAsciiString(void)
 {
 	AsciiString ret;
@@ -909,6 +923,7 @@ NetFileCommandMsg::NetFileCommandMsg() : NetCommandMsg() {
 	m_data = NULL;
 	m_portableFilename.clear();
 	m_dataLength = 0;
+	m_isCompressed = FALSE;
 }
 
 NetFileCommandMsg::~NetFileCommandMsg() {
@@ -45,6 +45,9 @@ NetCommandRef::NetCommandRef(NetCommandMsg *msg)
 	m_prev = NULL;
 	m_msg->attach();
 	m_timeLastSent = -1;
+	m_redundantSends = 0;
+	m_gapResend = FALSE;
+	m_sendClass = -1;
 
 #ifdef DEBUG_NETCOMMANDREF
 	m_id = ++refNum;
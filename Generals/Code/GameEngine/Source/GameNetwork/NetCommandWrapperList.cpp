@@ -34,7 +34,7 @@
 ////// NetCommandWrapperListNode ///////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-NetCommandWrapperListNode::NetCommandWrapperListNode(NetWrapperCommandMsg *msg) 
+NetCommandWrapperListNode::NetCommandWrapperListNode(NetWrapperCommandMsg *msg, UnsignedByte relay) 
 {
 	//Added By Sadullah Nader
 	//Initializations inserted
@@ -54,6 +54,7 @@ NetCommandWrapperListNode::NetCommandWrapperListNode(NetWrapperCommandMsg *msg)
 	m_data = NEW UnsignedByte[m_dataLength];	// pool[]ify
 
 	m_commandID = msg->getWrappedCommandID();
+	m_relay = relay;
 }
 
 NetCommandWrapperListNode::~NetCommandWrapperListNode() {
@@ -116,6 +117,10 @@ UnsignedByte * NetCommandWrapperListNode::getRawData() {
 	return m_data;
 }
 
+UnsignedByte NetCommandWrapperListNode::getRelay() {
+	return m_relay;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 ////// NetCommandWrapperList ///////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -169,7 +174,7 @@ void NetCommandWrapperList::processWrapper(NetCommandRef *ref) {
 	}
 
 	if (temp == NULL) {
-		temp = newInstance(NetCommandWrapperListNode)(msg);
+		temp = newInstance(NetCommandWrapperListNode)(msg, ref->getRelay());
 		temp->m_next = m_list;
 		m_list = temp;
 	}
@@ -190,7 +195,10 @@ NetCommandList * NetCommandWrapperList::getReadyCommands()
 		if (temp->isComplete()) {
 			NetCommandRef *msg = NetPacket::ConstructNetCommandMsgFromRawData(temp->getRawData(), temp->getRawDataLength());
 			NetCommandRef *ret = retlist->addMessage(msg->getCommand());
-			ret->setRelay(msg->getRelay());
+			// The relay inside the wrapped data is whatever the sender split the command with, which
+			// the packet router shares between all the players it relays to.  The wrappers themselves
+			// carry the relay meant for us.
+			ret->setRelay(temp->getRelay());
 
 			msg->deleteInstance();
 			msg = NULL;
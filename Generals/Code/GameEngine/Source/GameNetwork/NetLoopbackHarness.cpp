@@ -0,0 +1,743 @@
+/*
+**	Command & Conquer Generals(tm)
+**	Copyright 2025 Electronic Arts Inc.
+**
+**	This program is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 3 of the License, or
+**	(at your option) any later version.
+**
+**	This program is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+////////////////////////////////////////////////////////////////////////////////
+//																																						//
+//  (c) 2001-2003 Electronic Arts Inc.																				//
+//																																						//
+////////////////////////////////////////////////////////////////////////////////
+
+/** NetLoopbackHarness.cpp */
+
+#include "PreRTS.h"	// This must go first in EVERY cpp file int the GameEngine
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+
+#include "Common/File.h"
+#include "Common/GameState.h"
+#include "Common/LocalFileSystem.h"
+#include "Common/MessageStream.h"
+#include "Common/RandomValue.h"
+#include "GameClient/DisconnectMenu.h"
+#include "GameLogic/GameLogic.h"
+#include "GameNetwork/NetLoopbackHarness.h"
+#include "GameNetwork/ConnectionManager.h"
+#include "GameNetwork/GameInfo.h"
+#include "GameNetwork/NetCommandList.h"
+#include "GameNetwork/NetCommandMsg.h"
+#include "GameNetwork/NetworkUtil.h"
+#include "GameNetwork/Transport.h"
+
+/**
+ * A Transport with the harness where its socket would be.
+ */
+class LoopbackTransport : public Transport
+{
+public:
+	LoopbackTransport(NetLoopbackHarness *harness, Int player)
+	{
+		m_harness = harness;
+		m_player = player;
+	}
+
+	virtual Bool doRecv( void )
+	{
+		m_harness->receive(m_player, this);
+		return TRUE;
+	}
+
+	virtual Bool doSend( void )
+	{
+		// in queue order, the same as Transport::doSend writes them to the socket.
+		for (Int i = 0; i < MAX_MESSAGES; ++i) {
+			if (m_outBuffer[i].length != 0) {
+				m_harness->send(m_player, &m_outBuffer[i], m_outBuffer[i].length + sizeof(TransportMessageHeader));
+				m_outBuffer[i].length = 0;
+			}
+		}
+		return TRUE;
+	}
+
+private:
+	NetLoopbackHarness *m_harness;
+	Int m_player;
+};
+
+NetLoopbackHarness::NetLoopbackHarness()
+{
+	for (Int i = 0; i < MAX_SLOTS; ++i) {
+		m_peers[i].conMgr = NULL;
+	}
+	m_numPlayers = 0;
+
+	m_framesRun = 0;
+	m_framesMismatched = 0;
+	m_commandsSent = 0;
+	m_commandsExecuted = 0;
+
+	m_stallCount = 0;
+	m_stallTime = 0;
+	m_longestStall = 0;
+
+	m_datagramsSent = 0;
+	m_datagramsLost = 0;
+	m_datagramsCapped = 0;
+	m_datagramsBad = 0;
+	m_bytesSent = 0;
+
+	m_fileSendTime = 0;
+	m_fileDoneTime = 0;
+	for (Int i = 0; i < MAX_SLOTS; ++i) {
+		m_fileReceived[i] = FALSE;
+	}
+}
+
+NetLoopbackHarness::~NetLoopbackHarness()
+{
+	// each ConnectionManager deletes its LoopbackTransport, so this has to happen while we're still here.
+	for (Int i = 0; i < MAX_SLOTS; ++i) {
+		if (m_peers[i].conMgr != NULL) {
+			delete m_peers[i].conMgr;
+			m_peers[i].conMgr = NULL;
+		}
+	}
+}
+
+/**
+ * Play numFrames frames between numPlayers peers and log how it went.
+ */
+Bool NetLoopbackHarness::run(Int numPlayers, Int numFrames)
+{
+	if ((numPlayers < 2) || (numPlayers > MAX_SLOTS) || (numFrames < 1)) {
+		DEBUG_LOG(("NetLoopbackHarness::run - can't run %d players for %d frames\n", numPlayers, numFrames));
+		return FALSE;
+	}
+	m_numPlayers = numPlayers;
+
+	// the slot list every peer would get from the lobby, only the local IP differs between them.
+	SkirmishGameInfo game;
+	game.init();
+	game.enterGame();
+	for (Int i = 0; i < m_numPlayers; ++i) {
+		m_peers[i].addr = LOOPBACK_ADDR + i;
+		m_peers[i].port = LOOPBACK_PORT;
+
+		UnicodeString name;
+		name.format(L"Peer %d", i);
+
+		GameSlot slot;
+		slot.setState(SLOT_PLAYER, name, m_peers[i].addr);
+		slot.setPort(m_peers[i].port);
+		game.setSlot(i, slot);
+	}
+
+	for (Int i = 0; i < m_numPlayers; ++i) {
+		startPeer(i, &game);
+	}
+
+	// the game starts on frame 1 and frame 0 is thrown away, as in Network::processCommand.
+	TheGameLogic->friend_setFrame(1);
+	for (Int i = 0; i < m_numPlayers; ++i) {
+		NetCommandList *list = m_peers[i].conMgr->getFrameCommandList(0);
+		list->deleteInstance();
+		beginFrame(i);
+	}
+
+	UnsignedInt startTime = timeGetTime();
+	UnsignedInt nextFrameTime = startTime;
+	UnsignedInt stallStartTime = 0;
+	UnsignedInt frame = 1;
+	Bool ok = TRUE;
+
+	while (ok && (frame <= (UnsignedInt)numFrames)) {
+		for (Int i = 0; i < m_numPlayers; ++i) {
+			Peer &peer = m_peers[i];
+			peer.conMgr->updateRunAhead(peer.runAhead, peer.frameRate, FALSE, getExecutionFrame(i));
+
+			// not in game as far as the disconnect manager is concerned, so there's no disconnect
+			// screen.  A peer that stops answering just stalls everyone until STALL_TIMEOUT.
+			peer.conMgr->update(FALSE);
+		}
+		updateFileTransfer();
+
+		// everyone gets asked, so every peer requests the resends it needs.
+		Bool ready = TRUE;
+		for (Int i = 0; i < m_numPlayers; ++i) {
+			if (!m_peers[i].conMgr->allCommandsReady(frame)) {
+				ready = FALSE;
+			}
+		}
+
+		UnsignedInt now = timeGetTime();
+		if (!ready) {
+			if (stallStartTime == 0) {
+				stallStartTime = now;
+			} else if ((now - stallStartTime) > STALL_TIMEOUT) {
+				DEBUG_LOG(("NetLoopbackHarness::run - gave up after waiting %d ms for frame %d\n", now - stallStartTime, frame));
+				ok = FALSE;
+			}
+		} else {
+			if (stallStartTime != 0) {
+				// the same rule as Network::updateFrameStats, a stall is a wait longer than a frame.
+				UnsignedInt stallTime = now - stallStartTime;
+				if (stallTime > (UnsignedInt)(1000 / getFrameRate())) {
+					++m_stallCount;
+					m_stallTime += stallTime;
+					if (stallTime > m_longestStall) {
+						m_longestStall = stallTime;
+					}
+				}
+				stallStartTime = 0;
+			}
+
+			for (Int i = 0; i < m_numPlayers; ++i) {
+				m_peers[i].conMgr->handleAllCommandsReady();
+			}
+
+			if (now >= nextFrameTime) {
+				// paced the same as Network::timeForNewFrame.
+				UnsignedInt frameDelay = 1000 / getFrameRate();
+				if ((nextFrameTime + (2 * frameDelay)) < now) {
+					nextFrameTime = now;
+				} else {
+					nextFrameTime += frameDelay;
+				}
+
+				runFrame(frame);
+
+				++frame;
+				TheGameLogic->friend_setFrame(frame);
+				for (Int i = 0; i < m_numPlayers; ++i) {
+					beginFrame(i);
+				}
+				if ((frame == FILE_SEND_FRAME) && (TheGlobalData->m_netHarnessFileSize > 0)) {
+					startFileTransfer();
+				}
+			}
+		}
+
+		::Sleep(1);
+	}
+
+	logResults(timeGetTime() - startTime, ok);
+
+	if (m_fileSendTime != 0) {
+		// every peer wrote it to the same place.
+		DeleteFile(m_fileName.str());
+	}
+
+	TheGameLogic->friend_setFrame(0);
+	return ok && (m_framesMismatched == 0);
+}
+
+/**
+ * Set up a player's ConnectionManager the way a network game start does, see Network::init and
+ * Network::parseUserList.
+ */
+void NetLoopbackHarness::startPeer(Int player, GameInfo *game)
+{
+	Peer &peer = m_peers[player];
+
+	// every ConnectionManager makes its own disconnect menu, and TheDisconnectMenu only has room
+	// for one.  None of them is ever shown here.
+	if (TheDisconnectMenu != NULL) {
+		delete TheDisconnectMenu;
+		TheDisconnectMenu = NULL;
+	}
+
+	peer.conMgr = NEW ConnectionManager;
+	peer.conMgr->init();
+	peer.conMgr->setLocalAddress(peer.addr, peer.port);
+	peer.conMgr->attachTransport(NEW LoopbackTransport(this, player));
+
+	game->setLocalIP(peer.addr);
+	peer.conMgr->parseUserList(game);
+
+	peer.runAhead = min(max(30, MIN_RUNAHEAD), MAX_FRAMES_AHEAD/2);
+	peer.frameRate = 30;
+	peer.lastExecutionFrame = peer.runAhead - 1;
+	peer.lastFrameCompleted = peer.runAhead - 1;
+	peer.bandwidthSecond = timeGetTime();
+	peer.bandwidthBytes = 0;
+
+	peer.conMgr->destroyGameMessages();
+	peer.conMgr->zeroFrames(1, peer.runAhead - 1);
+}
+
+/**
+ * What Network does when the logic frame moves on: send this frame's orders, then the command
+ * counts for every frame we can't give orders for any more.
+ */
+void NetLoopbackHarness::beginFrame(Int player)
+{
+	Peer &peer = m_peers[player];
+
+	sendScriptedCommands(player);
+
+	Int executionFrame = getExecutionFrame(player);
+	for (Int i = peer.lastFrameCompleted + 1; i < executionFrame; ++i) {
+		peer.conMgr->processFrameTick(i);
+		peer.lastFrameCompleted = i;
+	}
+}
+
+/**
+ * Player n gives an order every n+1 frames, selecting anywhere from 1 to MAX_SCRIPTED_OBJECTS
+ * units, so packets carry a mix of small and large commands from everybody.
+ */
+void NetLoopbackHarness::sendScriptedCommands(Int player)
+{
+	UnsignedInt frame = TheGameLogic->getFrame();
+	if ((frame % (player + 1)) != 0) {
+		return;
+	}
+
+	GameMessage *msg = newInstance(GameMessage)(GameMessage::MSG_CREATE_SELECTED_GROUP);
+	msg->appendBooleanArgument(TRUE);
+	Int numObjects = (((frame * 7) + player) % MAX_SCRIPTED_OBJECTS) + 1;
+	for (Int i = 0; i < numObjects; ++i) {
+		msg->appendObjectIDArgument((ObjectID)((player * 1000) + i + 1));
+	}
+
+	m_peers[player].conMgr->sendLocalGameMessage(msg, getExecutionFrame(player));
+	msg->deleteInstance();
+	++m_commandsSent;
+}
+
+/**
+ * The same as Network::getExecutionFrame.
+ */
+Int NetLoopbackHarness::getExecutionFrame(Int player)
+{
+	Peer &peer = m_peers[player];
+	Int logicFrame = TheGameLogic->getFrame() + peer.runAhead;
+	if (logicFrame > peer.lastExecutionFrame) {
+		peer.lastExecutionFrame = logicFrame;
+	}
+	return peer.lastExecutionFrame;
+}
+
+/**
+ * Take every peer's commands for this frame and check they all got the same ones.
+ */
+Bool NetLoopbackHarness::runFrame(UnsignedInt frame)
+{
+	NetCommandList *lists[MAX_SLOTS];
+	for (Int i = 0; i < m_numPlayers; ++i) {
+		lists[i] = m_peers[i].conMgr->getFrameCommandList(frame);
+	}
+
+	Bool same = TRUE;
+	for (Int i = 1; i < m_numPlayers; ++i) {
+		if (!isSameFrame(lists[0], lists[i])) {
+			DEBUG_LOG(("NetLoopbackHarness::runFrame - frame %d, peer %d has %d commands that don't match peer 0's %d\n",
+				frame, i, lists[i]->length(), lists[0]->length()));
+			same = FALSE;
+		}
+	}
+
+	NetCommandRef *ref = lists[0]->getFirstMessage();
+	while (ref != NULL) {
+		if (ref->getCommand()->getNetCommandType() == NETCOMMANDTYPE_GAMECOMMAND) {
+			++m_commandsExecuted;
+		}
+		ref = ref->getNext();
+	}
+
+	for (Int i = 0; i < m_numPlayers; ++i) {
+		processRunAhead(i, lists[i]);
+		lists[i]->deleteInstance();
+		lists[i] = NULL;
+	}
+
+	++m_framesRun;
+	if (!same) {
+		++m_framesMismatched;
+	}
+	return same;
+}
+
+/**
+ * Compares only the member of the union that the argument's type says is in use; the rest of it
+ * isn't sent, so it's whatever was in memory on the other side.
+ */
+static Bool isSameArgument(GameMessageArgument *arg1, GameMessageArgument *arg2)
+{
+	if (arg1->m_type != arg2->m_type) {
+		return FALSE;
+	}
+
+	const GameMessageArgumentType &data1 = arg1->m_data;
+	const GameMessageArgumentType &data2 = arg2->m_data;
+	switch (arg1->m_type) {
+		case ARGUMENTDATATYPE_INTEGER:
+			return data1.integer == data2.integer;
+		case ARGUMENTDATATYPE_REAL:
+			return data1.real == data2.real;
+		case ARGUMENTDATATYPE_BOOLEAN:
+			return data1.boolean == data2.boolean;
+		case ARGUMENTDATATYPE_OBJECTID:
+			return data1.objectID == data2.objectID;
+		case ARGUMENTDATATYPE_DRAWABLEID:
+			return data1.drawableID == data2.drawableID;
+		case ARGUMENTDATATYPE_TEAMID:
+			return data1.teamID == data2.teamID;
+		case ARGUMENTDATATYPE_LOCATION:
+			return (data1.location.x == data2.location.x) &&
+				(data1.location.y == data2.location.y) &&
+				(data1.location.z == data2.location.z);
+		case ARGUMENTDATATYPE_PIXEL:
+			return (data1.pixel.x == data2.pixel.x) && (data1.pixel.y == data2.pixel.y);
+		case ARGUMENTDATATYPE_PIXELREGION:
+			return (data1.pixelRegion.lo.x == data2.pixelRegion.lo.x) &&
+				(data1.pixelRegion.lo.y == data2.pixelRegion.lo.y) &&
+				(data1.pixelRegion.hi.x == data2.pixelRegion.hi.x) &&
+				(data1.pixelRegion.hi.y == data2.pixelRegion.hi.y);
+		case ARGUMENTDATATYPE_TIMESTAMP:
+			return data1.timestamp == data2.timestamp;
+		case ARGUMENTDATATYPE_WIDECHAR:
+			return data1.wChar == data2.wChar;
+	}
+	return FALSE;
+}
+
+/**
+ * The frame rate ConnectionManager::updateRunAhead gives the slowest player in place of
+ * frameRate, so that it can try to run a little faster than everyone else.
+ */
+static Int getSlowestPlayerFrameRate(Int frameRate)
+{
+	Int newFrameRate = (frameRate * 11) / 10;
+	if (newFrameRate == frameRate) {
+		newFrameRate = frameRate + 1;
+	}
+	if (newFrameRate > 30) {
+		newFrameRate = 30;
+	}
+	return newFrameRate;
+}
+
+/**
+ * Everything the peer will act on has to match: the GameMessage and its arguments for a game
+ * command, the count for a frame info, and the run ahead and frame rate for a run ahead.
+ */
+static Bool isSameCommand(NetCommandMsg *msg1, NetCommandMsg *msg2)
+{
+	if ((msg1->getNetCommandType() != msg2->getNetCommandType()) ||
+			(msg1->getPlayerID() != msg2->getPlayerID()) ||
+			(msg1->getID() != msg2->getID()) ||
+			(msg1->getExecutionFrame() != msg2->getExecutionFrame())) {
+		return FALSE;
+	}
+
+	switch (msg1->getNetCommandType()) {
+		case NETCOMMANDTYPE_GAMECOMMAND:
+		{
+			NetGameCommandMsg *cmd1 = (NetGameCommandMsg *)msg1;
+			NetGameCommandMsg *cmd2 = (NetGameCommandMsg *)msg2;
+			if (cmd1->getGameMessageType() != cmd2->getGameMessageType()) {
+				return FALSE;
+			}
+			GameMessageArgument *arg1 = cmd1->getArgumentList();
+			GameMessageArgument *arg2 = cmd2->getArgumentList();
+			while ((arg1 != NULL) && (arg2 != NULL)) {
+				if (!isSameArgument(arg1, arg2)) {
+					return FALSE;
+				}
+				arg1 = arg1->m_next;
+				arg2 = arg2->m_next;
+			}
+			return (arg1 == NULL) && (arg2 == NULL);
+		}
+		case NETCOMMANDTYPE_FRAMEINFO:
+			return ((NetFrameCommandMsg *)msg1)->getCommandCount() == ((NetFrameCommandMsg *)msg2)->getCommandCount();
+		case NETCOMMANDTYPE_RUNAHEAD:
+		{
+			NetRunAheadCommandMsg *cmd1 = (NetRunAheadCommandMsg *)msg1;
+			NetRunAheadCommandMsg *cmd2 = (NetRunAheadCommandMsg *)msg2;
+			if (cmd1->getRunAhead() != cmd2->getRunAhead()) {
+				return FALSE;
+			}
+			Int frameRate1 = cmd1->getFrameRate();
+			Int frameRate2 = cmd2->getFrameRate();
+			return (frameRate1 == frameRate2) ||
+				(frameRate2 == getSlowestPlayerFrameRate(frameRate1)) ||
+				(frameRate1 == getSlowestPlayerFrameRate(frameRate2));
+		}
+	}
+	return TRUE;
+}
+
+/**
+ * The lists are sorted, so the same commands come out in the same order.  The packet router gives
+ * the slowest player a different frame rate in its run ahead command, but with the same ID, so
+ * that's the one difference isSameCommand lets through.
+ */
+Bool NetLoopbackHarness::isSameFrame(NetCommandList *list1, NetCommandList *list2)
+{
+	NetCommandRef *ref1 = list1->getFirstMessage();
+	NetCommandRef *ref2 = list2->getFirstMessage();
+	while ((ref1 != NULL) && (ref2 != NULL)) {
+		if (!isSameCommand(ref1->getCommand(), ref2->getCommand())) {
+			return FALSE;
+		}
+		ref1 = ref1->getNext();
+		ref2 = ref2->getNext();
+	}
+	return (ref1 == NULL) && (ref2 == NULL);
+}
+
+/**
+ * The same as Network::processRunAheadCommand.
+ */
+void NetLoopbackHarness::processRunAhead(Int player, NetCommandList *list)
+{
+	Peer &peer = m_peers[player];
+	NetCommandRef *ref = list->getFirstMessage();
+	while (ref != NULL) {
+		if (ref->getCommand()->getNetCommandType() == NETCOMMANDTYPE_RUNAHEAD) {
+			NetRunAheadCommandMsg *msg = (NetRunAheadCommandMsg *)ref->getCommand();
+			peer.runAhead = msg->getRunAhead();
+			peer.frameRate = msg->getFrameRate();
+
+			time_t frameGrouping = (1000 * peer.runAhead) / peer.frameRate;
+			frameGrouping = frameGrouping / 2;
+			if (frameGrouping < 1) {
+				frameGrouping = 1;
+			}
+			if (frameGrouping > 500) {
+				frameGrouping = 500;
+			}
+			peer.conMgr->setFrameGrouping(frameGrouping);
+		}
+		ref = ref->getNext();
+	}
+}
+
+/**
+ * Frames run together, so they run at the slowest rate anyone was told to use.
+ */
+Int NetLoopbackHarness::getFrameRate()
+{
+	Int frameRate = m_peers[0].frameRate;
+	for (Int i = 1; i < m_numPlayers; ++i) {
+		if (m_peers[i].frameRate < frameRate) {
+			frameRate = m_peers[i].frameRate;
+		}
+	}
+	return frameRate;
+}
+
+/**
+ * Put a datagram on the wire to whoever it's addressed to, with the same impairments
+ * Transport::doRecv applies to a real socket.
+ */
+void NetLoopbackHarness::send(Int player, TransportMessage *msg, Int len)
+{
+	++m_datagramsSent;
+	m_bytesSent += len;
+
+	Int to = -1;
+	for (Int i = 0; i < m_numPlayers; ++i) {
+		if ((m_peers[i].addr == msg->addr) && (m_peers[i].port == msg->port)) {
+			to = i;
+			break;
+		}
+	}
+	if (to == -1) {
+		++m_datagramsBad;
+		return;
+	}
+
+	if ((TheGlobalData->m_packetLoss > 0) && (TheGlobalData->m_packetLoss >= GameClientRandomValue(0, 100))) {
+		++m_datagramsLost;
+		return;
+	}
+
+	UnsignedInt now = timeGetTime();
+	UnsignedInt deliveryTime = now + TheGlobalData->m_latencyAverage +
+		(Int)(TheGlobalData->m_latencyAmplitude * sin(now * TheGlobalData->m_latencyPeriod)) +
+		GameClientRandomValue(-TheGlobalData->m_latencyNoise, TheGlobalData->m_latencyNoise);
+	if (TheGlobalData->m_packetReorder > GameClientRandomValue(0, 99)) {
+		// hold this one back long enough for the packets behind it to overtake it
+		deliveryTime += GameClientRandomValue(10, 100);
+	}
+
+	Datagram datagram;
+	datagram.from = player;
+	datagram.len = len;
+	memcpy(&datagram.message, msg, len);
+	m_inFlight[to].insert(DatagramQueue::value_type(deliveryTime, datagram));
+}
+
+/**
+ * Move everything that has arrived for this player into its transport's receive buffers, as
+ * Transport::doRecv would off the socket.
+ */
+void NetLoopbackHarness::receive(Int player, Transport *transport)
+{
+	Peer &peer = m_peers[player];
+	DatagramQueue &queue = m_inFlight[player];
+	UnsignedInt now = timeGetTime();
+
+	if ((now - peer.bandwidthSecond) >= 1000) {
+		peer.bandwidthSecond = now;
+		peer.bandwidthBytes = 0;
+	}
+
+	Int slot = 0;
+	while (!queue.empty() && (queue.begin()->first <= now)) {
+		// anything that doesn't fit waits for the next call, as it would in the socket's buffer.
+		while ((slot < MAX_MESSAGES) && (transport->m_inBuffer[slot].length != 0)) {
+			++slot;
+		}
+		if (slot == MAX_MESSAGES) {
+			break;
+		}
+
+		const Datagram &datagram = queue.begin()->second;
+		if ((TheGlobalData->m_bandwidthCap > 0) && (peer.bandwidthBytes + datagram.len > (UnsignedInt)TheGlobalData->m_bandwidthCap)) {
+			// a saturated link drops whatever doesn't fit in this second
+			++m_datagramsCapped;
+		} else {
+			peer.bandwidthBytes += datagram.len;
+
+			TransportMessage *msg = &transport->m_inBuffer[slot];
+			memcpy(msg, &datagram.message, datagram.len);
+			if (Transport::unpackDatagram(msg, datagram.len)) {
+				msg->addr = m_peers[datagram.from].addr;
+				msg->port = m_peers[datagram.from].port;
+			} else {
+				msg->length = 0;
+				++m_datagramsBad;
+			}
+		}
+		queue.erase(queue.begin());
+	}
+}
+
+/**
+ * Write out a file of noise, so compression can't shrink it, and have the first peer send it to
+ * everyone else the way FileTransfer sends a map.
+ */
+void NetLoopbackHarness::startFileTransfer()
+{
+	Int size = TheGlobalData->m_netHarnessFileSize;
+	m_fileName = TheGameState->getFilePathInSaveDirectory("NetHarness.tmp");
+	m_fileName.toLower();	// the same as the receivers will see it, see GameState::portableMapPathToRealMapPath
+
+	File *fp = TheLocalFileSystem->openFile(m_fileName.str(), File::CREATE | File::TRUNCATE | File::BINARY | File::WRITE);
+	if (fp == NULL) {
+		DEBUG_LOG(("NetLoopbackHarness::startFileTransfer - can't write %s\n", m_fileName.str()));
+		return;
+	}
+	char *buf = NEW char[size];
+	UnsignedInt seed = 1;
+	for (Int i = 0; i < size; ++i) {
+		seed = (seed * 1664525) + 1013904223;
+		buf[i] = (char)(seed >> 24);
+	}
+	fp->write(buf, size);
+	fp->close();
+	fp = NULL;
+	delete[] buf;
+	buf = NULL;
+
+	UnsignedByte playerMask = 0;
+	for (Int i = 1; i < m_numPlayers; ++i) {
+		playerMask |= (1 << i);
+	}
+	UnsignedShort fileID = m_peers[0].conMgr->sendFileAnnounce(m_fileName, playerMask);
+	m_peers[0].conMgr->sendFile(m_fileName, playerMask, fileID);
+	m_fileSendTime = timeGetTime();
+	m_fileReceived[0] = TRUE;
+}
+
+/**
+ * Note when each peer has the file.  A peer's progress goes to 100 as soon as it has written the
+ * file out, and the progress table is shared by every ConnectionManager in the process.
+ */
+void NetLoopbackHarness::updateFileTransfer()
+{
+	if ((m_fileSendTime == 0) || (m_fileDoneTime != 0)) {
+		return;
+	}
+
+	Bool done = TRUE;
+	for (Int i = 0; i < m_numPlayers; ++i) {
+		if (!m_fileReceived[i] && (m_peers[0].conMgr->getFileTransferProgress(i, m_fileName) == 100)) {
+			m_fileReceived[i] = TRUE;
+		}
+		if (!m_fileReceived[i]) {
+			done = FALSE;
+		}
+	}
+	if (done) {
+		m_fileDoneTime = timeGetTime();
+	}
+}
+
+void NetLoopbackHarness::logResults(UnsignedInt totalTime, Bool ok)
+{
+	Real seconds = totalTime / 1000.0f;
+
+	DEBUG_LOG(("NetLoopbackHarness - %d players, %d frames in %.1f sec, %.1f frames per second, final run ahead %d at %d fps\n",
+		m_numPlayers, m_framesRun, seconds, (seconds > 0.0f) ? (m_framesRun / seconds) : 0.0f, m_peers[0].runAhead, getFrameRate()));
+	DEBUG_LOG(("NetLoopbackHarness - %d stalls, %.1f sec stalled, longest %d ms\n",
+		m_stallCount, m_stallTime / 1000.0f, m_longestStall));
+	DEBUG_LOG(("NetLoopbackHarness - %d datagrams, %d bytes, %.0f bytes per frame, %d lost, %d over the bandwidth cap, %d bad\n",
+		m_datagramsSent, m_bytesSent, (m_framesRun > 0) ? ((Real)m_bytesSent / m_framesRun) : 0.0f,
+		m_datagramsLost, m_datagramsCapped, m_datagramsBad));
+	DEBUG_LOG(("NetLoopbackHarness - %d orders given, %d executed\n", m_commandsSent, m_commandsExecuted));
+
+	static const char *sendClassNames[CONNECTION_SEND_CLASS_COUNT] = { "frame", "ack", "control", "chat", "file" };
+	for (Int sendClass = 0; sendClass < CONNECTION_SEND_CLASS_COUNT; ++sendClass) {
+		Int acks = 0;
+		Real latency = 0.0f;
+		for (Int i = 0; i < m_numPlayers; ++i) {
+			Int peerAcks;
+			Real peerLatency;
+			m_peers[i].conMgr->getAckLatencyTotals(sendClass, peerAcks, peerLatency);
+			acks += peerAcks;
+			latency += peerLatency;
+		}
+		if (acks > 0) {
+			DEBUG_LOG(("NetLoopbackHarness - %s commands: %d acked, average ack latency %.0f ms\n",
+				sendClassNames[sendClass], acks, latency / acks));
+		}
+	}
+
+	if (m_fileSendTime != 0) {
+		if (m_fileDoneTime != 0) {
+			DEBUG_LOG(("NetLoopbackHarness - %d byte file reached every peer in %.1f sec%s\n", TheGlobalData->m_netHarnessFileSize,
+				(m_fileDoneTime - m_fileSendTime) / 1000.0f, TheGlobalData->m_noSendClasses ? ", without send classes" : ""));
+		} else {
+			DEBUG_LOG(("NetLoopbackHarness - %d byte file didn't reach every peer\n", TheGlobalData->m_netHarnessFileSize));
+		}
+	}
+
+	if (!ok) {
+		DEBUG_LOG(("NetLoopbackHarness - FAILED, the peers stopped making progress on frame %d\n", m_framesRun + 1));
+	} else if (m_framesMismatched > 0) {
+		DEBUG_LOG(("NetLoopbackHarness - FAILED, the peers disagreed about %d frames\n", m_framesMismatched));
+	} else {
+		DEBUG_LOG(("NetLoopbackHarness - every peer got the same commands for every frame\n"));
+	}
+}
+
+#endif // defined(_DEBUG) || defined(_INTERNAL)
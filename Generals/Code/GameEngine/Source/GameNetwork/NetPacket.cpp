@@ -658,6 +658,7 @@ UnsignedInt NetPacket::GetFileCommandSize(NetCommandMsg *msg) {
 	++msglen; // 'D'
 
 	msglen += filemsg->getPortableFilename().getLength() + 1; // PORTABLE filename and the terminating 0
+	msglen += sizeof(UnsignedByte); // compressed flag
 	msglen += sizeof(UnsignedInt); // file data length
 	msglen += filemsg->getFileLength(); // the file data
 
@@ -1682,6 +1683,9 @@ void NetPacket::FillBufferWithFileMessage(UnsignedByte *buffer, NetCommandRef *m
 	buffer[offset] = 0;
 	++offset;
 
+	buffer[offset] = cmdMsg->isCompressed() ? 1 : 0;
+	offset += sizeof(UnsignedByte);
+
 	UnsignedInt newInt = cmdMsg->getFileLength();
 	memcpy(buffer + offset, &newInt, sizeof(newInt));
 	offset += sizeof(newInt);
@@ -1905,12 +1909,14 @@ NetPacket::NetPacket() {
 }
 
 /**
- * Constructor given raw transport data.
+ * Constructor given raw transport data.  The packet reads the data where it is rather
+ * than copying it, so the transport message must not be reused while the packet exists.
  */
 NetPacket::NetPacket(TransportMessage *msg) {
+	// not init(msg->data), which would clear the first byte of the data we're about to read.
 	init();
+	m_packet = msg->data;
 	m_packetLen = msg->length;
-	memcpy(m_packet, msg->data, MAX_PACKET_SIZE);
 	m_numCommands = -1;
 	m_addr = msg->addr;
 	m_port = msg->port;
@@ -1920,16 +1926,15 @@ NetPacket::NetPacket(TransportMessage *msg) {
  * Destructor
  */
 NetPacket::~NetPacket() {
-	if (m_lastCommand != NULL) {
-		m_lastCommand->deleteInstance();
-		m_lastCommand = NULL;
-	}
+	setLastCommand(NULL);
 }
 
 /**
- * Initialize all the member variable values.
+ * Initialize all the member variable values.  If buffer is given, the packet is built
+ * there instead of in m_packetBuffer; it must have room for MAX_PACKET_SIZE bytes.
  */
-void NetPacket::init() {
+void NetPacket::init(UnsignedByte *buffer) {
+	m_packet = (buffer != NULL) ? buffer : m_packetBuffer;
 	m_addr = 0;
 	m_port = 0;
 	m_numCommands = 0;
@@ -1941,16 +1946,93 @@ void NetPacket::init() {
 	m_lastCommandID = 0;
 	m_lastCommandType = 0;
 	m_lastRelay = 0;
+	m_lastRepeatOffset = -1;
 
 	m_lastCommand = NULL;
+	m_lastCommandRelay = 0;
+}
+
+void NetPacket::reset(UnsignedByte *buffer) {
+	setLastCommand(NULL);
+	init(buffer);
 }
 
-void NetPacket::reset() {
+/**
+ * Remember the command just added, for spotting repeats.  Only the command itself is
+ * kept (with a reference) rather than a whole new NetCommandRef.
+ */
+void NetPacket::setLastCommand(NetCommandRef *ref) {
 	if (m_lastCommand != NULL) {
-		m_lastCommand->deleteInstance();
+		m_lastCommand->detach();
 		m_lastCommand = NULL;
 	}
-	init();
+	if (ref != NULL) {
+		m_lastCommand = ref->getCommand();
+		m_lastCommand->attach();
+		m_lastCommandRelay = ref->getRelay();
+	}
+}
+
+/**
+ * Put a new execution frame into the packet.  Frames are usually close to the last one, so
+ * they are written as a one byte difference ('f') whenever they can be.
+ */
+void NetPacket::addFrameToPacket(UnsignedInt frame) {
+	Int delta = (Int)(frame - m_lastFrame);
+	if ((delta >= -128) && (delta <= 127)) {
+		m_packet[m_packetLen] = 'f';
+		++m_packetLen;
+		m_packet[m_packetLen] = (UnsignedByte)(signed char)delta;
+		m_packetLen += sizeof(UnsignedByte);
+	} else {
+		m_packet[m_packetLen] = 'F';
+		++m_packetLen;
+		memcpy(m_packet+m_packetLen, &frame, sizeof(UnsignedInt));
+		m_packetLen += sizeof(UnsignedInt);
+	}
+
+	m_lastFrame = frame;
+}
+
+/**
+ * The number of bytes addFrameToPacket will need for this frame.
+ */
+Int NetPacket::getFrameFieldSize(UnsignedInt frame) {
+	Int delta = (Int)(frame - m_lastFrame);
+	if ((delta >= -128) && (delta <= 127)) {
+		return sizeof(UnsignedByte) + sizeof(UnsignedByte);
+	}
+	return sizeof(UnsignedByte) + sizeof(UnsignedInt);
+}
+
+/**
+ * Repeat the last command.  A run of repeats is written as 'Y' and a count rather than
+ * a 'Z' for each one, so a long run of acks only takes two bytes.  Returns FALSE if
+ * there isn't room.
+ */
+Bool NetPacket::addRepeatToPacket() {
+	if ((m_lastRepeatOffset >= 0) && (m_lastRepeatOffset == (m_packetLen - 2)) && (m_packet[m_lastRepeatOffset] == 'Y')
+			&& (m_packet[m_lastRepeatOffset + 1] < 255)) {
+		++m_packet[m_lastRepeatOffset + 1];
+		return TRUE;
+	}
+
+	if (m_packetLen >= MAX_PACKET_SIZE) {
+		return FALSE;
+	}
+
+	if ((m_lastRepeatOffset >= 0) && (m_lastRepeatOffset == (m_packetLen - 1)) && (m_packet[m_lastRepeatOffset] == 'Z')) {
+		// the last thing in the packet is a single repeat, make it a run of two.
+		m_packet[m_lastRepeatOffset] = 'Y';
+		m_packet[m_packetLen] = 2;
+		++m_packetLen;
+		return TRUE;
+	}
+
+	m_lastRepeatOffset = m_packetLen;
+	m_packet[m_packetLen] = 'Z';
+	++m_packetLen;
+	return TRUE;
 }
 
 /**
@@ -2041,11 +2123,13 @@ Bool NetPacket::addCommand(NetCommandRef *msg) {
 /*
 T = Net command type
 F = Execution frame
+f = Execution frame, as a signed byte difference from the last one
 P = Player ID
 C = Command ID
 R = Relay
 D = Command Data
 Z = Repeat last command
+Y = Repeat last command, followed by a byte with the number of times
 */
 Bool NetPacket::addFrameResendRequestCommand(NetCommandRef *msg) {
 	Bool needNewCommandID = FALSE;
@@ -2064,13 +2148,7 @@ Bool NetPacket::addFrameResendRequestCommand(NetCommandRef *msg) {
 
 		// If necessary, put the execution frame into the packet.
 		if (m_lastFrame != cmdMsg->getExecutionFrame()) {
-			m_packet[m_packetLen] = 'F';
-			++m_packetLen;
-			UnsignedInt newframe = cmdMsg->getExecutionFrame();
-			memcpy(m_packet+m_packetLen, &newframe, sizeof(UnsignedInt));
-			m_packetLen += sizeof(UnsignedInt);
-
-			m_lastFrame = newframe;
+			addFrameToPacket(cmdMsg->getExecutionFrame());
 		}
 
 		// If necessary, put the relay into the packet.
@@ -2115,12 +2193,7 @@ Bool NetPacket::addFrameResendRequestCommand(NetCommandRef *msg) {
 		DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("NetPacket::addFrameResendRequest - added frame resend request command from player %d for frame %d, command id = %d\n", m_lastPlayerID, frameToResend, m_lastCommandID));
 
 		++m_numCommands;
-		if (m_lastCommand != NULL) {
-			m_lastCommand->deleteInstance();
-			m_lastCommand = NULL;
-		}
-		m_lastCommand = NEW_NETCOMMANDREF(msg->getCommand());
-		m_lastCommand->setRelay(msg->getRelay());
+		setLastCommand(msg);
 
 		return TRUE;
 	}
@@ -2139,7 +2212,7 @@ Bool NetPacket::isRoomForFrameResendRequestMessage(NetCommandRef *msg) {
 		len += sizeof(UnsignedByte) + sizeof(UnsignedByte);
 	}
 	if (m_lastFrame != cmdMsg->getExecutionFrame()) {
-		len += sizeof(UnsignedInt) + sizeof(UnsignedByte);
+		len += getFrameFieldSize(cmdMsg->getExecutionFrame());
 	}
 	if (m_lastPlayerID != cmdMsg->getPlayerID()) {
 		++len;
@@ -2175,13 +2248,7 @@ Bool NetPacket::addDisconnectScreenOffCommand(NetCommandRef *msg) {
 
 		// If necessary, put the execution frame into the packet.
 		if (m_lastFrame != cmdMsg->getExecutionFrame()) {
-			m_packet[m_packetLen] = 'F';
-			++m_packetLen;
-			UnsignedInt newframe = cmdMsg->getExecutionFrame();
-			memcpy(m_packet+m_packetLen, &newframe, sizeof(UnsignedInt));
-			m_packetLen += sizeof(UnsignedInt);
-
-			m_lastFrame = newframe;
+			addFrameToPacket(cmdMsg->getExecutionFrame());
 		}
 
 		// If necessary, put the relay into the packet.
@@ -2226,12 +2293,7 @@ Bool NetPacket::addDisconnectScreenOffCommand(NetCommandRef *msg) {
 		DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("NetPacket::addDisconnectScreenOff - added disconnect screen off command from player %d for frame %d, command id = %d\n", m_lastPlayerID, newFrame, m_lastCommandID));
 
 		++m_numCommands;
-		if (m_lastCommand != NULL) {
-			m_lastCommand->deleteInstance();
-			m_lastCommand = NULL;
-		}
-		m_lastCommand = NEW_NETCOMMANDREF(msg->getCommand());
-		m_lastCommand->setRelay(msg->getRelay());
+		setLastCommand(msg);
 
 		return TRUE;
 	}
@@ -2250,7 +2312,7 @@ Bool NetPacket::isRoomForDisconnectScreenOffMessage(NetCommandRef *msg) {
 		len += sizeof(UnsignedByte) + sizeof(UnsignedByte);
 	}
 	if (m_lastFrame != cmdMsg->getExecutionFrame()) {
-		len += sizeof(UnsignedInt) + sizeof(UnsignedByte);
+		len += getFrameFieldSize(cmdMsg->getExecutionFrame());
 	}
 	if (m_lastPlayerID != cmdMsg->getPlayerID()) {
 		++len;
@@ -2286,13 +2348,7 @@ Bool NetPacket::addDisconnectFrameCommand(NetCommandRef *msg) {
 
 		// If necessary, put the execution frame into the packet.
 		if (m_lastFrame != cmdMsg->getExecutionFrame()) {
-			m_packet[m_packetLen] = 'F';
-			++m_packetLen;
-			UnsignedInt newframe = cmdMsg->getExecutionFrame();
-			memcpy(m_packet+m_packetLen, &newframe, sizeof(UnsignedInt));
-			m_packetLen += sizeof(UnsignedInt);
-
-			m_lastFrame = newframe;
+			addFrameToPacket(cmdMsg->getExecutionFrame());
 		}
 
 		// If necessary, put the relay into the packet.
@@ -2335,12 +2391,7 @@ Bool NetPacket::addDisconnectFrameCommand(NetCommandRef *msg) {
 		m_packetLen += sizeof(disconnectFrame);
 
 		++m_numCommands;
-		if (m_lastCommand != NULL) {
-			m_lastCommand->deleteInstance();
-			m_lastCommand = NULL;
-		}
-		m_lastCommand = NEW_NETCOMMANDREF(msg->getCommand());
-		m_lastCommand->setRelay(msg->getRelay());
+		setLastCommand(msg);
 
 		DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("NetPacket::addDisconnectFrame - added disconnect frame command from player %d for frame %d, command id = %d\n", m_lastPlayerID, disconnectFrame, m_lastCommandID));
 
@@ -2361,7 +2412,7 @@ Bool NetPacket::isRoomForDisconnectFrameMessage(NetCommandRef *msg) {
 		len += sizeof(UnsignedByte) + sizeof(UnsignedByte);
 	}
 	if (m_lastFrame != cmdMsg->getExecutionFrame()) {
-		len += sizeof(UnsignedInt) + sizeof(UnsignedByte);
+		len += getFrameFieldSize(cmdMsg->getExecutionFrame());
 	}
 	if (m_lastPlayerID != cmdMsg->getPlayerID()) {
 		++len;
@@ -2435,6 +2486,9 @@ Bool NetPacket::addFileCommand(NetCommandRef *msg) {
 		strcpy((char *)(m_packet + m_packetLen), filename.str());
 		m_packetLen += filename.getLength() + 1;
 
+		m_packet[m_packetLen] = cmdMsg->isCompressed() ? 1 : 0;
+		m_packetLen += sizeof(UnsignedByte);
+
 		UnsignedInt fileLength = cmdMsg->getFileLength();
 		memcpy(m_packet + m_packetLen, &fileLength, sizeof(fileLength));
 		m_packetLen += sizeof(fileLength);
@@ -2443,12 +2497,7 @@ Bool NetPacket::addFileCommand(NetCommandRef *msg) {
 		m_packetLen += fileLength;
 
 		++m_numCommands;
-		if (m_lastCommand != NULL) {
-			m_lastCommand->deleteInstance();
-			m_lastCommand = NULL;
-		}
-		m_lastCommand = NEW_NETCOMMANDREF(msg->getCommand());
-		m_lastCommand->setRelay(msg->getRelay());
+		setLastCommand(msg);
 		return TRUE;
 	}
 	return FALSE;
@@ -2474,6 +2523,7 @@ Bool NetPacket::isRoomForFileMessage(NetCommandRef *msg) {
 
 	++len; // 'D'
 	len += cmdMsg->getPortableFilename().getLength() + 1; // PORTABLE filename + the terminating 0
+	len += sizeof(UnsignedByte); // compressed flag
 	len += sizeof(UnsignedInt); // filedata length
 	len += cmdMsg->getFileLength();
 
@@ -2548,12 +2598,7 @@ Bool NetPacket::addFileAnnounceCommand(NetCommandRef *msg) {
 		m_packetLen += sizeof(playerMask);
 
 		++m_numCommands;
-		if (m_lastCommand != NULL) {
-			m_lastCommand->deleteInstance();
-			m_lastCommand = NULL;
-		}
-		m_lastCommand = NEW_NETCOMMANDREF(msg->getCommand());
-		m_lastCommand->setRelay(msg->getRelay());
+		setLastCommand(msg);
 
 		DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("Adding file announce message for fileID %d, ID %d to packet\n",
 			cmdMsg->getFileID(), cmdMsg->getID()));
@@ -2653,12 +2698,7 @@ Bool NetPacket::addFileProgressCommand(NetCommandRef *msg) {
 		m_packetLen += sizeof(progress);
 
 		++m_numCommands;
-		if (m_lastCommand != NULL) {
-			m_lastCommand->deleteInstance();
-			m_lastCommand = NULL;
-		}
-		m_lastCommand = NEW_NETCOMMANDREF(msg->getCommand());
-		m_lastCommand->setRelay(msg->getRelay());
+		setLastCommand(msg);
 
 		return TRUE;
 	}
@@ -2785,12 +2825,7 @@ Bool NetPacket::addWrapperCommand(NetCommandRef *msg) {
 		m_packetLen += dataLength;
 
 		++m_numCommands;
-		if (m_lastCommand != NULL) {
-			m_lastCommand->deleteInstance();
-			m_lastCommand = NULL;
-		}
-		m_lastCommand = NEW_NETCOMMANDREF(msg->getCommand());
-		m_lastCommand->setRelay(msg->getRelay());
+		setLastCommand(msg);
 
 		return TRUE;
 	}
@@ -2884,12 +2919,7 @@ Bool NetPacket::addTimeOutGameStartMessage(NetCommandRef *msg) {
 		++m_packetLen;
 
 		++m_numCommands;
-		if (m_lastCommand != NULL) {
-			m_lastCommand->deleteInstance();
-			m_lastCommand = NULL;
-		}
-		m_lastCommand = NEW_NETCOMMANDREF(msg->getCommand());
-		m_lastCommand->setRelay(msg->getRelay());
+		setLastCommand(msg);
 
 //		DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("Added keep alive command to packet.\n"));
 
@@ -2978,12 +3008,7 @@ Bool NetPacket::addLoadCompleteMessage(NetCommandRef *msg) {
 		++m_packetLen;
 
 		++m_numCommands;
-		if (m_lastCommand != NULL) {
-			m_lastCommand->deleteInstance();
-			m_lastCommand = NULL;
-		}
-		m_lastCommand = NEW_NETCOMMANDREF(msg->getCommand());
-		m_lastCommand->setRelay(msg->getRelay());
+		setLastCommand(msg);
 
 //		DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("Added keep alive command to packet.\n"));
 
@@ -3064,12 +3089,7 @@ Bool NetPacket::addProgressMessage(NetCommandRef *msg) {
 		++m_packetLen;
 
 		++m_numCommands;
-		if (m_lastCommand != NULL) {
-			m_lastCommand->deleteInstance();
-			m_lastCommand = NULL;
-		}
-		m_lastCommand = NEW_NETCOMMANDREF(msg->getCommand());
-		m_lastCommand->setRelay(msg->getRelay());
+		setLastCommand(msg);
 
 //		DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("Added keep alive command to packet.\n"));
 
@@ -3175,12 +3195,7 @@ Bool NetPacket::addDisconnectVoteCommand(NetCommandRef *msg) {
 //		DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("NetPacket::addDisconnectVoteCommand - added disconnect vote command, player id %d command id %d, voted slot %d\n", m_lastPlayerID, m_lastCommandID, slot));
 
 		++m_numCommands;
-		if (m_lastCommand != NULL) {
-			m_lastCommand->deleteInstance();
-			m_lastCommand = NULL;
-		}
-		m_lastCommand = NEW_NETCOMMANDREF(msg->getCommand());
-		m_lastCommand->setRelay(msg->getRelay());
+		setLastCommand(msg);
 		return TRUE;
 	}
 	return FALSE;
@@ -3274,12 +3289,7 @@ Bool NetPacket::addDisconnectChatCommand(NetCommandRef *msg) {
 //		DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("NetPacket - added disconnect chat command\n"));
 
 		++m_numCommands;
-		if (m_lastCommand != NULL) {
-			m_lastCommand->deleteInstance();
-			m_lastCommand = NULL;
-		}
-		m_lastCommand = NEW_NETCOMMANDREF(msg->getCommand());
-		m_lastCommand->setRelay(msg->getRelay());
+		setLastCommand(msg);
 		return TRUE;
 	}
 	return FALSE;
@@ -3328,13 +3338,7 @@ Bool NetPacket::addChatCommand(NetCommandRef *msg) {
 
 		// If necessary, put the execution frame into the packet.
 		if (m_lastFrame != cmdMsg->getExecutionFrame()) {
-			m_packet[m_packetLen] = 'F';
-			++m_packetLen;
-			UnsignedInt newframe = cmdMsg->getExecutionFrame();
-			memcpy(m_packet+m_packetLen, &newframe, sizeof(UnsignedInt));
-			m_packetLen += sizeof(UnsignedInt);
-
-			m_lastFrame = newframe;
+			addFrameToPacket(cmdMsg->getExecutionFrame());
 		}
 
 		// If necessary, put the relay into the packet.
@@ -3391,12 +3395,7 @@ Bool NetPacket::addChatCommand(NetCommandRef *msg) {
 //		DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("NetPacket - added chat command\n"));
 
 		++m_numCommands;
-		if (m_lastCommand != NULL) {
-			m_lastCommand->deleteInstance();
-			m_lastCommand = NULL;
-		}
-		m_lastCommand = NEW_NETCOMMANDREF(msg->getCommand());
-		m_lastCommand->setRelay(msg->getRelay());
+		setLastCommand(msg);
 		return TRUE;
 	}
 	return FALSE;
@@ -3411,7 +3410,7 @@ Bool NetPacket::isRoomForChatMessage(NetCommandRef *msg) {
 		len += sizeof(UnsignedByte);
 	}
 	if (m_lastFrame != cmdMsg->getExecutionFrame()) {
-		len += sizeof(UnsignedInt) + sizeof(UnsignedByte);
+		len += getFrameFieldSize(cmdMsg->getExecutionFrame());
 	}
 	if (m_lastRelay != msg->getRelay()) {
 		len += sizeof(UnsignedByte) + sizeof(UnsignedByte);
@@ -3482,12 +3481,7 @@ Bool NetPacket::addPacketRouterAckCommand(NetCommandRef *msg) {
 //		DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("NetPacket - added packet router ack command, player id %d\n", m_lastPlayerID));
 
 		++m_numCommands;
-		if (m_lastCommand != NULL) {
-			m_lastCommand->deleteInstance();
-			m_lastCommand = NULL;
-		}
-		m_lastCommand = NEW_NETCOMMANDREF(msg->getCommand());
-		m_lastCommand->setRelay(msg->getRelay());
+		setLastCommand(msg);
 		return TRUE;
 	}
 	return FALSE;
@@ -3564,12 +3558,7 @@ Bool NetPacket::addPacketRouterQueryCommand(NetCommandRef *msg) {
 //		DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("NetPacket - added packet router query command, player id %d\n", m_lastPlayerID));
 
 		++m_numCommands;
-		if (m_lastCommand != NULL) {
-			m_lastCommand->deleteInstance();
-			m_lastCommand = NULL;
-		}
-		m_lastCommand = NEW_NETCOMMANDREF(msg->getCommand());	
-		m_lastCommand->setRelay(msg->getRelay());
+		setLastCommand(msg);
 		return TRUE;
 	}
 	return FALSE;
@@ -3669,12 +3658,7 @@ Bool NetPacket::addDisconnectPlayerCommand(NetCommandRef *msg) {
 //		DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("NetPacket::addDisconnectPlayerCommand - added disconnect player command, player id %d command id %d, disconnecting slot %d\n", m_lastPlayerID, m_lastCommandID, slot));
 
 		++m_numCommands;
-		if (m_lastCommand != NULL) {
-			m_lastCommand->deleteInstance();
-			m_lastCommand = NULL;
-		}
-		m_lastCommand = NEW_NETCOMMANDREF(msg->getCommand());
-		m_lastCommand->setRelay(msg->getRelay());
+		setLastCommand(msg);
 		return TRUE;
 	}
 	return FALSE;
@@ -3754,12 +3738,7 @@ Bool NetPacket::addDisconnectKeepAliveCommand(NetCommandRef *msg) {
 		++m_packetLen;
 
 		++m_numCommands;
-		if (m_lastCommand != NULL) {
-			m_lastCommand->deleteInstance();
-			m_lastCommand = NULL;
-		}
-		m_lastCommand = NEW_NETCOMMANDREF(msg->getCommand());
-		m_lastCommand->setRelay(msg->getRelay());
+		setLastCommand(msg);
 
 //		DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("Added keep alive command to packet.\n"));
 
@@ -3834,12 +3813,7 @@ Bool NetPacket::addKeepAliveCommand(NetCommandRef *msg) {
 		++m_packetLen;
 
 		++m_numCommands;
-		if (m_lastCommand != NULL) {
-			m_lastCommand->deleteInstance();
-			m_lastCommand = NULL;
-		}
-		m_lastCommand = NEW_NETCOMMANDREF(msg->getCommand());
-		m_lastCommand->setRelay(msg->getRelay());
+		setLastCommand(msg);
 
 //		DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("Added keep alive command to packet.\n"));
 
@@ -3905,13 +3879,7 @@ Bool NetPacket::addRunAheadCommand(NetCommandRef *msg) {
 
 		// If necessary, put the execution frame into the packet.
 		if (m_lastFrame != cmdMsg->getExecutionFrame()) {
-			m_packet[m_packetLen] = 'F';
-			++m_packetLen;
-			UnsignedInt newframe = cmdMsg->getExecutionFrame();
-			memcpy(m_packet+m_packetLen, &newframe, sizeof(UnsignedInt));
-			m_packetLen += sizeof(UnsignedInt);
-
-			m_lastFrame = newframe;
+			addFrameToPacket(cmdMsg->getExecutionFrame());
 		}
 
 //		DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("relay = %d, ", m_lastRelay));
@@ -3953,12 +3921,7 @@ Bool NetPacket::addRunAheadCommand(NetCommandRef *msg) {
 //		DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("NetPacket - added run ahead command, frame %d, player id %d command id %d\n", m_lastFrame, m_lastPlayerID, m_lastCommandID));
 
 		++m_numCommands;
-		if (m_lastCommand != NULL) {
-			m_lastCommand->deleteInstance();
-			m_lastCommand = NULL;
-		}
-		m_lastCommand = NEW_NETCOMMANDREF(msg->getCommand());
-		m_lastCommand->setRelay(msg->getRelay());
+		setLastCommand(msg);
 		return TRUE;
 	}
 	return FALSE;
@@ -3979,7 +3942,7 @@ Bool NetPacket::isRoomForRunAheadMessage(NetCommandRef *msg) {
 		len += sizeof(UnsignedByte) + sizeof(UnsignedByte);
 	}
 	if (m_lastFrame != cmdMsg->getExecutionFrame()) {
-		len += sizeof(UnsignedInt) + sizeof(UnsignedByte);
+		len += getFrameFieldSize(cmdMsg->getExecutionFrame());
 	}
 	if (m_lastPlayerID != cmdMsg->getPlayerID()) {
 		++len;
@@ -4030,13 +3993,7 @@ Bool NetPacket::addDestroyPlayerCommand(NetCommandRef *msg) {
 
 		// If necessary, put the execution frame into the packet.
 		if (m_lastFrame != cmdMsg->getExecutionFrame()) {
-			m_packet[m_packetLen] = 'F';
-			++m_packetLen;
-			UnsignedInt newframe = cmdMsg->getExecutionFrame();
-			memcpy(m_packet+m_packetLen, &newframe, sizeof(UnsignedInt));
-			m_packetLen += sizeof(UnsignedInt);
-
-			m_lastFrame = newframe;
+			addFrameToPacket(cmdMsg->getExecutionFrame());
 		}
 
 //		DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("relay = %d, ", m_lastRelay));
@@ -4074,12 +4031,7 @@ Bool NetPacket::addDestroyPlayerCommand(NetCommandRef *msg) {
 		//DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("NetPacket - added CRC:0x%8.8X info command, frame %d, player id %d command id %d\n", newCRC, m_lastFrame, m_lastPlayerID, m_lastCommandID));
 
 		++m_numCommands;
-		if (m_lastCommand != NULL) {
-			m_lastCommand->deleteInstance();
-			m_lastCommand = NULL;
-		}
-		m_lastCommand = NEW_NETCOMMANDREF(msg->getCommand());
-		m_lastCommand->setRelay(msg->getRelay());
+		setLastCommand(msg);
 		return TRUE;
 	}
 	return FALSE;
@@ -4100,7 +4052,7 @@ Bool NetPacket::isRoomForDestroyPlayerMessage(NetCommandRef *msg) {
 		len += sizeof(UnsignedByte) + sizeof(UnsignedByte);
 	}
 	if (m_lastFrame != cmdMsg->getExecutionFrame()) {
-		len += sizeof(UnsignedInt) + sizeof(UnsignedByte);
+		len += getFrameFieldSize(cmdMsg->getExecutionFrame());
 	}
 	if (m_lastPlayerID != cmdMsg->getPlayerID()) {
 		++len;
@@ -4186,12 +4138,7 @@ Bool NetPacket::addRunAheadMetricsCommand(NetCommandRef *msg) {
 		memcpy(m_packet + m_packetLen, &averageFps, sizeof(averageFps));
 		m_packetLen += sizeof(averageFps);
 
-		if (m_lastCommand != NULL) {
-			m_lastCommand->deleteInstance();
-			m_lastCommand = NULL;
-		}
-		m_lastCommand = NEW_NETCOMMANDREF(msg->getCommand());
-		m_lastCommand->setRelay(msg->getRelay());
+		setLastCommand(msg);
 
 		++m_numCommands;
 		return TRUE;
@@ -4264,13 +4211,7 @@ Bool NetPacket::addPlayerLeaveCommand(NetCommandRef *msg) {
 
 		// If necessary, put the execution frame into the packet.
 		if (m_lastFrame != cmdMsg->getExecutionFrame()) {
-			m_packet[m_packetLen] = 'F';
-			++m_packetLen;
-			UnsignedInt newframe = cmdMsg->getExecutionFrame();
-			memcpy(m_packet+m_packetLen, &newframe, sizeof(UnsignedInt));
-			m_packetLen += sizeof(UnsignedInt);
-
-			m_lastFrame = newframe;
+			addFrameToPacket(cmdMsg->getExecutionFrame());
 		}
 
 //		DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("relay = %d, ", m_lastRelay));
@@ -4305,12 +4246,7 @@ Bool NetPacket::addPlayerLeaveCommand(NetCommandRef *msg) {
 		memcpy(m_packet + m_packetLen, &leavingPlayerID, sizeof(UnsignedByte));
 		m_packetLen += sizeof(UnsignedByte);
 
-		if (m_lastCommand != NULL) {
-			m_lastCommand->deleteInstance();
-			m_lastCommand = NULL;
-		}
-		m_lastCommand = NEW_NETCOMMANDREF(msg->getCommand());
-		m_lastCommand->setRelay(msg->getRelay());
+		setLastCommand(msg);
 
 		++m_numCommands;
 		return TRUE;
@@ -4333,7 +4269,7 @@ Bool NetPacket::isRoomForPlayerLeaveMessage(NetCommandRef *msg) {
 		len += sizeof(UnsignedByte) + sizeof(UnsignedByte);
 	}
 	if (m_lastFrame != cmdMsg->getExecutionFrame()) {
-		len += sizeof(UnsignedInt) + sizeof(UnsignedByte);
+		len += getFrameFieldSize(cmdMsg->getExecutionFrame());
 	}
 	if (m_lastPlayerID != cmdMsg->getPlayerID()) {
 		++len;
@@ -4358,15 +4294,11 @@ Bool NetPacket::isRoomForPlayerLeaveMessage(NetCommandRef *msg) {
 Bool NetPacket::addFrameCommand(NetCommandRef *msg) {
 	Bool needNewCommandID = FALSE;
 	if (isFrameRepeat(msg)) {
-		if (m_packetLen >= MAX_PACKET_SIZE) {
+		if (!addRepeatToPacket()) {
 			return FALSE;
 		}
-		m_packet[m_packetLen] = 'Z';
-		++m_packetLen;
 		m_lastCommandID = msg->getCommand()->getID();
-		m_lastCommand->deleteInstance();
-		m_lastCommand = newInstance(NetCommandRef)(msg->getCommand());
-		m_lastCommand->setRelay(msg->getRelay());
+		setLastCommand(msg);
 		++m_lastFrame;		// need this cause we're actually advancing to the next frame by adding this command.
 		++m_numCommands;
 		// frameinfodebug
@@ -4389,13 +4321,7 @@ Bool NetPacket::addFrameCommand(NetCommandRef *msg) {
 
 		// If necessary, put the execution frame into the packet.
 		if (m_lastFrame != cmdMsg->getExecutionFrame()) {
-			m_packet[m_packetLen] = 'F';
-			++m_packetLen;
-			UnsignedInt newframe = cmdMsg->getExecutionFrame();
-			memcpy(m_packet+m_packetLen, &newframe, sizeof(UnsignedInt));
-			m_packetLen += sizeof(UnsignedInt);
-
-			m_lastFrame = newframe;
+			addFrameToPacket(cmdMsg->getExecutionFrame());
 		}
 
 		// If necessary, put the relay into the packet.
@@ -4444,12 +4370,7 @@ Bool NetPacket::addFrameCommand(NetCommandRef *msg) {
 		// frameinfodebug
 //		DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("outgoing - added frame %d, player %d, command count = %d, command id = %d\n", cmdMsg->getExecutionFrame(), cmdMsg->getPlayerID(), cmdMsg->getCommandCount(), cmdMsg->getID()));
 
-		if (m_lastCommand != NULL) {
-			m_lastCommand->deleteInstance();
-			m_lastCommand = NULL;
-		}
-		m_lastCommand = NEW_NETCOMMANDREF(msg->getCommand());
-		m_lastCommand->setRelay(msg->getRelay());
+		setLastCommand(msg);
 
 		++m_numCommands;
 		return TRUE;
@@ -4469,7 +4390,7 @@ Bool NetPacket::isRoomForFrameMessage(NetCommandRef *msg) {
 		len += sizeof(UnsignedByte);
 	}
 	if (m_lastFrame != cmdMsg->getExecutionFrame()) {
-		len += sizeof(UnsignedInt) + sizeof(UnsignedByte);
+		len += getFrameFieldSize(cmdMsg->getExecutionFrame());
 	}
 	if (m_lastRelay != msg->getRelay()) {
 		len += sizeof(UnsignedByte) + sizeof(UnsignedByte);
@@ -4495,18 +4416,18 @@ Bool NetPacket::isFrameRepeat(NetCommandRef *msg) {
 	if (m_lastCommand == NULL) {
 		return FALSE;
 	}
-	if (m_lastCommand->getCommand()->getNetCommandType() != NETCOMMANDTYPE_FRAMEINFO) {
+	if (m_lastCommand->getNetCommandType() != NETCOMMANDTYPE_FRAMEINFO) {
 		return FALSE;
 	}
 	NetFrameCommandMsg *framemsg = (NetFrameCommandMsg *)(msg->getCommand());
-	NetFrameCommandMsg *lastmsg = (NetFrameCommandMsg *)(m_lastCommand->getCommand());
+	NetFrameCommandMsg *lastmsg = (NetFrameCommandMsg *)(m_lastCommand);
 	if (framemsg->getCommandCount() != 0) {
 		return FALSE;
 	}
 	if (framemsg->getExecutionFrame() != (lastmsg->getExecutionFrame() + 1)) {
 		return FALSE;
 	}
-	if (msg->getRelay() != m_lastCommand->getRelay()) {
+	if (msg->getRelay() != m_lastCommandRelay) {
 		return FALSE;
 	}
 	if (framemsg->getID() != (lastmsg->getID() + 1)) {
@@ -4544,17 +4465,11 @@ Bool NetPacket::addAckStage2Command(NetCommandRef *msg) {
  */
 Bool NetPacket::addAckCommand(NetCommandRef *msg, UnsignedShort commandID, UnsignedByte originalPlayerID) {
 	if (isAckRepeat(msg)) {
-		if (m_packetLen >= MAX_PACKET_SIZE) {
+		if (!addRepeatToPacket()) {
 			return FALSE;
 		}
-		m_packet[m_packetLen] = 'Z';
-		++m_packetLen;
 		++m_numCommands;
-		m_lastCommand->deleteInstance();
-		m_lastCommand = NULL;
-
-		m_lastCommand = NEW_NETCOMMANDREF(msg->getCommand());
-		m_lastCommand->setRelay(msg->getRelay());
+		setLastCommand(msg);
 		return TRUE;
 	}
 	if (isRoomForAckMessage(msg)) {
@@ -4587,12 +4502,7 @@ Bool NetPacket::addAckCommand(NetCommandRef *msg, UnsignedShort commandID, Unsig
 		memcpy(m_packet + m_packetLen, &originalPlayerID, sizeof(UnsignedByte));
 		m_packetLen += sizeof(UnsignedByte);
 
-		if (m_lastCommand != NULL) {
-			m_lastCommand->deleteInstance();
-			m_lastCommand = NULL;
-		}
-		m_lastCommand = NEW_NETCOMMANDREF(msg->getCommand());
-		m_lastCommand->setRelay(msg->getRelay());
+		setLastCommand(msg);
 
 //		DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("outgoing - added ACK, original player %d, command id %d\n", origPlayerID, cmdID));
 		++m_numCommands;
@@ -4629,7 +4539,7 @@ Bool NetPacket::isAckRepeat(NetCommandRef *msg) {
 	if (m_lastCommand == NULL) {
 		return FALSE;
 	}
-	if (m_lastCommand->getCommand()->getNetCommandType() != msg->getCommand()->getNetCommandType()) {
+	if (m_lastCommand->getNetCommandType() != msg->getCommand()->getNetCommandType()) {
 		return FALSE;
 	}
 	if (msg->getCommand()->getNetCommandType() == NETCOMMANDTYPE_ACKBOTH) {
@@ -4646,14 +4556,14 @@ Bool NetPacket::isAckRepeat(NetCommandRef *msg) {
 
 Bool NetPacket::isAckBothRepeat(NetCommandRef *msg) {
 	NetAckBothCommandMsg *ack = (NetAckBothCommandMsg *)(msg->getCommand());
-	NetAckBothCommandMsg *lastAck = (NetAckBothCommandMsg *)(m_lastCommand->getCommand());
+	NetAckBothCommandMsg *lastAck = (NetAckBothCommandMsg *)(m_lastCommand);
 	if (lastAck->getCommandID() != (ack->getCommandID() - 1)) {
 		return FALSE;
 	}
 	if (lastAck->getOriginalPlayerID() != ack->getOriginalPlayerID()) {
 		return FALSE;
 	}
-	if (msg->getRelay() != m_lastCommand->getRelay()) {
+	if (msg->getRelay() != m_lastCommandRelay) {
 		return FALSE;
 	}
 	return TRUE;
@@ -4661,14 +4571,14 @@ Bool NetPacket::isAckBothRepeat(NetCommandRef *msg) {
 
 Bool NetPacket::isAckStage1Repeat(NetCommandRef *msg) {
 	NetAckStage2CommandMsg *ack = (NetAckStage2CommandMsg *)(msg->getCommand());
-	NetAckStage2CommandMsg *lastAck = (NetAckStage2CommandMsg *)(m_lastCommand->getCommand());
+	NetAckStage2CommandMsg *lastAck = (NetAckStage2CommandMsg *)(m_lastCommand);
 	if (lastAck->getCommandID() != (ack->getCommandID() - 1)) {
 		return FALSE;
 	}
 	if (lastAck->getOriginalPlayerID() != ack->getOriginalPlayerID()) {
 		return FALSE;
 	}
-	if (msg->getRelay() != m_lastCommand->getRelay()) {
+	if (msg->getRelay() != m_lastCommandRelay) {
 		return FALSE;
 	}
 	return TRUE;
@@ -4676,14 +4586,14 @@ Bool NetPacket::isAckStage1Repeat(NetCommandRef *msg) {
 
 Bool NetPacket::isAckStage2Repeat(NetCommandRef *msg) {
 	NetAckStage2CommandMsg *ack = (NetAckStage2CommandMsg *)(msg->getCommand());
-	NetAckStage2CommandMsg *lastAck = (NetAckStage2CommandMsg *)(m_lastCommand->getCommand());
+	NetAckStage2CommandMsg *lastAck = (NetAckStage2CommandMsg *)(m_lastCommand);
 	if (lastAck->getCommandID() != (ack->getCommandID() - 1)) {
 		return FALSE;
 	}
 	if (lastAck->getOriginalPlayerID() != ack->getOriginalPlayerID()) {
 		return FALSE;
 	}
-	if (msg->getRelay() != m_lastCommand->getRelay()) {
+	if (msg->getRelay() != m_lastCommandRelay) {
 		return FALSE;
 	}
 	return TRUE;
@@ -4717,13 +4627,7 @@ Bool NetPacket::addGameCommand(NetCommandRef *msg) {
 
 		// If necessary, put the execution frame into the packet.
 		if (m_lastFrame != cmdMsg->getExecutionFrame()) {
-			m_packet[m_packetLen] = 'F';
-			++m_packetLen;
-			UnsignedInt newframe = cmdMsg->getExecutionFrame();
-			memcpy(m_packet+m_packetLen, &newframe, sizeof(UnsignedInt));
-			m_packetLen += sizeof(UnsignedInt);
-
-			m_lastFrame = newframe;
+			addFrameToPacket(cmdMsg->getExecutionFrame());
 		}
 
 		// If necessary, put the relay into the packet.
@@ -4800,12 +4704,7 @@ Bool NetPacket::addGameCommand(NetCommandRef *msg) {
 
 		++m_numCommands;
 
-		if (m_lastCommand != NULL) {
-			m_lastCommand->deleteInstance();
-			m_lastCommand = NULL;
-		}
-		m_lastCommand = NEW_NETCOMMANDREF(msg->getCommand());
-		m_lastCommand->setRelay(msg->getRelay());
+		setLastCommand(msg);
 
 		retval = TRUE;
 	}
@@ -4867,7 +4766,7 @@ Bool NetPacket::isRoomForGameMessage(NetCommandRef *msg, GameMessage *gmsg) {
 	Bool needNewCommandID = FALSE;
 
 	if (m_lastFrame != cmdMsg->getExecutionFrame()) {
-		msglen += sizeof(UnsignedInt) + sizeof(UnsignedByte);
+		msglen += getFrameFieldSize(cmdMsg->getExecutionFrame());
 	}
 	if (m_lastPlayerID != cmdMsg->getPlayerID()) {
 		msglen += sizeof(UnsignedByte) + sizeof(UnsignedByte);
@@ -4943,7 +4842,7 @@ NetCommandList * NetPacket::getCommandList() {
 	UnsignedShort commandID = 1; // The first command is going to be
 	UnsignedByte commandType = 0;
 	UnsignedByte relay = 0;
-	NetCommandRef *lastCommand = NULL;
+	NetCommandMsg *lastCommand = NULL;	// holds the reference the read function gave us
 
 	Int i = 0;
 	while (i < m_packetLen) {
@@ -4955,6 +4854,10 @@ NetCommandList * NetPacket::getCommandList() {
 			++i;
 			memcpy(&frame, m_packet + i, sizeof(UnsignedInt));
 			i += sizeof(UnsignedInt);
+		} else if (m_packet[i] == 'f') {
+			++i;
+			frame += (signed char)(m_packet[i]);	// not Char, which is unsigned on some targets
+			i += sizeof(UnsignedByte);
 		} else if (m_packet[i] == 'P') {
 			++i;
 			memcpy(&playerID, m_packet + i, sizeof(UnsignedByte));
@@ -5111,75 +5014,79 @@ NetCommandList * NetPacket::getCommandList() {
 				DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("NetPacket::getCommandList - failed to set relay for message %d\n", msg->getID()));
 			}
 
+			// hang on to the reference from the "readXMessage" above until the next command replaces it.
 			if (lastCommand != NULL) {
-				lastCommand->deleteInstance();
-				lastCommand = NULL;
+				lastCommand->detach();
 			}
-			lastCommand = newInstance(NetCommandRef)(msg);
-
-			msg->detach();  // Need to detach from new NetCommandMsg created by the "readXMessage" above.
+			lastCommand = msg;
 
 			// since the message is part of the list now, we don't have to keep track of it.  So we'll just set it to NULL.
 			msg = NULL;
-		} else if (m_packet[i] == 'Z') {
-			++i;
-			// Repeat the last command, doing some funky cool byte-saving stuff
-			if (lastCommand == NULL) {
-				DEBUG_CRASH(("Got a repeat command with no command to repeat."));
+		} else if ((m_packet[i] == 'Z') || (m_packet[i] == 'Y')) {
+			Int repeatCount = 1;
+			if (m_packet[i] == 'Y') {
+				++i;
+				repeatCount = m_packet[i];
 			}
-			NetCommandMsg *msg = NULL;
-			if (commandType == NETCOMMANDTYPE_ACKSTAGE1) {
-				msg = newInstance(NetAckStage1CommandMsg)();
-				NetAckStage1CommandMsg *last = (NetAckStage1CommandMsg *)(lastCommand->getCommand());
-				((NetAckStage1CommandMsg *)msg)->setCommandID(last->getCommandID() + 1);
-				((NetAckStage1CommandMsg *)msg)->setOriginalPlayerID(last->getOriginalPlayerID());
-			} else if (commandType == NETCOMMANDTYPE_ACKSTAGE2) {
-				msg = newInstance(NetAckStage2CommandMsg)();
-				NetAckStage2CommandMsg *last = (NetAckStage2CommandMsg *)(lastCommand->getCommand());
-				((NetAckStage2CommandMsg *)msg)->setCommandID(last->getCommandID() + 1);
-				((NetAckStage2CommandMsg *)msg)->setOriginalPlayerID(last->getOriginalPlayerID());
-			} else if (commandType == NETCOMMANDTYPE_ACKBOTH) {
-				msg = newInstance(NetAckBothCommandMsg)();
-				NetAckBothCommandMsg *last = (NetAckBothCommandMsg *)(lastCommand->getCommand());
-				((NetAckBothCommandMsg *)msg)->setCommandID(last->getCommandID() + 1);
-				((NetAckBothCommandMsg *)msg)->setOriginalPlayerID(last->getOriginalPlayerID());
-			} else if (commandType == NETCOMMANDTYPE_FRAMEINFO) {
-				msg = newInstance(NetFrameCommandMsg)();
-				++frame; // this is set below.
-				((NetFrameCommandMsg *)msg)->setCommandCount(0);
-				DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("Read a repeated frame command, frame = %d, player = %d, commandID = %d\n", frame, playerID, commandID));
-			} else {
-				DEBUG_CRASH(("Trying to repeat a command that shouldn't be repeated."));
-				continue;
-			}
-
-			msg->setExecutionFrame(frame);
-			msg->setPlayerID(playerID);
-			msg->setNetCommandType((NetCommandType)commandType);
-			msg->setID(commandID);
-
-//			DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("frame = %d, player = %d, command type = %d, id = %d\n", frame, playerID, commandType, commandID));
-
-			// increment to the next command ID.
-			if (DoesCommandRequireACommandID((NetCommandType)commandType)) {
-				++commandID;
-			}
-
-			// add the message to the list.
-			NetCommandRef *ref = retval->addMessage(msg);
-			if (ref != NULL) {
-				ref->setRelay(relay);
+			++i;
+			for (Int repeat = 0; repeat < repeatCount; ++repeat) {
+				// Repeat the last command, doing some funky cool byte-saving stuff
+				if (lastCommand == NULL) {
+					DEBUG_CRASH(("Got a repeat command with no command to repeat."));
+				}
+				NetCommandMsg *msg = NULL;
+				if (commandType == NETCOMMANDTYPE_ACKSTAGE1) {
+					msg = newInstance(NetAckStage1CommandMsg)();
+					NetAckStage1CommandMsg *last = (NetAckStage1CommandMsg *)(lastCommand);
+					((NetAckStage1CommandMsg *)msg)->setCommandID(last->getCommandID() + 1);
+					((NetAckStage1CommandMsg *)msg)->setOriginalPlayerID(last->getOriginalPlayerID());
+				} else if (commandType == NETCOMMANDTYPE_ACKSTAGE2) {
+					msg = newInstance(NetAckStage2CommandMsg)();
+					NetAckStage2CommandMsg *last = (NetAckStage2CommandMsg *)(lastCommand);
+					((NetAckStage2CommandMsg *)msg)->setCommandID(last->getCommandID() + 1);
+					((NetAckStage2CommandMsg *)msg)->setOriginalPlayerID(last->getOriginalPlayerID());
+				} else if (commandType == NETCOMMANDTYPE_ACKBOTH) {
+					msg = newInstance(NetAckBothCommandMsg)();
+					NetAckBothCommandMsg *last = (NetAckBothCommandMsg *)(lastCommand);
+					((NetAckBothCommandMsg *)msg)->setCommandID(last->getCommandID() + 1);
+					((NetAckBothCommandMsg *)msg)->setOriginalPlayerID(last->getOriginalPlayerID());
+				} else if (commandType == NETCOMMANDTYPE_FRAMEINFO) {
+					msg = newInstance(NetFrameCommandMsg)();
+					++frame; // this is set below.
+					((NetFrameCommandMsg *)msg)->setCommandCount(0);
+					DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("Read a repeated frame command, frame = %d, player = %d, commandID = %d\n", frame, playerID, commandID));
+				} else {
+					DEBUG_CRASH(("Trying to repeat a command that shouldn't be repeated."));
+					break;
+				}
+
+				msg->setExecutionFrame(frame);
+				msg->setPlayerID(playerID);
+				msg->setNetCommandType((NetCommandType)commandType);
+				msg->setID(commandID);
+
+//				DEBUG_LOG_LEVEL(DEBUG_LEVEL_NET, ("frame = %d, player = %d, command type = %d, id = %d\n", frame, playerID, commandType, commandID));
+
+				// increment to the next command ID.
+				if (DoesCommandRequireACommandID((NetCommandType)commandType)) {
+					++commandID;
+				}
+
+				// add the message to the list.
+				NetCommandRef *ref = retval->addMessage(msg);
+				if (ref != NULL) {
+					ref->setRelay(relay);
+				}
+
+				// hang on to the reference from the newInstance above until the next command replaces it.
+				if (lastCommand != NULL) {
+					lastCommand->detach();
+				}
+				lastCommand = msg;
+
+				// since the message is part of the list now, we don't have to keep track of it.  So we'll just set it to NULL.
+				msg = NULL;
 			}
-
-			lastCommand->deleteInstance();
-			lastCommand = NULL;
-//			lastCommand = newInstance(NetCommandRef)(msg);
-			lastCommand = NEW_NETCOMMANDREF(msg);
-
-			msg->detach();  // Need to detach from new NetCommandMsg created by the "readXMessage" above.
-
-			// since the message is part of the list now, we don't have to keep track of it.  So we'll just set it to NULL.
-			msg = NULL;
 		} else {
 			// we don't recognize this command, but we have to increment i so we don't fall into an infinite loop.
 			DEBUG_CRASH(("Unrecognized packet entry, ignoring."));
@@ -5190,7 +5097,7 @@ NetCommandList * NetPacket::getCommandList() {
 	}
 
 	if (lastCommand != NULL) {
-		lastCommand->deleteInstance();
+		lastCommand->detach();
 		lastCommand = NULL;
 	}
 	return retval;
@@ -5711,16 +5618,17 @@ NetCommandMsg * NetPacket::readFileMessage(UnsignedByte *data, Int &i) {
 	++i;
 	msg->setPortableFilename(AsciiString(filename));	// it's transferred as a portable filename
 
+	msg->setCompressed(data[i] != 0);
+	i += sizeof(UnsignedByte);
+
 	UnsignedInt dataLength = 0;
 	memcpy(&dataLength, data + i, sizeof(dataLength));
 	i += sizeof(dataLength);
 
-	UnsignedByte *buf = NEW UnsignedByte[dataLength];
-	memcpy(buf, data + i, dataLength);
+	// setFileData makes its own copy
+	msg->setFileData(data + i, dataLength);
 	i += dataLength;
 
-	msg->setFileData(buf, dataLength);
-
 	return msg;
 }
 
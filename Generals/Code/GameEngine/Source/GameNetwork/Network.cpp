@@ -120,6 +120,9 @@ public:
 	inline UnsignedInt getRunAhead(void) { return m_runAhead; }
 	inline UnsignedInt getFrameRate(void) { return m_frameRate; }
 	UnsignedInt getPacketArrivalCushion(void);								///< Returns the smallest packet arrival cushion since this was last called.
+	inline Real getEffectiveFrameRate(void) { return m_effectiveFrameRate; }
+	inline UnsignedInt getStallCount(void) { return m_stallCount; }
+	inline UnsignedInt getStallTime(void) { return m_stallTime; }
 	Bool isFrameDataReady( void );
 	void parseUserList( const GameInfo *game );
 	void startGame(void);																			///< Sets the network game frame counter to -1
@@ -146,6 +149,7 @@ public:
 	Real getOutgoingPacketsPerSecond( void );
 	Real getUnknownBytesPerSecond( void );
 	Real getUnknownPacketsPerSecond( void );
+	Real getSocketCallsPerSecond( void );
 
 	// Multiplayer Load Progress Functions
 	void updateLoadProgress( Int percent );
@@ -194,6 +198,7 @@ protected:
 	void processDestroyPlayerCommand(NetDestroyPlayerCommandMsg *msg);	///< Do what needs to be done when we need to destroy a player.
 	void endOfGameCheck();																				///< Checks to see if its ok to leave this game.  If it is, send the apropriate command to the game logic.
 	Bool timeForNewFrame();
+	void updateFrameStats(Bool commandsReady);										///< Keep track of frames released and time spent waiting on other players.
 
 	ConnectionManager *m_conMgr;																	///< The connection manager object
 
@@ -212,6 +217,14 @@ protected:
 
 	Bool m_frameDataReady;																		///< Is the frame data for the next frame ready to be executed by TheGameLogic?
 
+	// Frame release stats
+	Real m_effectiveFrameRate;																///< Frames released in the last full second.
+	UnsignedInt m_framesThisSecond;
+	UnsignedInt m_frameStatsTime;															///< When the current second started.
+	UnsignedInt m_stallCount;
+	UnsignedInt m_stallTime;																	///< Milliseconds, summed over all stalls.
+	UnsignedInt m_stallStartTime;															///< When we started waiting for commands, 0 if we aren't.
+
 	// CRC info
 	Bool m_checkCRCsThisFrame;
 	Bool m_sawCRCMismatch;
@@ -275,6 +288,13 @@ Network::Network()
 	m_frameDataReady = FALSE;
 	m_sawCRCMismatch = FALSE;
 	//
+
+	m_effectiveFrameRate = 0.0f;
+	m_framesThisSecond = 0;
+	m_frameStatsTime = 0;
+	m_stallCount = 0;
+	m_stallTime = 0;
+	m_stallStartTime = 0;
 	
 	m_conMgr = NULL;
 	m_messageWindow = NULL;
@@ -340,6 +360,13 @@ void Network::init()
 	m_frameDataReady = FALSE;
 	m_didSelfSlug = FALSE;
 
+	m_effectiveFrameRate = 0.0f;
+	m_framesThisSecond = 0;
+	m_frameStatsTime = timeGetTime();
+	m_stallCount = 0;
+	m_stallTime = 0;
+	m_stallStartTime = 0;
+
 	m_localStatus = NETLOCALSTATUS_PREGAME;
 
 	QueryPerformanceFrequency((LARGE_INTEGER *)&m_perfCountFreq);
@@ -713,7 +740,8 @@ void Network::update( void )
 		endOfGameCheck();
 	}
 
-	if (AllCommandsReady(TheGameLogic->getFrame())) { // If all the commands are ready for the next frame...
+	Bool commandsReady = AllCommandsReady(TheGameLogic->getFrame());
+	if (commandsReady) { // If all the commands are ready for the next frame...
 		m_conMgr->handleAllCommandsReady();
 //		DEBUG_LOG(("Network::update - frame %d is ready\n", TheGameLogic->getFrame()));
 		if (timeForNewFrame()) { // This needs to come after any other pre-frame execution checks as this changes the timing variables.
@@ -721,6 +749,38 @@ void Network::update( void )
 			m_frameDataReady = TRUE; // Tell the GameEngine to run the commands for the new frame.
 		}
 	}
+
+	updateFrameStats(commandsReady);
+}
+
+/**
+ * A stall is any time we sat waiting on other players' commands for longer than a frame.  Shorter
+ * waits are just the commands arriving a little after we started looking for them.
+ */
+void Network::updateFrameStats(Bool commandsReady) {
+	UnsignedInt now = timeGetTime();
+
+	if ((m_localStatus == NETLOCALSTATUS_INGAME) && !commandsReady) {
+		if (m_stallStartTime == 0) {
+			m_stallStartTime = now;
+		}
+	} else if (m_stallStartTime != 0) {
+		UnsignedInt stallTime = now - m_stallStartTime;
+		if ((m_frameRate > 0) && (stallTime > (UnsignedInt)(1000 / m_frameRate))) {
+			++m_stallCount;
+			m_stallTime += stallTime;
+		}
+		m_stallStartTime = 0;
+	}
+
+	if (m_frameDataReady) {
+		++m_framesThisSecond;
+	}
+	if ((now - m_frameStatsTime) >= 1000) {
+		m_effectiveFrameRate = m_framesThisSecond * 1000.0f / (now - m_frameStatsTime);
+		m_framesThisSecond = 0;
+		m_frameStatsTime = now;
+	}
 }
 
 void Network::liteupdate() {
@@ -874,6 +934,17 @@ Real Network::getUnknownPacketsPerSecond( void )
 	  return 0.0;
 }
 
+/**
+ * returns the number of send and receive calls made on the socket per second averaged over 30 sec.
+ */
+Real Network::getSocketCallsPerSecond( void )
+{
+	if (m_conMgr)
+		return m_conMgr->getSocketCallsPerSecond();
+	else
+	  return 0.0;
+}
+
 /**
  * returns the smallest packet arrival cushion since this was last called.
  */
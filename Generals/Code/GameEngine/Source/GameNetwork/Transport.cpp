@@ -76,6 +76,20 @@ Transport::Transport(void)
 {
 	m_winsockInit = false;
 	m_udpsock = NULL;
+#if defined(_DEBUG) || defined(_INTERNAL)
+	m_captureFile = NULL;
+#endif
+
+	// the buffers start out empty even if we're never bound, since packets can be built in a
+	// transport that has no socket.
+	for (int i=0; i<MAX_MESSAGES; ++i)
+	{
+		m_outBuffer[i].length = 0;
+		m_inBuffer[i].length = 0;
+#if defined(_DEBUG) || defined(_INTERNAL)
+		m_delayedInBuffer[i].message.length = 0;
+#endif
+	}
 }
 
 Transport::~Transport(void)
@@ -147,14 +161,17 @@ Bool Transport::init( UnsignedInt ip, UnsignedShort port )
 		m_incomingPackets[i] = 0;
 		m_outgoingPackets[i] = 0;
 		m_unknownPackets[i] = 0;
+		m_socketCalls[i] = 0;
 	}
+	m_lastSocketCalls = 0;
 	m_statisticsSlot = 0;
 	m_lastSecond = timeGetTime();
 
 	m_port = port;
 
 #if defined(_DEBUG) || defined(_INTERNAL)
-	if (TheGlobalData->m_latencyAverage > 0 || TheGlobalData->m_latencyNoise)
+	// reordering works by holding packets back, so it goes through the latency buffer too
+	if (TheGlobalData->m_latencyAverage > 0 || TheGlobalData->m_latencyNoise || TheGlobalData->m_packetReorder > 0)
 		m_useLatency = true;
 
 	if (TheGlobalData->m_packetLoss)
@@ -166,6 +183,10 @@ Bool Transport::init( UnsignedInt ip, UnsignedShort port )
 
 void Transport::reset( void )
 {
+#if defined(_DEBUG) || defined(_INTERNAL)
+	closeCaptureFile();
+#endif
+
 	if (m_udpsock)
 	{
 		delete m_udpsock;
@@ -191,6 +212,11 @@ Bool Transport::update( void )
 	{
 		retval = FALSE;
 	}
+	if (m_udpsock)
+	{
+		m_socketCalls[m_statisticsSlot] += m_udpsock->GetSocketCalls() - m_lastSocketCalls;
+		m_lastSocketCalls = m_udpsock->GetSocketCalls();
+	}
 	// DEBUG_ASSERTLOG(retval, ("WSA error is %s\n", GetWSAErrorString(WSAGetLastError()).str()));
 	return retval;
 }
@@ -216,38 +242,30 @@ Bool Transport::doSend() {
 		m_incomingBytes[m_statisticsSlot] = 0;
 		m_unknownPackets[m_statisticsSlot] = 0;
 		m_unknownBytes[m_statisticsSlot] = 0;
+		m_socketCalls[m_statisticsSlot] = 0;
 	}
 
-	// Send all messages
+	// Send all messages, in order, as few socket calls as possible
+	TransportMessage *batch[UDP::MAX_BATCH];
+	Int batchCount = 0;
 	int i;
 	for (i=0; i<MAX_MESSAGES; ++i)
 	{
 		if (m_outBuffer[i].length != 0)
 		{
-			int bytesSent = 0;
-			// Send this message
-			if ((bytesSent = m_udpsock->Write((unsigned char *)(&m_outBuffer[i]), m_outBuffer[i].length + sizeof(TransportMessageHeader), m_outBuffer[i].addr, m_outBuffer[i].port)) > 0)
+			batch[batchCount++] = &m_outBuffer[i];
+			if (batchCount == UDP::MAX_BATCH)
 			{
-				//DEBUG_LOG(("Sending %d bytes to %d:%d\n", m_outBuffer[i].length + sizeof(TransportMessageHeader), m_outBuffer[i].addr, m_outBuffer[i].port));
-				m_outgoingPackets[m_statisticsSlot]++;
-				m_outgoingBytes[m_statisticsSlot] += m_outBuffer[i].length + sizeof(TransportMessageHeader);
-				m_outBuffer[i].length = 0;  // Remove from queue
-//				DEBUG_LOG(("Transport::doSend - sent %d butes to %d.%d.%d.%d:%d\n", bytesSent,
-//					(m_outBuffer[i].addr >> 24) & 0xff,
-//					(m_outBuffer[i].addr >> 16) & 0xff,
-//					(m_outBuffer[i].addr >> 8) & 0xff,
-//					m_outBuffer[i].addr & 0xff,
-//					m_outBuffer[i].port));
-			}
-			else
-			{
-				//DEBUG_LOG(("Could not write to socket!!!  Not discarding message!\n"));
-				retval = FALSE;
-				//DEBUG_LOG(("Transport::doSend returning FALSE\n"));
+				if (!sendBatch(batch, batchCount))
+					retval = FALSE;
+				batchCount = 0;
 			}
 		}
 	} // for (i=0; i<MAX_MESSAGES; ++i)
 
+	if (batchCount > 0 && !sendBatch(batch, batchCount))
+		retval = FALSE;
+
 #if defined(_DEBUG) || defined(_INTERNAL)
 	// Latency simulation - deliver anything we're holding on to that is ready
 	if (m_useLatency)
@@ -273,6 +291,58 @@ Bool Transport::doSend() {
 	return retval;
 }
 
+/**
+ * Send count queued messages, taking them off the queue as they go.  Anything that
+ * can't be sent is left queued for next time, and we return FALSE.
+ */
+Bool Transport::sendBatch( TransportMessage **batch, Int count )
+{
+	Bool retval = TRUE;
+
+	const unsigned char *bufs[UDP::MAX_BATCH];
+	UnsignedInt lens[UDP::MAX_BATCH];
+	UnsignedInt addrs[UDP::MAX_BATCH];
+	UnsignedShort ports[UDP::MAX_BATCH];
+	for (Int i=0; i<count; ++i)
+	{
+		bufs[i] = (const unsigned char *)batch[i];
+		lens[i] = batch[i]->length + sizeof(TransportMessageHeader);
+		addrs[i] = batch[i]->addr;
+		ports[i] = batch[i]->port;
+	}
+
+	Int first = 0;
+	while (first < count)
+	{
+		Int sent = m_udpsock->WriteMany(bufs + first, lens + first, addrs + first, ports + first, count - first);
+		if (sent < 0)
+			sent = 0;
+
+		for (Int i=first; i<first+sent; ++i)
+		{
+			//DEBUG_LOG(("Sending %d bytes to %d:%d\n", lens[i], batch[i]->addr, batch[i]->port));
+#if defined(_DEBUG) || defined(_INTERNAL)
+			if (m_captureFile)
+				captureDatagram(NET_CAPTURE_SENT, addrs[i], ports[i], bufs[i], lens[i]);
+#endif
+			m_outgoingPackets[m_statisticsSlot]++;
+			m_outgoingBytes[m_statisticsSlot] += lens[i];
+			batch[i]->length = 0;  // Remove from queue
+		}
+		first += sent;
+
+		if (first < count)
+		{
+			// this one couldn't be written; leave it queued and carry on with the rest
+			//DEBUG_LOG(("Could not write to socket!!!  Not discarding message!\n"));
+			retval = FALSE;
+			++first;
+		}
+	}
+
+	return retval;
+}
+
 Bool Transport::doRecv() 
 {
 	if (!m_udpsock)
@@ -284,18 +354,43 @@ Bool Transport::doRecv()
 	Bool retval = TRUE;
 
 	// Read in anything on our socket
-	sockaddr_in from;
 #if defined(_DEBUG) || defined(_INTERNAL)
 	UnsignedInt now = timeGetTime();
 #endif
 
-	TransportMessage incomingMessage;
-	unsigned char *buf = (unsigned char *)&incomingMessage;
+	unsigned char *bufs[UDP::MAX_BATCH];
+	Int lens[UDP::MAX_BATCH];
+	sockaddr_in froms[UDP::MAX_BATCH];
+	for (int b=0; b<UDP::MAX_BATCH; ++b)
+	{
+		bufs[b] = (unsigned char *)&m_recvBatch[b];
+	}
+
 	int len = MAX_MESSAGE_LEN;
+	int numRead = 0;
+	int next = 0;
 //	DEBUG_LOG(("Transport::doRecv - checking\n"));
-	while ( (len=m_udpsock->Read(buf, MAX_MESSAGE_LEN, &from)) > 0 )
+	for (;;)
 	{
+		if (next == numRead)
+		{
+			// take as many as we can off the socket in one go
+			numRead = m_udpsock->ReadMany(bufs, MAX_MESSAGE_LEN, lens, froms, UDP::MAX_BATCH);
+			next = 0;
+			if (numRead <= 0)
+				break;
+		}
+
+		TransportMessage &incomingMessage = m_recvBatch[next];
+		unsigned char *buf = bufs[next];
+		const sockaddr_in &from = froms[next];
+		len = lens[next];
+		++next;
+
 #if defined(_DEBUG) || defined(_INTERNAL)
+		if (m_captureFile)
+			captureDatagram(NET_CAPTURE_RECEIVED, ntohl(from.sin_addr.s_addr), ntohs(from.sin_port), buf, len);
+
 		// Packet loss simulation
 		if (m_usePacketLoss)
 		{
@@ -304,6 +399,12 @@ Bool Transport::doRecv()
 				continue;
 			}
 		}
+
+		// Bandwidth cap simulation - a saturated link drops whatever doesn't fit in this second
+		if (TheGlobalData->m_bandwidthCap > 0 && m_incomingBytes[m_statisticsSlot] + len > (UnsignedInt)TheGlobalData->m_bandwidthCap)
+		{
+			continue;
+		}
 #endif
 
 //		DEBUG_LOG(("Transport::doRecv - Got something! len = %d\n", len));
@@ -313,11 +414,7 @@ Bool Transport::doRecv()
 //			DEBUG_LOG(("%02x", *(buf + munkee)));
 //		}
 //		DEBUG_LOG(("\n"));
-		decryptBuf(buf, len);
-
-		incomingMessage.length = len - sizeof(TransportMessageHeader);
-
-		if (len <= sizeof(TransportMessageHeader) || !isGeneralsPacket( &incomingMessage ))
+		if (!unpackDatagram( &incomingMessage, len ))
 		{
 			m_unknownPackets[m_statisticsSlot]++;
 			m_unknownBytes[m_statisticsSlot] += len;
@@ -342,6 +439,11 @@ Bool Transport::doRecv()
 						now + TheGlobalData->m_latencyAverage +
 						(Int)(TheGlobalData->m_latencyAmplitude * sin(now * TheGlobalData->m_latencyPeriod)) +
 						GameClientRandomValue(-TheGlobalData->m_latencyNoise, TheGlobalData->m_latencyNoise);
+					if ( TheGlobalData->m_packetReorder > GameClientRandomValue(0, 99) )
+					{
+						// hold this one back long enough for the packets behind it to overtake it
+						m_delayedInBuffer[i].deliveryTime += GameClientRandomValue(10, 100);
+					}
 					m_delayedInBuffer[i].message.length = incomingMessage.length;
 					m_delayedInBuffer[i].message.addr = ntohl(from.sin_addr.s_addr);
 					m_delayedInBuffer[i].message.port = ntohs(from.sin_port);
@@ -368,7 +470,7 @@ Bool Transport::doRecv()
 		//DEBUG_ASSERTCRASH(i<MAX_MESSAGES, ("Message lost!"));
 	}
 
-	if (len == -1) {
+	if (numRead == -1) {
 		// there was a socket error trying to perform a read.
 		//DEBUG_LOG(("Transport::doRecv returning FALSE\n"));
 		retval = FALSE;
@@ -377,43 +479,131 @@ Bool Transport::doRecv()
 	return retval;
 }
 
+/**
+ * Decrypt a datagram of len bytes that came off the wire into msg, fill in its length, and
+ * check that it's a Generals packet.
+ */
+Bool Transport::unpackDatagram( TransportMessage *msg, Int len )
+{
+	decryptBuf((unsigned char *)msg, len);
+
+	msg->length = len - sizeof(TransportMessageHeader);
+
+	return (len > sizeof(TransportMessageHeader) && isGeneralsPacket( msg ));
+}
+
+#if defined(_DEBUG) || defined(_INTERNAL)
+/**
+ * Open the capture file given on the command line.  This is only called for the transport the
+ * game itself runs over, so lobby traffic stays out of captures.
+ */
+void Transport::openCaptureFile( void )
+{
+	closeCaptureFile();
+
+	if (TheGlobalData->m_netCaptureFile.isEmpty())
+		return;
+
+	m_captureFile = fopen(TheGlobalData->m_netCaptureFile.str(), "wb");
+	if (m_captureFile == NULL)
+	{
+		DEBUG_LOG(("Transport::openCaptureFile - couldn't open %s for writing\n", TheGlobalData->m_netCaptureFile.str()));
+		return;
+	}
+
+	NetCaptureFileHeader header;
+	header.magic = NET_CAPTURE_MAGIC;
+	header.version = NET_CAPTURE_VERSION;
+	fwrite(&header, sizeof(header), 1, m_captureFile);
+	DEBUG_LOG(("Transport::openCaptureFile - capturing to %s\n", TheGlobalData->m_netCaptureFile.str()));
+}
+
+void Transport::closeCaptureFile( void )
+{
+	if (m_captureFile)
+	{
+		fclose(m_captureFile);
+		m_captureFile = NULL;
+	}
+}
+
+void Transport::captureUsers( Int localSlot, UnsignedByte playerMask )
+{
+	if (m_captureFile == NULL)
+		return;
+
+	NetCaptureUsers users;
+	users.localSlot = localSlot;
+	users.playerMask = playerMask;
+	captureDatagram(NET_CAPTURE_USERS, 0, 0, (const unsigned char *)&users, sizeof(users));
+}
+
+void Transport::captureDatagram( UnsignedByte direction, UnsignedInt addr, UnsignedShort port, const unsigned char *buf, Int len )
+{
+	NetCaptureRecord record;
+	record.time = timeGetTime();
+	record.direction = direction;
+	record.addr = addr;
+	record.port = port;
+	record.length = len;
+	fwrite(&record, sizeof(record), 1, m_captureFile);
+	fwrite(buf, len, 1, m_captureFile);
+}
+#endif
+
 Bool Transport::queueSend(UnsignedInt addr, UnsignedShort port, const UnsignedByte *buf, Int len /*,
 						  NetMessageFlags flags, Int id */)
 {
-	int i;
-
 	if (len < 1 || len > MAX_PACKET_SIZE)
 	{
 		return false;
 	}
 
-	for (i=0; i<MAX_MESSAGES; ++i)
+	TransportMessage *slot = getFreeSendSlot();
+	if (slot == NULL)
+	{
+		return false;
+	}
+
+	// Insert data here
+	memcpy(slot->data, buf, len);
+	queueSendSlot(slot, addr, port, len);
+	return true;
+}
+
+TransportMessage *Transport::getFreeSendSlot( void )
+{
+	for (int i=0; i<MAX_MESSAGES; ++i)
 	{
 		if (m_outBuffer[i].length == 0)
 		{
-			// Insert data here
-			m_outBuffer[i].length = len;
-			memcpy(m_outBuffer[i].data, buf, len);
-			m_outBuffer[i].addr = addr;
-			m_outBuffer[i].port = port;
-//			m_outBuffer[i].header.flags = flags;
-//			m_outBuffer[i].header.id = id;
-			m_outBuffer[i].header.magic = GENERALS_MAGIC_NUMBER;
-
-			CRC crc;
-			crc.computeCRC( (unsigned char *)(&(m_outBuffer[i].header.magic)), m_outBuffer[i].length + sizeof(TransportMessageHeader) - sizeof(UnsignedInt) );
-//			DEBUG_LOG(("About to assign the CRC for the packet\n"));
-			m_outBuffer[i].header.crc = crc.get();
-
-			// Encrypt packet
-//			DEBUG_LOG(("buffer: "));
-			encryptBuf((unsigned char *)&m_outBuffer[i], len + sizeof(TransportMessageHeader));
-//			DEBUG_LOG(("\n"));
-
-			return true;
+			return &m_outBuffer[i];
 		}
 	}
-	return false;
+	return NULL;
+}
+
+void Transport::queueSendSlot(TransportMessage *slot, UnsignedInt addr, UnsignedShort port, Int len)
+{
+	DEBUG_ASSERTCRASH(slot->length == 0, ("Transport::queueSendSlot - slot is already queued"));
+	DEBUG_ASSERTCRASH(len >= 1 && len <= MAX_PACKET_SIZE, ("Transport::queueSendSlot - bad length %d", len));
+
+	slot->length = len;
+	slot->addr = addr;
+	slot->port = port;
+//	slot->header.flags = flags;
+//	slot->header.id = id;
+	slot->header.magic = GENERALS_MAGIC_NUMBER;
+
+	CRC crc;
+	crc.computeCRC( (unsigned char *)(&(slot->header.magic)), slot->length + sizeof(TransportMessageHeader) - sizeof(UnsignedInt) );
+//	DEBUG_LOG(("About to assign the CRC for the packet\n"));
+	slot->header.crc = crc.get();
+
+	// Encrypt packet
+//	DEBUG_LOG(("buffer: "));
+	encryptBuf((unsigned char *)slot, len + sizeof(TransportMessageHeader));
+//	DEBUG_LOG(("\n"));
 }
 
 Bool Transport::isGeneralsPacket( TransportMessage *msg )
@@ -493,6 +683,17 @@ Real Transport::getUnknownBytesPerSecond( void )
 	return val / (MAX_TRANSPORT_STATISTICS_SECONDS-1);
 }
 
+Real Transport::getSocketCallsPerSecond( void )
+{
+	Real val = 0.0;
+	for (int i=0; i<MAX_TRANSPORT_STATISTICS_SECONDS; ++i)
+	{
+		if (i != m_statisticsSlot)
+			val += m_socketCalls[i];
+	}
+	return val / (MAX_TRANSPORT_STATISTICS_SECONDS-1);
+}
+
 Real Transport::getUnknownPacketsPerSecond( void )
 {
 	Real val = 0.0;
@@ -123,6 +123,8 @@ AsciiString GetWSAErrorString( Int error )
 UDP::UDP()
 {
   fd=0;
+  m_lastError=0;
+  m_socketCalls=0;
 }
 
 UDP::~UDP()
@@ -252,6 +254,7 @@ Int UDP::Write(const unsigned char *msg,UnsignedInt len,UnsignedInt IP,UnsignedS
   to.sin_family=AF_INET;
 
   ClearStatus();
+  ++m_socketCalls;
   retval=sendto(fd,(const char *)msg,len,0,(struct sockaddr *)&to,sizeof(to));
   #ifdef _WINDOWS
   if (retval==SOCKET_ERROR)
@@ -274,6 +277,7 @@ Int UDP::Read(unsigned char *msg,UnsignedInt len,sockaddr_in *from)
   Int retval;
   socklen_t    alen=sizeof(sockaddr_in);
 
+  ++m_socketCalls;
   if (from!=NULL)
   {
     retval=recvfrom(fd,(char *)msg,len,0,(struct sockaddr *)from,&alen);
@@ -322,6 +326,88 @@ Int UDP::Read(unsigned char *msg,UnsignedInt len,sockaddr_in *from)
 }
 
 
+// Linux can move a whole batch of datagrams in one call; elsewhere this is just a loop over Read.
+Int UDP::ReadMany(unsigned char **msgs,UnsignedInt len,Int *lens,sockaddr_in *froms,Int count)
+{
+  DEBUG_ASSERTCRASH(count <= MAX_BATCH, ("UDP::ReadMany - too many datagrams"));
+#ifdef __linux__
+  struct mmsghdr hdrs[MAX_BATCH];
+  struct iovec   iovs[MAX_BATCH];
+
+  memset(hdrs,0,sizeof(struct mmsghdr)*count);
+  for (Int i=0; i<count; ++i)
+  {
+    iovs[i].iov_base=msgs[i];
+    iovs[i].iov_len=len;
+    hdrs[i].msg_hdr.msg_iov=&iovs[i];
+    hdrs[i].msg_hdr.msg_iovlen=1;
+    hdrs[i].msg_hdr.msg_name=&froms[i];
+    hdrs[i].msg_hdr.msg_namelen=sizeof(sockaddr_in);
+  }
+
+  ++m_socketCalls;
+  Int retval=recvmmsg(fd,hdrs,count,MSG_DONTWAIT,NULL);
+  for (Int i=0; i<retval; ++i)
+    lens[i]=hdrs[i].msg_len;
+  return(retval);
+#else
+  for (Int i=0; i<count; ++i)
+  {
+    lens[i]=Read(msgs[i],len,&froms[i]);
+    if (lens[i] <= 0)
+      return((i==0) ? lens[i] : i);
+  }
+  return(count);
+#endif
+}
+
+Int UDP::WriteMany(const unsigned char **msgs,const UnsignedInt *lens,const UnsignedInt *IPs,const UnsignedShort *ports,Int count)
+{
+  DEBUG_ASSERTCRASH(count <= MAX_BATCH, ("UDP::WriteMany - too many datagrams"));
+#ifdef __linux__
+  struct mmsghdr     hdrs[MAX_BATCH];
+  struct iovec       iovs[MAX_BATCH];
+  struct sockaddr_in tos[MAX_BATCH];
+
+  memset(hdrs,0,sizeof(struct mmsghdr)*count);
+  memset(tos,0,sizeof(struct sockaddr_in)*count);
+  for (Int i=0; i<count; ++i)
+  {
+    // Write fails these without trying, so stop the batch there
+    if ((IPs[i]==0)||(ports[i]==0))
+    {
+      if (i==0)
+        return(ADDRNOTAVAIL);
+      count=i;
+      break;
+    }
+
+    tos[i].sin_port=htons(ports[i]);
+    tos[i].sin_addr.s_addr=htonl(IPs[i]);
+    tos[i].sin_family=AF_INET;
+    iovs[i].iov_base=(void *)msgs[i];
+    iovs[i].iov_len=lens[i];
+    hdrs[i].msg_hdr.msg_iov=&iovs[i];
+    hdrs[i].msg_hdr.msg_iovlen=1;
+    hdrs[i].msg_hdr.msg_name=&tos[i];
+    hdrs[i].msg_hdr.msg_namelen=sizeof(sockaddr_in);
+  }
+
+  errno=0;
+  ClearStatus();
+  ++m_socketCalls;
+  return(sendmmsg(fd,hdrs,count,0));
+#else
+  for (Int i=0; i<count; ++i)
+  {
+    Int retval=Write(msgs[i],lens[i],IPs[i],ports[i]);
+    if (retval <= 0)
+      return((i==0) ? retval : i);
+  }
+  return(count);
+#endif
+}
+
 void UDP::ClearStatus(void)
 {
   #ifndef _WINDOWS
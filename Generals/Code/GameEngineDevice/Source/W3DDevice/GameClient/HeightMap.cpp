@@ -2012,12 +2012,12 @@ Bool HeightMapRenderObjClass::isClearLineOfSight(const Coord3D& pos, const Coord
 			break;
 		}
 
+		// take the max of the raw samples first, so there's only one conversion and multiply per step
 		Int idx = x + y*xExtent;
-		float height = data[idx];
-		height = __max(height, data[idx + 1]);
-		height = __max(height, data[idx + xExtent]);
-		height = __max(height, data[idx + xExtent + 1]);
-		height *= MAP_HEIGHT_SCALE;
+		UnsignedByte rawHeight = __max(data[idx], data[idx + 1]);
+		rawHeight = __max(rawHeight, data[idx + xExtent]);
+		rawHeight = __max(rawHeight, data[idx + xExtent + 1]);
+		float height = rawHeight * MAP_HEIGHT_SCALE;
 
 		// if terrainHeight > z, we can't see, so punt.
 		// add a little fudge to account for slop.
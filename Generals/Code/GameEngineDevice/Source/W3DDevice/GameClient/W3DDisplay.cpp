@@ -1297,13 +1297,16 @@ void W3DDisplay::gatherDebugStats( void )
 			m_displayStrings[NetIncoming]->setText( unibuffer );
 
 			// Network outgoing bandwidth stats
-			unibuffer.format(L"OUT: %.2f bytes/sec, %.2f packets/sec",
-				TheNetwork->getOutgoingBytesPerSecond(), TheNetwork->getOutgoingPacketsPerSecond());
+			unibuffer.format(L"OUT: %.2f bytes/sec, %.2f packets/sec, %.2f socket calls/sec",
+				TheNetwork->getOutgoingBytesPerSecond(), TheNetwork->getOutgoingPacketsPerSecond(), TheNetwork->getSocketCallsPerSecond());
 			m_displayStrings[NetOutgoing]->setText( unibuffer );
 
 			// Network performance stats
-			unibuffer.format(L"Run Ahead: %d, Net FPS: %d, Packet arrival cushion: %d",
-				TheNetwork->getRunAhead(), TheNetwork->getFrameRate(), TheNetwork->getPacketArrivalCushion());
+			Real effectiveFPS = TheNetwork->getEffectiveFrameRate();
+			Real bytesPerFrame = (effectiveFPS > 0.0f) ? (TheNetwork->getIncomingBytesPerSecond() + TheNetwork->getOutgoingBytesPerSecond()) / effectiveFPS : 0.0f;
+			unibuffer.format(L"Run Ahead: %d, Net FPS: %d (%.1f actual), Packet arrival cushion: %d, Stalls: %d (%.1f sec), %.0f bytes/frame",
+				TheNetwork->getRunAhead(), TheNetwork->getFrameRate(), effectiveFPS, TheNetwork->getPacketArrivalCushion(),
+				TheNetwork->getStallCount(), TheNetwork->getStallTime() / 1000.0f, bytesPerFrame);
 			m_displayStrings[NetStats]->setText( unibuffer );
 
 			// Client frame rate averages for all players in the game.  This only works right for the packet router.
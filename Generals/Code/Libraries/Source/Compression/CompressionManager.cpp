@@ -147,9 +147,13 @@ Int CompressionManager::getMaxCompressedSize( Int uncompressedLen, CompressionTy
 
 		case COMPRESSION_BTREE:   // guessing here
 		case COMPRESSION_HUFF:    // guessing here
-		case COMPRESSION_REFPACK: // guessing here
 			return uncompressedLen + 8;
 
+		case COMPRESSION_REFPACK:
+			// data that won't compress costs a literal code byte per 112 bytes, plus the header
+			// (6 bytes at most) and the end code
+			return uncompressedLen + (uncompressedLen / 112) + 8 + 8;
+
 		case COMPRESSION_ZLIB1:
 		case COMPRESSION_ZLIB2:
 		case COMPRESSION_ZLIB3: